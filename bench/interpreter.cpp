@@ -0,0 +1,179 @@
+#include "snir/core/File.hpp"
+#include "snir/ir/Bytecode.hpp"
+#include "snir/ir/ClosureFunction.hpp"
+#include "snir/ir/ExecutionService.hpp"
+#include "snir/ir/Function.hpp"
+#include "snir/ir/Interpreter.hpp"
+#include "snir/ir/Literal.hpp"
+#include "snir/ir/Module.hpp"
+#include "snir/ir/Parser.hpp"
+#include "snir/ir/Registry.hpp"
+#include "snir/ir/Type.hpp"
+
+#include "fmt/chrono.h"
+#include "fmt/format.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <future>
+#include <numeric>
+#include <span>
+#include <thread>
+#include <variant>
+#include <vector>
+
+namespace {
+
+using Clock    = std::chrono::steady_clock;
+using Dispatch = snir::Interpreter::Dispatch;
+
+[[nodiscard]] auto us(Clock::duration delta) -> std::chrono::microseconds
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(delta);
+}
+
+auto benchmarkDispatch(std::filesystem::path const& path) -> void
+{
+    auto registry = snir::Registry{};
+    auto parser   = snir::Parser{registry};
+    auto module   = parser.read(snir::readFile(path).value());
+    auto func     = snir::Function{registry, module.functions().at(0)};
+
+    auto const names = std::array{"switch", "threaded"};
+    for (auto fuse : {false, true}) {
+        auto const code = snir::Bytecode::compile(func, fuse);
+        for (auto dispatch : {Dispatch::Switch, Dispatch::Threaded}) {
+            auto vm          = snir::Interpreter{dispatch};
+            auto const start = Clock::now();
+            for (auto i = 0; i < 100'000; ++i) {
+                [[maybe_unused]] auto result = vm.execute(code, {});
+            }
+            auto const delta = us(Clock::now() - start);
+            auto const name  = names.at(std::size_t(dispatch));
+            auto const insts = code.code.size();
+            fmt::println("{} dispatch on {} ({} insts): {}", name, path.string(), insts, delta);
+        }
+
+        auto closure     = snir::ClosureFunction::compile(code);
+        auto const start = Clock::now();
+        for (auto i = 0; i < 100'000; ++i) {
+            [[maybe_unused]] auto result = closure.execute({});
+        }
+        auto const delta = us(Clock::now() - start);
+        fmt::println("closures on {} ({} insts): {}", path.string(), code.code.size(), delta);
+    }
+}
+
+auto benchmarkBatch() -> void
+{
+    auto registry   = snir::Registry{};
+    auto parser     = snir::Parser{registry};
+    auto add        = parser.read(snir::readFile("./test/files/i64_args_2.ll").value());
+    auto const code = snir::Bytecode::compile(snir::Function{registry, add.functions().at(0)});
+    auto vm         = snir::Interpreter{};
+
+    auto lhs  = std::vector<std::int64_t>(100'000);
+    auto rhs  = std::vector<std::int64_t>(lhs.size(), 42);
+    auto sums = std::vector<std::int64_t>(lhs.size());
+    std::iota(lhs.begin(), lhs.end(), std::int64_t{0});
+
+    auto const start = Clock::now();
+    for (auto i = 0zu; i < lhs.size(); ++i) {
+        auto const args = std::array{snir::Literal{lhs[i]}, snir::Literal{rhs[i]}};
+        sums[i]         = std::get<std::int64_t>(vm.execute(code, args)->value);
+    }
+    auto const mid = Clock::now();
+    vm.executeBatch(
+        code,
+        std::span{sums},
+        std::span<std::int64_t const>{lhs},
+        std::span<std::int64_t const>{rhs}
+    );
+    auto const stop = Clock::now();
+
+    fmt::println("{} rows, per row: {}, batch: {}", lhs.size(), us(mid - start), us(stop - mid));
+}
+
+auto benchmarkTypedCall() -> void
+{
+    auto registry  = snir::Registry{};
+    auto parser    = snir::Parser{registry};
+    auto add       = parser.read(snir::readFile("./test/files/i64_args_2.ll").value());
+    auto const sum = snir::Bytecode::compile(snir::Function{registry, add.functions().at(0)});
+    auto vm        = snir::Interpreter{};
+
+    auto boxed   = std::int64_t{0};
+    auto typed   = std::int64_t{0};
+    auto const n = std::int64_t{100'000};
+
+    auto const start = Clock::now();
+    for (auto i = std::int64_t{0}; i < n; ++i) {
+        auto const args = std::array{snir::Literal{i}, snir::Literal{boxed}};
+        boxed           = std::get<std::int64_t>(vm.execute(sum, args)->value);
+    }
+    auto const mid = Clock::now();
+    for (auto i = std::int64_t{0}; i < n; ++i) {
+        typed = vm.execute<std::int64_t>(sum, i, typed);
+    }
+    auto const stop = Clock::now();
+
+    fmt::println("{} calls, literals: {}, typed: {}", n, us(mid - start), us(stop - mid));
+}
+
+// Throughput on the corpus of small functions, one worker vs all cores.
+auto benchmarkService() -> void
+{
+    auto registry = snir::Registry{};
+    auto parser   = snir::Parser{registry};
+    auto codes    = std::vector<snir::Bytecode>{};
+    for (auto const& entry : std::filesystem::directory_iterator{"./test/files"}) {
+        if (not entry.is_regular_file()) {
+            continue;
+        }
+        auto module = parser.read(snir::readFile(entry).value());
+        auto func   = snir::Function{registry, module.functions().at(0)};
+        if (func.arguments().empty() and func.type() != snir::Type::Void) {
+            codes.push_back(snir::Bytecode::compile(func));
+        }
+    }
+
+    auto const rounds = 2'000zu;
+    auto const cores  = std::max(std::thread::hardware_concurrency(), 1U);
+    for (auto const workers : {1U, cores}) {
+        auto service = snir::ExecutionService{workers};
+        auto futures = std::vector<std::future<snir::Literal>>{};
+        futures.reserve(rounds * codes.size());
+
+        auto const start = Clock::now();
+        for (auto round = 0zu; round < rounds; ++round) {
+            for (auto const& code : codes) {
+                futures.push_back(service.submit(code, {}));
+            }
+        }
+        for (auto& future : futures) {
+            (void)future.get();
+        }
+        auto const delta = us(Clock::now() - start);
+
+        fmt::println("{} calls on {} workers: {}", futures.size(), workers, delta);
+        if (workers == cores) {
+            break;
+        }
+    }
+}
+
+}  // namespace
+
+auto main() -> int
+{
+    benchmarkDispatch("./test/files/i64_blocks.ll");
+    benchmarkBatch();
+    benchmarkTypedCall();
+    benchmarkService();
+    return EXIT_SUCCESS;
+}
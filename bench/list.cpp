@@ -0,0 +1,92 @@
+#include "snir/ir/InstructionList.hpp"
+#include "snir/ir/ValueId.hpp"
+
+#include "fmt/chrono.h"
+#include "fmt/format.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iterator>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+[[nodiscard]] auto id(std::uint32_t i) -> snir::ValueId { return snir::ValueId{i}; }
+
+[[nodiscard]] auto us(Clock::duration delta) -> std::chrono::microseconds
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(delta);
+}
+
+// Erases every second instruction and inserts a new one in front of every
+// fourth, the access pattern of a pass that sinks or rewrites in place.
+template<typename Container>
+auto rewrite(Container& insts) -> void
+{
+    auto next = static_cast<std::uint32_t>(insts.size());
+    auto pos  = 0U;
+    for (auto it = insts.begin(); it != insts.end(); ++pos) {
+        if (pos % 2 == 1) {
+            it = insts.erase(it);
+            continue;
+        }
+        if (pos % 4 == 0) {
+            it = std::next(insts.insert(it, id(next++)));
+        }
+        ++it;
+    }
+}
+
+template<typename Container>
+[[nodiscard]] auto checksum(Container const& insts) -> std::uint64_t
+{
+    auto sum = std::uint64_t{0};
+    for (auto const inst : insts) {
+        sum += static_cast<std::uint32_t>(inst);
+    }
+    return sum;
+}
+
+// In place rewrites and iteration of the instruction list against a vector.
+auto benchmarkRewrite() -> void
+{
+    auto vector = std::vector<snir::ValueId>{};
+    auto list   = snir::InstructionList{};
+    for (auto i = 0U; i < 50'000U; ++i) {
+        vector.push_back(id(i));
+        list.push_back(id(i));
+    }
+
+    auto const start = Clock::now();
+    rewrite(vector);
+    auto const mid = Clock::now();
+    rewrite(list);
+    auto const stop = Clock::now();
+
+    auto const iterStart = Clock::now();
+    auto const vectorSum = checksum(vector);
+    auto const iterMid   = Clock::now();
+    auto const listSum   = checksum(list);
+    auto const iterStop  = Clock::now();
+
+    fmt::println(
+        "{} instructions, rewrite vector: {}, list: {}, iterate vector: {}, list: {}{}",
+        list.size(),
+        us(mid - start),
+        us(stop - mid),
+        us(iterMid - iterStart),
+        us(iterStop - iterMid),
+        vectorSum == listSum ? "" : " (checksums differ)"
+    );
+}
+
+}  // namespace
+
+auto main() -> int
+{
+    benchmarkRewrite();
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,61 @@
+#include "snir/ir/NativeModule.hpp"
+#include "snir/core/File.hpp"
+#include "snir/ir/Bytecode.hpp"
+#include "snir/ir/Function.hpp"
+#include "snir/ir/Interpreter.hpp"
+#include "snir/ir/Literal.hpp"
+#include "snir/ir/Parser.hpp"
+#include "snir/ir/Registry.hpp"
+
+#include "fmt/chrono.h"
+#include "fmt/format.h"
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+[[nodiscard]] auto us(Clock::duration delta) -> std::chrono::microseconds
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(delta);
+}
+
+auto benchmarkLoop() -> void
+{
+    auto registry = snir::Registry{};
+    auto parser   = snir::Parser{registry};
+    auto module   = parser.read(snir::readFile("./test/files/i64_loop_args.ll").value());
+    auto func     = snir::Function{registry, module.functions().at(0)};
+    auto code     = snir::Bytecode::compile(func);
+    auto native   = snir::NativeModule::compile(module);
+    auto sum      = native.get<std::int64_t(std::int64_t)>(func.identifier());
+    auto vm       = snir::Interpreter{};
+
+    auto const n     = std::int64_t{100'000};
+    auto const args  = std::array{snir::Literal{n}};
+    auto const start = Clock::now();
+    auto const slow  = vm.execute(code, args).value();
+    auto const mid   = Clock::now();
+    auto const fast  = sum(n);
+    auto const stop  = Clock::now();
+
+    fmt::println("loop of {}: interpreter {} in {}", n, slow, us(mid - start));
+    fmt::println("loop of {}: native {} in {}", n, fast, us(stop - mid));
+}
+
+}  // namespace
+
+auto main() -> int
+{
+    if constexpr (not SNIR_HAS_NATIVE_MODULE) {
+        fmt::println("native modules not supported on this platform");
+        return EXIT_SUCCESS;
+    }
+
+    benchmarkLoop();
+    return EXIT_SUCCESS;
+}
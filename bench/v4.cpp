@@ -0,0 +1,148 @@
+#include "snir/ir/Branch.hpp"
+#include "snir/ir/Bytecode.hpp"
+#include "snir/ir/CompareKind.hpp"
+#include "snir/ir/Function.hpp"
+#include "snir/ir/InstKind.hpp"
+#include "snir/ir/Interpreter.hpp"
+#include "snir/ir/Literal.hpp"
+#include "snir/ir/Module.hpp"
+#include "snir/ir/Operands.hpp"
+#include "snir/ir/Parser.hpp"
+#include "snir/ir/pass/DeadStoreElimination.hpp"
+#include "snir/ir/pass/RemoveNop.hpp"
+#include "snir/ir/PassManager.hpp"
+#include "snir/ir/Phi.hpp"
+#include "snir/ir/Registry.hpp"
+#include "snir/ir/Result.hpp"
+#include "snir/ir/Type.hpp"
+#include "snir/ir/v4/Compile.hpp"
+#include "snir/ir/v4/pass/DeadStoreElimination.hpp"
+#include "snir/ir/v4/pass/RemoveNop.hpp"
+#include "snir/ir/v4/Reader.hpp"
+#include "snir/ir/v4/SharedValueStore.hpp"
+#include "snir/ir/ValueId.hpp"
+#include "snir/ir/ValueKind.hpp"
+
+#include "fmt/chrono.h"
+#include "fmt/format.h"
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+[[nodiscard]] auto us(Clock::duration delta) -> std::chrono::microseconds
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(delta);
+}
+
+auto optimize(snir::Module& module) -> void
+{
+    auto pm = snir::PassManager{};
+    pm.add(snir::DeadStoreElimination{});
+    pm.add(snir::RemoveNop{});
+    pm(module);
+}
+
+auto optimize(snir::v4::SharedValueStore& store) -> void
+{
+    for (auto i = 0zu; i < store.functions().size(); ++i) {
+        snir::v4::DeadStoreElimination{}(store, snir::v4::FunctionId(i));
+        snir::v4::RemoveNop{}(store, snir::v4::FunctionId(i));
+    }
+}
+
+// Straight line code where every fourth value is never read.
+[[nodiscard]] auto largeModule(int size) -> std::string
+{
+    auto source = std::string{"define i64 @func(i64 %0) {\n1:\n    %2 = i64 3\n"};
+    auto last   = 0;
+    for (auto i = 3; i < size; ++i) {
+        if (i % 4 == 0) {
+            source += fmt::format("    %{} = sub i64 %{}, %2\n", i, last);
+            continue;
+        }
+        source += fmt::format("    %{} = {} i64 %{}, %2\n", i, i % 2 == 0 ? "add" : "xor", last);
+        last = i;
+    }
+    source += fmt::format("    ret i64 %{}\n}}\n", last);
+    return source;
+}
+
+// Lower bound for the registry: payload and packed entity per component
+// plus the sparse index each pool keeps for the entity range.
+template<typename... Components>
+[[nodiscard]] auto registryBytes(snir::Registry& registry) -> std::size_t
+{
+    auto const entities = registry.storage<snir::ValueKind>().size();
+    auto const pool     = [&]<typename T>(T const* /*tag*/) {
+        auto const size = registry.storage<T>().size();
+        auto const used = size != 0 ? entities : 0;
+        return size * (sizeof(T) + sizeof(snir::ValueId)) + used * sizeof(snir::ValueId);
+    };
+    return (pool(static_cast<Components const*>(nullptr)) + ...);
+}
+
+// Memory, pass and execution cost of the entt registry against the v4
+// structure-of-arrays storage on one large function.
+auto benchmarkStorage() -> void
+{
+    auto const source = largeModule(100'000);
+    auto const args   = std::array{snir::Literal{std::int64_t{7}}};
+    auto vm           = snir::Interpreter{};
+
+    auto registry = snir::Registry{};
+    auto parser   = snir::Parser{registry};
+    auto module   = parser.read(source);
+    auto store    = snir::v4::read(source);
+    auto func     = snir::Function{registry, module.functions().at(0)};
+    auto insts    = func.basicBlocks().at(0).instructions.size();
+
+    auto const entt = registryBytes<
+        snir::ValueKind,
+        snir::InstKind,
+        snir::Type,
+        snir::Result,
+        snir::Operands,
+        snir::CompareKind,
+        snir::Literal,
+        snir::Branch,
+        snir::Phi>(registry);
+    fmt::println("entt: {} bytes per instruction", entt / insts);
+    fmt::println("v4: {} bytes per instruction", store.memoryUsage() / insts);
+
+    auto start = Clock::now();
+    optimize(module);
+    auto const enttCode = snir::Bytecode::compile(func);
+    auto const enttPass = Clock::now() - start;
+
+    start = Clock::now();
+    (void)vm.execute(enttCode, args);
+    auto const enttExec = Clock::now() - start;
+
+    start = Clock::now();
+    optimize(store);
+    auto const v4Code = snir::v4::compile(store, snir::v4::FunctionId(0));
+    auto const v4Pass = Clock::now() - start;
+
+    start = Clock::now();
+    (void)vm.execute(v4Code, args);
+    auto const v4Exec = Clock::now() - start;
+
+    fmt::println("entt: passes+lowering {}, execute {}", us(enttPass), us(enttExec));
+    fmt::println("v4: passes+lowering {}, execute {}", us(v4Pass), us(v4Exec));
+}
+
+}  // namespace
+
+auto main() -> int
+{
+    benchmarkStorage();
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <string_view>
+
+namespace snir {
+
+/// \brief String literal usable as a template argument.
+template<std::size_t N>
+struct FixedString
+{
+    // NOLINTNEXTLINE(hicpp-explicit-conversions, *-avoid-c-arrays)
+    constexpr FixedString(char const (&str)[N]) { std::ranges::copy(str, chars.begin()); }
+
+    [[nodiscard]] constexpr auto view() const noexcept -> std::string_view
+    {
+        return {chars.data(), N - 1U};
+    }
+
+    std::array<char, N> chars{};
+};
+
+}  // namespace snir
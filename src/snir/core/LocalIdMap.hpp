@@ -27,6 +27,8 @@ struct LocalIdMap
         return it->second;
     }
 
+    [[nodiscard]] auto size() const noexcept -> std::size_t { return _keys.size(); }
+
     auto clear() -> void
     {
         _ids.clear();
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace snir {
+
+/// \brief Id of an interned string, equal strings share the same symbol.
+enum struct Symbol : std::uint32_t
+{
+};
+
+/// \brief Arena backed string interner.
+///
+/// Text is copied into chunks that never move, so the views handed out stay
+/// valid as long as the pool. Interning is safe from multiple threads, a
+/// string that is already known only takes the shared lock.
+struct StringPool
+{
+    StringPool() = default;
+
+    StringPool(StringPool const& other)                    = delete;
+    StringPool(StringPool&& other)                         = delete;
+    auto operator=(StringPool const& other) -> StringPool& = delete;
+    auto operator=(StringPool&& other) -> StringPool&      = delete;
+
+    ~StringPool() = default;
+
+    [[nodiscard]] auto intern(std::string_view str) -> Symbol
+    {
+        if (auto const found = find(str); found) {
+            return *found;
+        }
+
+        // Another thread may have added the same string between the locks.
+        auto const lock = std::scoped_lock{_mutex};
+        if (auto const found = _symbols.find(str); found != _symbols.end()) {
+            return found->second;
+        }
+
+        auto const symbol = static_cast<Symbol>(_texts.size());
+        auto const text   = store(str);
+        _texts.push_back(text);
+        _symbols.emplace(text, symbol);
+        return symbol;
+    }
+
+    [[nodiscard]] auto find(std::string_view str) const -> std::optional<Symbol>
+    {
+        auto const lock = std::shared_lock{_mutex};
+        if (auto const found = _symbols.find(str); found != _symbols.end()) {
+            return found->second;
+        }
+        return std::nullopt;
+    }
+
+    [[nodiscard]] auto text(Symbol symbol) const -> std::string_view
+    {
+        auto const lock = std::shared_lock{_mutex};
+        return _texts.at(static_cast<std::size_t>(symbol));
+    }
+
+    [[nodiscard]] auto size() const -> std::size_t
+    {
+        auto const lock = std::shared_lock{_mutex};
+        return _texts.size();
+    }
+
+private:
+    static constexpr auto chunkSize = 4096zu;
+
+    // Strings longer than a chunk get a chunk of their own.
+    [[nodiscard]] auto store(std::string_view str) -> std::string_view
+    {
+        if (_chunks.empty() or _used + str.size() > chunkSize) {
+            auto const size = std::max(str.size(), chunkSize);
+            _chunks.push_back(std::make_unique_for_overwrite<char[]>(size));
+            _used = 0;
+        }
+
+        auto* first = _chunks.back().get() + _used;
+        std::ranges::copy(str, first);
+        _used += str.size();
+        return std::string_view{first, str.size()};
+    }
+
+    mutable std::shared_mutex _mutex;
+    std::vector<std::unique_ptr<char[]>> _chunks;
+    std::size_t _used{0};
+    std::vector<std::string_view> _texts;
+    std::unordered_map<std::string_view, Symbol> _symbols;
+};
+
+}  // namespace snir
@@ -1,15 +1,14 @@
 #pragma once
 
+#include "snir/ir/InstructionList.hpp"
 #include "snir/ir/ValueId.hpp"
 
-#include <vector>
-
 namespace snir {
 
 struct BasicBlock
 {
     ValueId label;
-    std::vector<ValueId> instructions;
+    InstructionList instructions;
 };
 
 }  // namespace snir
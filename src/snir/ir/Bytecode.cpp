@@ -0,0 +1,310 @@
+#include "Bytecode.hpp"
+
+#include "snir/core/Exception.hpp"
+#include "snir/core/LocalIdMap.hpp"
+#include "snir/ir/BasicBlock.hpp"
+#include "snir/ir/Branch.hpp"
+#include "snir/ir/CompareKind.hpp"
+#include "snir/ir/FrameCompaction.hpp"
+#include "snir/ir/Function.hpp"
+#include "snir/ir/Groups.hpp"
+#include "snir/ir/InstKind.hpp"
+#include "snir/ir/Literal.hpp"
+#include "snir/ir/Lowering.hpp"
+#include "snir/ir/OpCode.hpp"
+#include "snir/ir/Operands.hpp"
+#include "snir/ir/Phi.hpp"
+#include "snir/ir/Registry.hpp"
+#include "snir/ir/Result.hpp"
+#include "snir/ir/Superinstruction.hpp"
+#include "snir/ir/Type.hpp"
+#include "snir/ir/ValueId.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <map>
+#include <stdexcept>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace snir {
+
+namespace {
+
+template<typename T>
+[[nodiscard]] auto literalToSlot(Literal const& literal, Type type) -> Slot
+{
+    if (auto const* val = std::get_if<T>(&literal.value); val != nullptr) {
+        return toSlot(*val);
+    }
+    raisef<std::invalid_argument>("literal {} is not of type {}", literal, type);
+}
+
+struct BytecodeCompiler
+{
+    explicit BytecodeCompiler(Function const& func)
+        : _func{func}
+        , _registry{func.asValue().registry()}
+        , _instructions{instructionGroup(*func.asValue().registry())}
+        , _literals{literalGroup(*func.asValue().registry())}
+        , _branches{branchGroup(*func.asValue().registry())}
+    {}
+
+    [[nodiscard]] auto run() -> Bytecode
+    {
+        auto const& blocks = _func.basicBlocks();
+        if (blocks.empty()) {
+            raisef<std::runtime_error>("function '{}' has no basic blocks", _func.identifier());
+        }
+
+        _code.type = _func.type();
+        for (auto const arg : _func.arguments()) {
+            auto const type = _registry->get<Type>(arg);
+            _code.arguments.push_back(type);
+            _types.emplace(arg, type);
+            (void)slot(arg);
+        }
+
+        collectTypes();
+        for (auto const& block : blocks) {
+            _blocks.emplace(block.label, &block);
+        }
+
+        for (auto const& block : blocks) {
+            _block = block.label;
+            _labels.emplace(block.label, pc());
+            for (auto const inst : block.instructions) {
+                compileInst(inst);
+            }
+        }
+
+        _edges.finish(_code, [this](ValueId label) {
+            auto const target = _labels.find(label);
+            if (target == _labels.end()) {
+                raisef<std::runtime_error>("unknown block");
+            }
+            return target->second;
+        });
+        for (auto const& block : blocks) {
+            _code.labels.push_back(_labels.at(block.label));
+        }
+
+        _code.registers = static_cast<std::uint32_t>(_slots.size());
+        assignScratchSlot(_code);
+        return std::move(_code);
+    }
+
+private:
+    auto collectTypes() -> void
+    {
+        auto instructions = _registry->view<InstKind, Type>();
+        for (auto const& block : _func.basicBlocks()) {
+            for (auto const inst : block.instructions) {
+                auto const* result = _registry->try_get<Result>(inst);
+                if (result == nullptr) {
+                    continue;
+                }
+
+                auto const [kind, type] = instructions.get(inst);
+                _types.emplace(result->id, kind == InstKind::IntCmp ? Type::Bool : type);
+            }
+        }
+    }
+
+    auto compileInst(ValueId inst) -> void
+    {
+        auto const [kind, type] = _registry->get<InstKind, Type>(inst);
+        switch (kind) {
+            case InstKind::Nop: break;
+            case InstKind::Const: compileConst(inst, type); break;
+            case InstKind::Return: compileReturn(inst, type); break;
+            case InstKind::Branch: compileBranch(inst); break;
+            case InstKind::Add:
+            case InstKind::Sub:
+            case InstKind::Mul:
+            case InstKind::Div:
+            case InstKind::Mod:
+            case InstKind::And:
+            case InstKind::Or:
+            case InstKind::Xor:
+            case InstKind::ShiftLeft:
+            case InstKind::ShiftRight: compileBinary(inst, selectIntOp(kind, type)); break;
+            case InstKind::FloatAdd:
+            case InstKind::FloatSub:
+            case InstKind::FloatMul:
+            case InstKind::FloatDiv: compileBinary(inst, selectFloatOp(kind, type)); break;
+            case InstKind::IntCmp: compileIntCmp(inst, type); break;
+            case InstKind::Trunc: compileTrunc(inst, type); break;
+            case InstKind::Phi: break;
+            default: raisef<std::runtime_error>("unimplemented: {}<{}>", kind, type);
+        }
+    }
+
+    auto compileConst(ValueId inst, Type type) -> void
+    {
+        auto const [res, literal] = read<Result, Literal>(_literals, *_registry, inst);
+        auto const index          = static_cast<std::uint32_t>(_code.constants.size());
+        _code.constants.push_back(toSlot(literal, type));
+        emit(OpCode::Const, slot(res.id), index);
+    }
+
+    auto compileReturn(ValueId inst, Type type) -> void
+    {
+        if (type == Type::Void) {
+            emit(OpCode::ReturnVoid);
+            return;
+        }
+
+        auto const& ops = _registry->get<Operands>(inst);
+        emit(OpCode::Return, 0, slot(ops.list[0]));
+    }
+
+    auto compileBranch(ValueId inst) -> void
+    {
+        auto const& br = read<Branch>(_branches, *_registry, inst);
+        if (br.condition and br.iffalse) {
+            auto const condition = slot(*br.condition);
+            auto trueCopies      = edgeCopies(br.iftrue);
+            auto falseCopies     = edgeCopies(*br.iffalse);
+            _edges.branchIf(
+                _code,
+                condition,
+                br.iftrue,
+                std::move(trueCopies),
+                *br.iffalse,
+                std::move(falseCopies)
+            );
+            return;
+        }
+
+        _edges.jump(_code, br.iftrue, edgeCopies(br.iftrue));
+    }
+
+    // Parallel copies for the phis of target on the edge from the current block.
+    auto edgeCopies(ValueId target) -> std::vector<Bytecode::Copy>
+    {
+        auto const found = _blocks.find(target);
+        if (found == _blocks.end()) {
+            raisef<std::runtime_error>("unknown block");
+        }
+
+        auto pending = std::vector<Bytecode::Copy>{};
+        for (auto const inst : found->second->instructions) {
+            auto const* phi = _registry->try_get<Phi>(inst);
+            if (phi == nullptr) {
+                continue;
+            }
+
+            auto const incoming = std::ranges::find(phi->incoming, _block, &Phi::Incoming::block);
+            if (incoming == phi->incoming.end()) {
+                raisef<std::runtime_error>("phi has no incoming value for block {}", int(_block));
+            }
+
+            auto const copy = Bytecode::Copy{.dst = result(inst), .src = slot(incoming->value)};
+            if (copy.dst != copy.src) {
+                pending.push_back(copy);
+            }
+        }
+        return pending;
+    }
+
+    auto compileBinary(ValueId inst, OpCode op) -> void
+    {
+        auto const [ops, res] = read<Operands, Result>(_instructions, *_registry, inst);
+        emit(op, slot(res.id), slot(ops.list[0]), slot(ops.list[1]));
+    }
+
+    auto compileIntCmp(ValueId inst, Type type) -> void
+    {
+        if (type != Type::Int64 and type != Type::Bool) {
+            raisef<std::runtime_error>("unsupported type {} for integer compare", type);
+        }
+
+        compileBinary(inst, selectCompareOp(_registry->get<CompareKind>(inst)));
+    }
+
+    auto compileTrunc(ValueId inst, Type type) -> void
+    {
+        auto const [ops, res] = read<Operands, Result>(_instructions, *_registry, inst);
+        auto const from       = typeOf(ops.list[0]);
+        emit(selectTruncOp(from, type), slot(res.id), slot(ops.list[0]));
+    }
+
+    [[nodiscard]] auto typeOf(ValueId reg) const -> Type
+    {
+        auto const found = _types.find(reg);
+        if (found == _types.end()) {
+            raisef<std::runtime_error>("use of undefined register {}", int(reg));
+        }
+        return found->second;
+    }
+
+    [[nodiscard]] auto slot(ValueId reg) -> std::uint32_t { return _slots.add(reg); }
+
+    [[nodiscard]] auto result(ValueId inst) -> std::uint32_t
+    {
+        return slot(_registry->get<Result>(inst).id);
+    }
+
+    [[nodiscard]] auto pc() const -> std::uint32_t
+    {
+        return static_cast<std::uint32_t>(_code.code.size());
+    }
+
+    auto emit(OpCode op, std::uint32_t dst = 0, std::uint32_t lhs = 0, std::uint32_t rhs = 0) -> void
+    {
+        _code.code.push_back(Bytecode::Inst{.op = op, .dst = dst, .lhs = lhs, .rhs = rhs});
+    }
+
+    Function _func;
+    Registry const* _registry;
+    InstructionGroup _instructions;
+    LiteralGroup _literals;
+    BranchGroup _branches;
+    Bytecode _code;
+    LocalIdMap<ValueId, std::uint32_t> _slots;
+    std::map<ValueId, Type> _types;
+    std::map<ValueId, std::uint32_t> _labels;
+    std::map<ValueId, BasicBlock const*> _blocks;
+    EdgeEmitter<ValueId> _edges;
+    ValueId _block{};
+};
+
+}  // namespace
+
+auto toSlot(Literal const& literal, Type type) -> Slot
+{
+    switch (type) {
+        case Type::Bool: return literalToSlot<bool>(literal, type);
+        case Type::Int64: return literalToSlot<std::int64_t>(literal, type);
+        case Type::Float: return literalToSlot<float>(literal, type);
+        case Type::Double: return literalToSlot<double>(literal, type);
+        default: raisef<std::invalid_argument>("unsupported type {} for literal", type);
+    }
+}
+
+auto toLiteral(Slot slot, Type type) -> Literal
+{
+    switch (type) {
+        case Type::Void: return Literal{std::nan("")};
+        case Type::Bool: return Literal{fromSlot<bool>(slot)};
+        case Type::Int64: return Literal{fromSlot<std::int64_t>(slot)};
+        case Type::Float: return Literal{fromSlot<float>(slot)};
+        case Type::Double: return Literal{fromSlot<double>(slot)};
+        default: raisef<std::invalid_argument>("unsupported type {} for literal", type);
+    }
+}
+
+auto Bytecode::compile(Function const& func, bool optimize) -> Bytecode
+{
+    auto code = BytecodeCompiler{func}.run();
+    if (optimize) {
+        fuseSuperinstructions(code);
+        (void)compactFrame(code);
+    }
+    return code;
+}
+
+}  // namespace snir
@@ -0,0 +1,301 @@
+#pragma once
+
+#include "snir/core/Concepts.hpp"
+#include "snir/ir/Function.hpp"
+#include "snir/ir/Literal.hpp"
+#include "snir/ir/OpCode.hpp"
+#include "snir/ir/Type.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <concepts>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+namespace snir {
+
+/// \brief Untyped interpreter register. The opcode reading a slot decides
+/// how its bits are interpreted.
+using Slot = std::uint64_t;
+
+template<typename T>
+[[nodiscard]] constexpr auto toSlot(T value) noexcept -> Slot
+{
+    if constexpr (std::same_as<T, bool>) {
+        return value ? 1U : 0U;
+    } else if constexpr (std::same_as<T, std::int64_t>) {
+        return std::bit_cast<Slot>(value);
+    } else if constexpr (std::same_as<T, float>) {
+        return std::bit_cast<std::uint32_t>(value);
+    } else if constexpr (std::same_as<T, double>) {
+        return std::bit_cast<Slot>(value);
+    } else {
+        static_assert(AlwaysFalse<T>);
+    }
+}
+
+template<typename T>
+[[nodiscard]] constexpr auto fromSlot(Slot slot) noexcept -> T
+{
+    if constexpr (std::same_as<T, bool>) {
+        return slot != 0;
+    } else if constexpr (std::same_as<T, std::int64_t>) {
+        return std::bit_cast<std::int64_t>(slot);
+    } else if constexpr (std::same_as<T, float>) {
+        return std::bit_cast<float>(static_cast<std::uint32_t>(slot));
+    } else if constexpr (std::same_as<T, double>) {
+        return std::bit_cast<double>(slot);
+    } else {
+        static_assert(AlwaysFalse<T>);
+    }
+}
+
+/// \brief IR type stored in a slot for the C++ type T.
+template<typename T>
+[[nodiscard]] constexpr auto typeOf() noexcept -> Type
+{
+    if constexpr (std::same_as<T, bool>) {
+        return Type::Bool;
+    } else if constexpr (std::same_as<T, std::int64_t>) {
+        return Type::Int64;
+    } else if constexpr (std::same_as<T, float>) {
+        return Type::Float;
+    } else if constexpr (std::same_as<T, double>) {
+        return Type::Double;
+    } else {
+        static_assert(AlwaysFalse<T>);
+    }
+}
+
+namespace detail {
+
+template<typename T>
+[[nodiscard]] constexpr auto typeOrVoid() noexcept -> Type
+{
+    if constexpr (std::is_void_v<T>) {
+        return Type::Void;
+    } else {
+        return typeOf<T>();
+    }
+}
+
+/// \brief Type a C++ call argument is passed as, integers widen to i64.
+template<typename T>
+using ArgumentType
+    = std::conditional_t<std::integral<T> and not std::same_as<T, bool>, std::int64_t, T>;
+
+/// \brief Checks a C++ function type against an IR signature.
+template<typename Signature>
+struct SignatureTraits;
+
+template<typename R, typename... Args>
+struct SignatureTraits<R(Args...)>
+{
+    [[nodiscard]] static constexpr auto matches(Type type, std::span<Type const> arguments) -> bool
+    {
+        auto const types = std::array<Type, sizeof...(Args)>{typeOf<Args>()...};
+        return type == typeOrVoid<R>() and std::ranges::equal(types, arguments);
+    }
+};
+
+}  // namespace detail
+
+[[nodiscard]] auto toSlot(Literal const& literal, Type type) -> Slot;
+[[nodiscard]] auto toLiteral(Slot slot, Type type) -> Literal;
+
+namespace detail {
+
+constexpr auto shiftLeft = []<typename T>(T lhs, T rhs) {
+    return static_cast<T>(std::uint64_t(lhs) << std::uint64_t(rhs));
+};
+
+constexpr auto shiftRight = []<typename T>(T lhs, T rhs) {
+    return static_cast<T>(std::uint64_t(lhs) >> std::uint64_t(rhs));
+};
+
+template<typename T, typename Op>
+[[nodiscard]] constexpr auto binary(Slot lhs, Slot rhs, Op op) -> Slot
+{
+    return toSlot(static_cast<T>(op(fromSlot<T>(lhs), fromSlot<T>(rhs))));
+}
+
+}  // namespace detail
+
+/// \brief Applies a Binary format opcode to two slots.
+// NOLINTNEXTLINE(readability-function-cognitive-complexity)
+template<OpCode Op>
+[[nodiscard]] constexpr auto evaluate(Slot lhs, Slot rhs) -> Slot
+{
+    using enum OpCode;
+    using detail::binary;
+
+    if constexpr (Op == AddI64) {
+        return binary<std::int64_t>(lhs, rhs, std::plus{});
+    } else if constexpr (Op == SubI64) {
+        return binary<std::int64_t>(lhs, rhs, std::minus{});
+    } else if constexpr (Op == MulI64) {
+        return binary<std::int64_t>(lhs, rhs, std::multiplies{});
+    } else if constexpr (Op == DivI64) {
+        return binary<std::int64_t>(lhs, rhs, std::divides{});
+    } else if constexpr (Op == ModI64) {
+        return binary<std::int64_t>(lhs, rhs, std::modulus{});
+    } else if constexpr (Op == AndI64) {
+        return binary<std::int64_t>(lhs, rhs, std::bit_and{});
+    } else if constexpr (Op == OrI64) {
+        return binary<std::int64_t>(lhs, rhs, std::bit_or{});
+    } else if constexpr (Op == XorI64) {
+        return binary<std::int64_t>(lhs, rhs, std::bit_xor{});
+    } else if constexpr (Op == ShiftLeftI64) {
+        return binary<std::int64_t>(lhs, rhs, detail::shiftLeft);
+    } else if constexpr (Op == ShiftRightI64) {
+        return binary<std::int64_t>(lhs, rhs, detail::shiftRight);
+    } else if constexpr (Op == CmpEq) {
+        return toSlot(lhs == rhs);
+    } else if constexpr (Op == CmpNe) {
+        return toSlot(lhs != rhs);
+    } else if constexpr (Op == FloatAddF32) {
+        return binary<float>(lhs, rhs, std::plus{});
+    } else if constexpr (Op == FloatSubF32) {
+        return binary<float>(lhs, rhs, std::minus{});
+    } else if constexpr (Op == FloatMulF32) {
+        return binary<float>(lhs, rhs, std::multiplies{});
+    } else if constexpr (Op == FloatDivF32) {
+        return binary<float>(lhs, rhs, std::divides{});
+    } else if constexpr (Op == FloatAddF64) {
+        return binary<double>(lhs, rhs, std::plus{});
+    } else if constexpr (Op == FloatSubF64) {
+        return binary<double>(lhs, rhs, std::minus{});
+    } else if constexpr (Op == FloatMulF64) {
+        return binary<double>(lhs, rhs, std::multiplies{});
+    } else if constexpr (Op == FloatDivF64) {
+        return binary<double>(lhs, rhs, std::divides{});
+    } else {
+        static_assert(AlwaysFalse<decltype(Op)>);
+    }
+}
+
+/// \brief Applies a Unary format opcode to a slot.
+template<OpCode Op>
+[[nodiscard]] constexpr auto evaluate(Slot value) -> Slot
+{
+    using enum OpCode;
+
+    if constexpr (Op == Move) {
+        return value;
+    } else if constexpr (Op == TruncI64ToF32) {
+        return toSlot(static_cast<float>(fromSlot<std::int64_t>(value)));
+    } else if constexpr (Op == TruncI64ToF64) {
+        return toSlot(static_cast<double>(fromSlot<std::int64_t>(value)));
+    } else if constexpr (Op == TruncF32ToI64) {
+        return toSlot(static_cast<std::int64_t>(fromSlot<float>(value)));
+    } else if constexpr (Op == TruncF32ToF64) {
+        return toSlot(static_cast<double>(fromSlot<float>(value)));
+    } else if constexpr (Op == TruncF64ToI64) {
+        return toSlot(static_cast<std::int64_t>(fromSlot<double>(value)));
+    } else if constexpr (Op == TruncF64ToF32) {
+        return toSlot(static_cast<float>(fromSlot<double>(value)));
+    } else {
+        static_assert(AlwaysFalse<decltype(Op)>);
+    }
+}
+
+/// \brief Flat register-machine encoding of a single Function.
+///
+/// Arguments occupy the first slots of the frame, every other register
+/// gets a dense slot index. Block labels are resolved to offsets into
+/// code, so executing a Bytecode never touches the registry.
+struct Bytecode
+{
+    /// Operand layout depends on the OpFormat of op, see OpCode.hpp.
+    struct Inst
+    {
+        OpCode op{};
+        std::uint32_t dst{0};
+        std::uint32_t lhs{0};
+        std::uint32_t rhs{0};
+    };
+
+    /// Slot move executed when a CFG edge into a block with phis is taken.
+    /// The copies of one edge are ordered so running them in sequence has
+    /// the parallel semantics of the phis.
+    struct Copy
+    {
+        std::uint32_t dst{0};
+        std::uint32_t src{0};
+    };
+
+    /// Adjacent instructions are merged into superinstructions and frame
+    /// slots are reused if optimize is set.
+    [[nodiscard]] static auto compile(Function const& func, bool optimize = true) -> Bytecode;
+
+    Type type{Type::Void};
+    std::vector<Type> arguments;
+    std::vector<Inst> code;
+    std::vector<Slot> constants;
+    std::vector<Copy> copies;
+    std::vector<std::uint32_t> labels;  ///< First pc of each basic block, by block number.
+    std::uint32_t registers{0};
+};
+
+/// \brief Calls func with every slot read by inst. The sources of a
+/// JumpCopy are not included, they live in Bytecode::copies.
+template<typename Inst, typename Func>
+    requires std::same_as<std::remove_const_t<Inst>, Bytecode::Inst>
+constexpr auto forEachRead(Inst& inst, Func func) -> void
+{
+    switch (getOpFormat(inst.op)) {
+        case OpFormat::Unary:
+        case OpFormat::BinaryConst:
+        case OpFormat::Branch:
+        case OpFormat::Return: func(inst.lhs); break;
+        case OpFormat::Binary:
+        case OpFormat::CompareBranch:
+        case OpFormat::ReturnBinary:
+            func(inst.lhs);
+            func(inst.rhs);
+            break;
+        default: break;
+    }
+}
+
+/// \brief Calls func with every slot written by inst. The destinations of
+/// a JumpCopy are not included, they live in Bytecode::copies.
+template<typename Inst, typename Func>
+    requires std::same_as<std::remove_const_t<Inst>, Bytecode::Inst>
+constexpr auto forEachWrite(Inst& inst, Func func) -> void
+{
+    switch (getOpFormat(inst.op)) {
+        case OpFormat::Const:
+        case OpFormat::Unary:
+        case OpFormat::Binary:
+        case OpFormat::BinaryConst: func(inst.dst); break;
+        case OpFormat::ConstPair:
+            func(inst.dst);
+            func(inst.rhs);
+            break;
+        default: break;
+    }
+}
+
+/// \brief Calls func with a reference to every jump target field of inst.
+template<typename Inst, typename Func>
+    requires std::same_as<std::remove_const_t<Inst>, Bytecode::Inst>
+constexpr auto forEachTarget(Inst& inst, Func func) -> void
+{
+    switch (getOpFormat(inst.op)) {
+        case OpFormat::Jump:
+        case OpFormat::JumpCopy:
+        case OpFormat::CompareBranch: func(inst.dst); break;
+        case OpFormat::Branch:
+            func(inst.dst);
+            func(inst.rhs);
+            break;
+        default: break;
+    }
+}
+
+}  // namespace snir
@@ -0,0 +1,336 @@
+#include "CWriter.hpp"
+
+#include "snir/core/Exception.hpp"
+#include "snir/ir/AnalysisManager.hpp"
+#include "snir/ir/BasicBlock.hpp"
+#include "snir/ir/Branch.hpp"
+#include "snir/ir/CompareKind.hpp"
+#include "snir/ir/Function.hpp"
+#include "snir/ir/InstKind.hpp"
+#include "snir/ir/InstructionList.hpp"
+#include "snir/ir/Literal.hpp"
+#include "snir/ir/Module.hpp"
+#include "snir/ir/Operands.hpp"
+#include "snir/ir/Phi.hpp"
+#include "snir/ir/Registry.hpp"
+#include "snir/ir/Result.hpp"
+#include "snir/ir/Type.hpp"
+#include "snir/ir/Value.hpp"
+#include "snir/ir/ValueId.hpp"
+
+#include "fmt/format.h"
+#include "fmt/os.h"
+#include "fmt/ostream.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace snir {
+
+namespace {
+
+[[nodiscard]] auto cType(Type type) -> std::string_view
+{
+    switch (type) {
+        case Type::Void: return "void";
+        case Type::Bool: return "bool";
+        case Type::Int64: return "int64_t";
+        case Type::Float: return "float";
+        case Type::Double: return "double";
+        default: raisef<std::runtime_error>("unsupported type {} in c backend", type);
+    }
+}
+
+template<typename T>
+[[nodiscard]] auto formatFloat(T value, std::string_view suffix) -> std::string
+{
+    if (std::isnan(value)) {
+        return "NAN";
+    }
+    if (std::isinf(value)) {
+        return value < T(0) ? "-INFINITY" : "INFINITY";
+    }
+    // Hexadecimal literals round-trip exactly.
+    return fmt::format("{:a}{}", value, suffix);
+}
+
+[[nodiscard]] auto formatLiteral(Literal const& literal) -> std::string
+{
+    if (auto const* val = std::get_if<bool>(&literal.value); val != nullptr) {
+        return *val ? "true" : "false";
+    }
+    if (auto const* val = std::get_if<std::int64_t>(&literal.value); val != nullptr) {
+        if (*val == std::numeric_limits<std::int64_t>::min()) {
+            return "INT64_MIN";
+        }
+        return fmt::format("INT64_C({})", *val);
+    }
+    if (auto const* val = std::get_if<float>(&literal.value); val != nullptr) {
+        return formatFloat(*val, "f");
+    }
+    return formatFloat(std::get<double>(literal.value), "");
+}
+
+// Signed overflow is undefined in C, wrap like the interpreter does.
+[[nodiscard]] auto isWrapping(InstKind kind) -> bool
+{
+    switch (kind) {
+        case InstKind::Add:
+        case InstKind::Sub:
+        case InstKind::Mul:
+        case InstKind::ShiftLeft:
+        case InstKind::ShiftRight: return true;
+        default: return false;
+    }
+}
+
+[[nodiscard]] auto binaryOperator(InstKind kind) -> std::string_view
+{
+    switch (kind) {
+        case InstKind::Add:
+        case InstKind::FloatAdd: return "+";
+        case InstKind::Sub:
+        case InstKind::FloatSub: return "-";
+        case InstKind::Mul:
+        case InstKind::FloatMul: return "*";
+        case InstKind::Div:
+        case InstKind::FloatDiv: return "/";
+        case InstKind::Mod: return "%";
+        case InstKind::And: return "&";
+        case InstKind::Or: return "|";
+        case InstKind::Xor: return "^";
+        case InstKind::ShiftLeft: return "<<";
+        case InstKind::ShiftRight: return ">>";
+        default: raisef<std::runtime_error>("{} is not a binary instruction", kind);
+    }
+}
+
+[[nodiscard]] auto isTerminator(Registry const& reg, ValueId inst) -> bool
+{
+    auto const kind = reg.get<InstKind>(inst);
+    return kind == InstKind::Return or kind == InstKind::Branch;
+}
+
+}  // namespace
+
+CWriter::CWriter(std::ostream& out) : _out{out} {}
+
+auto CWriter::operator()(Module& module) -> void
+{
+    auto dummy = AnalysisManager<Function>{};
+    for (auto func : module.functions()) {
+        (*this)(func, dummy);
+    }
+}
+
+auto CWriter::operator()(Function& func, AnalysisManager<Function>& /*analysis*/) -> void
+{
+    if (not std::exchange(_header, true)) {
+        writeHeader();
+    }
+
+    _localIds.clear();
+    _types.clear();
+    writeFunction(func);
+}
+
+auto CWriter::writeHeader() -> void
+{
+    fmt::println(_out, "#include <math.h>");
+    fmt::println(_out, "#include <stdbool.h>");
+    fmt::println(_out, "#include <stdint.h>");
+    fmt::println(_out, "#include <stdlib.h>\n");
+}
+
+auto CWriter::writeFunction(Function& func) -> void
+{
+    auto& reg = *func.asValue().registry();
+
+    fmt::print(_out, "{} {}(", cType(func.type()), func.identifier());
+    auto const& args = func.arguments();
+    for (auto i = 0zu; i < args.size(); ++i) {
+        auto const type = reg.get<Type>(args[i]);
+        _types.emplace(args[i], type);
+        fmt::print(_out, "{}{} v{}", i == 0 ? "" : ", ", cType(type), _localIds.add(args[i]));
+    }
+    fmt::println(_out, "{})\n{{", args.empty() ? "void" : "");
+
+    writeDeclarations(func);
+
+    auto const& blocks = func.basicBlocks();
+    for (auto const& block : blocks) {
+        writeBasicBlock(func, block);
+    }
+
+    // Falling off the end has no defined result, the interpreter raises.
+    auto const& last = blocks.empty() ? InstructionList{} : blocks.back().instructions;
+    if (last.empty() or not isTerminator(reg, last.back())) {
+        fmt::println(_out, "    abort();");
+    }
+    fmt::println(_out, "}}\n");
+}
+
+auto CWriter::writeDeclarations(Function& func) -> void
+{
+    auto& reg = *func.asValue().registry();
+    for (auto const& block : func.basicBlocks()) {
+        for (auto const inst : block.instructions) {
+            auto const* result = reg.try_get<Result>(inst);
+            if (result == nullptr) {
+                continue;
+            }
+
+            auto const [kind, type] = reg.get<InstKind, Type>(inst);
+            auto const resultType   = kind == InstKind::IntCmp ? Type::Bool : type;
+            _types.emplace(result->id, resultType);
+            fmt::println(_out, "    {} v{};", cType(resultType), _localIds.add(result->id));
+        }
+    }
+}
+
+auto CWriter::writeBasicBlock(Function& func, BasicBlock const& block) -> void
+{
+    auto& reg = *func.asValue().registry();
+    auto local = [this](ValueId val) { return fmt::format("v{}", _localIds.add(val)); };
+
+    fmt::println(_out, "bb{}:;", _localIds.add(block.label));
+    for (auto const inst : block.instructions) {
+        auto const [kind, type] = reg.get<InstKind, Type>(inst);
+        switch (kind) {
+            case InstKind::Nop:
+            case InstKind::Phi: break;
+            case InstKind::Const: {
+                auto const [id] = reg.get<Result>(inst);
+                fmt::println(_out, "    {} = {};", local(id), formatLiteral(reg.get<Literal>(inst)));
+                break;
+            }
+            case InstKind::Return: {
+                if (type == Type::Void) {
+                    fmt::println(_out, "    return;");
+                } else {
+                    auto const& args = reg.get<Operands>(inst);
+                    fmt::println(_out, "    return {};", local(args.list[0]));
+                }
+                break;
+            }
+            case InstKind::Branch: {
+                auto const& br = reg.get<Branch>(inst);
+                if (br.condition and br.iffalse) {
+                    fmt::println(_out, "    if ({}) {{", local(*br.condition));
+                    writeEdge(func, block.label, br.iftrue, 2);
+                    fmt::println(_out, "    }}");
+                    writeEdge(func, block.label, *br.iffalse, 1);
+                } else {
+                    writeEdge(func, block.label, br.iftrue, 1);
+                }
+                break;
+            }
+            case InstKind::Add:
+            case InstKind::Sub:
+            case InstKind::Mul:
+            case InstKind::Div:
+            case InstKind::Mod:
+            case InstKind::And:
+            case InstKind::Or:
+            case InstKind::Xor:
+            case InstKind::ShiftLeft:
+            case InstKind::ShiftRight:
+            case InstKind::FloatAdd:
+            case InstKind::FloatSub:
+            case InstKind::FloatMul:
+            case InstKind::FloatDiv: {
+                auto const [id]  = reg.get<Result>(inst);
+                auto const& args = reg.get<Operands>(inst);
+                auto const res   = local(id);
+                auto const lhs   = local(args.list[0]);
+                auto const rhs   = local(args.list[1]);
+                auto const op    = binaryOperator(kind);
+                if (isWrapping(kind)) {
+                    fmt::println(
+                        _out,
+                        "    {} = (int64_t)((uint64_t){} {} (uint64_t){});",
+                        res,
+                        lhs,
+                        op,
+                        rhs
+                    );
+                } else {
+                    fmt::println(_out, "    {} = {} {} {};", res, lhs, op, rhs);
+                }
+                break;
+            }
+            case InstKind::IntCmp: {
+                auto const [id]  = reg.get<Result>(inst);
+                auto const& args = reg.get<Operands>(inst);
+                auto const cmp   = reg.get<CompareKind>(inst) == CompareKind::Equal ? "==" : "!=";
+                auto const lhs   = local(args.list[0]);
+                auto const rhs   = local(args.list[1]);
+                fmt::println(_out, "    {} = {} {} {};", local(id), lhs, cmp, rhs);
+                break;
+            }
+            case InstKind::Trunc: {
+                auto const [id]  = reg.get<Result>(inst);
+                auto const& args = reg.get<Operands>(inst);
+                fmt::println(_out, "    {} = ({}){};", local(id), cType(type), local(args.list[0]));
+                break;
+            }
+            default: raisef<std::runtime_error>("unimplemented: {}<{}>", kind, type);
+        }
+    }
+}
+
+// Assigns the phis of to for the edge from the given block and jumps. Phis
+// read their inputs in parallel, several of them go through temporaries.
+auto CWriter::writeEdge(Function& func, ValueId from, ValueId to, std::size_t depth) -> void
+{
+    auto& reg          = *func.asValue().registry();
+    auto const& blocks = func.basicBlocks();
+    auto const target  = std::ranges::find(blocks, to, &BasicBlock::label);
+    if (target == blocks.end()) {
+        raisef<std::runtime_error>("unknown block");
+    }
+
+    auto copies = std::vector<std::pair<ValueId, ValueId>>{};
+    for (auto const inst : target->instructions) {
+        auto const* phi = reg.try_get<Phi>(inst);
+        if (phi == nullptr) {
+            continue;
+        }
+
+        auto const incoming = std::ranges::find(phi->incoming, from, &Phi::Incoming::block);
+        if (incoming == phi->incoming.end()) {
+            raisef<std::runtime_error>("phi has no incoming value for block {}", int(from));
+        }
+        copies.emplace_back(reg.get<Result>(inst).id, incoming->value);
+    }
+
+    auto const indent = std::string(depth * 4U, ' ');
+    if (copies.size() == 1U) {
+        auto const [dst, src] = copies.front();
+        fmt::println(_out, "{}v{} = v{};", indent, _localIds.add(dst), _localIds.add(src));
+    } else if (not copies.empty()) {
+        fmt::println(_out, "{}{{", indent);
+        for (auto i = 0zu; i < copies.size(); ++i) {
+            auto const src  = copies[i].second;
+            auto const type = cType(_types.at(src));
+            fmt::println(_out, "{}    {} t{} = v{};", indent, type, i, _localIds.add(src));
+        }
+        for (auto i = 0zu; i < copies.size(); ++i) {
+            fmt::println(_out, "{}    v{} = t{};", indent, _localIds.add(copies[i].first), i);
+        }
+        fmt::println(_out, "{}}}", indent);
+    }
+    fmt::println(_out, "{}goto bb{};", indent, _localIds.add(to));
+}
+
+}  // namespace snir
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "snir/core/LocalIdMap.hpp"
+#include "snir/ir/AnalysisManager.hpp"
+#include "snir/ir/BasicBlock.hpp"
+#include "snir/ir/Function.hpp"
+#include "snir/ir/Module.hpp"
+#include "snir/ir/Type.hpp"
+#include "snir/ir/ValueId.hpp"
+
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <ostream>
+#include <string_view>
+
+namespace snir {
+
+/// \brief Writes a Module as portable C11, one C function per function.
+/// Blocks become labels, branches goto and phis are assigned on each edge.
+struct CWriter
+{
+    static constexpr auto name = std::string_view{"CWriter"};
+
+    explicit CWriter(std::ostream& out);
+
+    auto operator()(Module& module) -> void;
+    auto operator()(Function& func, AnalysisManager<Function>& analysis) -> void;
+
+private:
+    auto writeHeader() -> void;
+    auto writeFunction(Function& func) -> void;
+    auto writeDeclarations(Function& func) -> void;
+    auto writeBasicBlock(Function& func, BasicBlock const& block) -> void;
+    auto writeEdge(Function& func, ValueId from, ValueId to, std::size_t depth) -> void;
+
+    std::reference_wrapper<std::ostream> _out;
+    LocalIdMap<ValueId, int> _localIds;
+    std::map<ValueId, Type> _types;
+    bool _header{false};
+};
+
+}  // namespace snir
@@ -0,0 +1,179 @@
+#include "ClosureFunction.hpp"
+
+#include "snir/core/Exception.hpp"
+#include "snir/ir/Bytecode.hpp"
+#include "snir/ir/Function.hpp"
+#include "snir/ir/Literal.hpp"
+#include "snir/ir/OpCode.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+namespace snir {
+
+namespace {
+
+using Node = ClosureFunction::Node;
+
+// NOLINTNEXTLINE(readability-function-cognitive-complexity)
+template<OpCode Op>
+[[nodiscard]] auto handle(Node const& node, Slot* frame) -> Node const*
+{
+    constexpr auto format = getOpFormat(Op);
+    constexpr auto base   = getBaseOpCode(Op);
+
+    if constexpr (Op == OpCode::Unreachable) {
+        raisef<std::runtime_error>("reached end of function without return");
+    } else if constexpr (Op == OpCode::ReturnVoid) {
+        return nullptr;
+    } else if constexpr (format == OpFormat::Const) {
+        frame[node.dst] = node.imm[0];
+    } else if constexpr (format == OpFormat::ConstPair) {
+        frame[node.dst] = node.imm[0];
+        frame[node.rhs] = node.imm[1];
+    } else if constexpr (format == OpFormat::Unary) {
+        frame[node.dst] = evaluate<base>(frame[node.lhs]);
+    } else if constexpr (format == OpFormat::Binary) {
+        frame[node.dst] = evaluate<base>(frame[node.lhs], frame[node.rhs]);
+    } else if constexpr (format == OpFormat::BinaryConst) {
+        frame[node.dst] = evaluate<base>(frame[node.lhs], node.imm[0]);
+    } else if constexpr (format == OpFormat::JumpCopy) {
+        for (auto const copy : node.copies) {
+            frame[copy.dst] = frame[copy.src];
+        }
+    } else if constexpr (format == OpFormat::Branch) {
+        return frame[node.lhs] != 0 ? node.target : node.next;
+    } else if constexpr (format == OpFormat::CompareBranch) {
+        return evaluate<base>(frame[node.lhs], frame[node.rhs]) != 0 ? node.target : node.next;
+    } else if constexpr (format == OpFormat::Return) {
+        frame[node.dst] = frame[node.lhs];
+        return nullptr;
+    } else if constexpr (format == OpFormat::ReturnConst) {
+        frame[node.dst] = node.imm[0];
+        return nullptr;
+    } else if constexpr (format == OpFormat::ReturnBinary) {
+        frame[node.dst] = evaluate<base>(frame[node.lhs], frame[node.rhs]);
+        return nullptr;
+    } else {
+        static_assert(format == OpFormat::Jump);
+    }
+
+    return node.next;
+}
+
+constexpr auto handlers = std::array{
+#define SNIR_OP_CODE(Id, Name, Format) &handle<OpCode::Id>,
+#include "snir/ir/OpCode.def"
+};
+
+[[nodiscard]] auto isJump(Node const* node) -> bool
+{
+    return node != nullptr and node->run == handlers[static_cast<std::size_t>(OpCode::Jump)];
+}
+
+// Skips chains of unconditional jumps, bounded for jump cycles.
+[[nodiscard]] auto resolve(Node const* node) -> Node const*
+{
+    for (auto i = 0; i < 16 and isJump(node); ++i) {
+        node = node->next;
+    }
+    return node;
+}
+
+}  // namespace
+
+ClosureFunction::ClosureFunction(Bytecode const& code)
+    : _type{code.type}
+    , _arguments{code.arguments}
+    , _nodes(code.code.size())
+    , _copies{code.copies}
+    , _registers{code.registers}
+{
+    auto const at = [this](std::uint32_t pc) { return &_nodes.at(pc); };
+
+    for (auto pc = 0U; pc < code.code.size(); ++pc) {
+        auto const& inst = code.code[pc];
+        auto& node       = _nodes[pc];
+        node.run         = handlers[static_cast<std::size_t>(inst.op)];
+        node.dst         = inst.dst;
+        node.lhs         = inst.lhs;
+        node.rhs         = inst.rhs;
+        if (pc + 1U < code.code.size()) {
+            node.next = at(pc + 1U);
+        }
+
+        switch (getOpFormat(inst.op)) {
+            case OpFormat::Const: node.imm[0] = code.constants[inst.lhs]; break;
+            case OpFormat::ConstPair: {
+                node.imm[0] = code.constants[inst.lhs];
+                node.imm[1] = code.constants[inst.lhs + 1U];
+                break;
+            }
+            case OpFormat::BinaryConst: node.imm[0] = code.constants[inst.rhs]; break;
+            case OpFormat::Jump: node.next = at(inst.dst); break;
+            case OpFormat::JumpCopy: {
+                node.next   = at(inst.dst);
+                node.copies = std::span{_copies}.subspan(inst.lhs, inst.rhs - inst.lhs);
+                break;
+            }
+            case OpFormat::Branch: {
+                node.target = at(inst.dst);
+                node.next   = at(inst.rhs);
+                break;
+            }
+            case OpFormat::CompareBranch: node.target = at(inst.dst); break;
+            case OpFormat::ReturnConst: {
+                node.imm[0] = code.constants[inst.lhs];
+                node.dst    = _registers;
+                break;
+            }
+            case OpFormat::Return:
+            case OpFormat::ReturnBinary: node.dst = _registers; break;
+            default: break;
+        }
+    }
+
+    for (auto& node : _nodes) {
+        node.next   = resolve(node.next);
+        node.target = resolve(node.target);
+    }
+}
+
+auto ClosureFunction::compile(Function const& func) -> ClosureFunction
+{
+    return compile(Bytecode::compile(func));
+}
+
+auto ClosureFunction::compile(Bytecode const& code) -> ClosureFunction
+{
+    return ClosureFunction{code};
+}
+
+auto ClosureFunction::run(std::span<Slot> frame, std::uint32_t entry) const -> Slot
+{
+    auto* const slots = frame.data();
+    for (auto const* node = resolve(&_nodes.at(entry)); node != nullptr;) {
+        node = node->run(*node, slots);
+    }
+    return slots[_registers];
+}
+
+auto ClosureFunction::execute(std::span<Literal const> args) -> std::optional<Literal>
+{
+    if (_arguments.size() != args.size()) {
+        return std::nullopt;
+    }
+
+    _frame.assign(frameSize(), Slot{0});
+    for (auto i = 0zu; i < args.size(); ++i) {
+        _frame[i] = toSlot(args[i], _arguments[i]);
+    }
+    return toLiteral(run(_frame), _type);
+}
+
+}  // namespace snir
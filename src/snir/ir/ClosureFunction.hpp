@@ -0,0 +1,72 @@
+#pragma once
+
+#include "snir/ir/Bytecode.hpp"
+#include "snir/ir/Function.hpp"
+#include "snir/ir/Literal.hpp"
+#include "snir/ir/Type.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace snir {
+
+/// \brief Function compiled once into a graph of pre-bound handlers.
+///
+/// Every instruction becomes a node holding a handler specialised for its
+/// opcode, the operand slots and constant operands. Nodes link directly
+/// to their successors, unconditional jumps are resolved while linking.
+/// Works on every platform without generating machine code.
+struct ClosureFunction
+{
+    struct Node;
+
+    /// Runs one node and returns the next, or nullptr after a return.
+    using Handler = auto (*)(Node const& node, Slot* frame) -> Node const*;
+
+    struct Node
+    {
+        Handler run{nullptr};
+        std::uint32_t dst{0};
+        std::uint32_t lhs{0};
+        std::uint32_t rhs{0};
+        std::array<Slot, 2> imm{};
+        std::span<Bytecode::Copy const> copies;
+        Node const* next{nullptr};
+        Node const* target{nullptr};
+    };
+
+    [[nodiscard]] static auto compile(Function const& func) -> ClosureFunction;
+    [[nodiscard]] static auto compile(Bytecode const& code) -> ClosureFunction;
+
+    ClosureFunction(ClosureFunction const& other)                    = delete;
+    ClosureFunction(ClosureFunction&& other) noexcept                = default;
+    ~ClosureFunction()                                               = default;
+    auto operator=(ClosureFunction const& other) -> ClosureFunction& = delete;
+    auto operator=(ClosureFunction&& other) noexcept -> ClosureFunction& = default;
+
+    /// Number of slots a frame passed to run() needs.
+    [[nodiscard]] auto frameSize() const noexcept -> std::size_t { return _registers + 1U; }
+
+    /// \brief Runs on a caller owned frame with the arguments in the first
+    /// slots. Nodes keep the pcs of the bytecode they were compiled from, a
+    /// frame an interpreter left at a block boundary continues from entry.
+    [[nodiscard]] auto run(std::span<Slot> frame, std::uint32_t entry = 0) const -> Slot;
+
+    [[nodiscard]] auto execute(std::span<Literal const> args) -> std::optional<Literal>;
+
+private:
+    explicit ClosureFunction(Bytecode const& code);
+
+    Type _type{Type::Void};
+    std::vector<Type> _arguments;
+    std::vector<Node> _nodes;
+    std::vector<Bytecode::Copy> _copies;
+    std::vector<Slot> _frame;
+    std::uint32_t _registers{0};
+};
+
+}  // namespace snir
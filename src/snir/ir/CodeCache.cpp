@@ -0,0 +1,67 @@
+#include "CodeCache.hpp"
+
+#include "snir/ir/Bytecode.hpp"
+#include "snir/ir/Function.hpp"
+#include "snir/ir/Registry.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <utility>
+
+namespace snir {
+
+auto CodeCache::get(Function const& func) -> std::shared_ptr<Bytecode const>
+{
+    auto const key     = makeKey(func);
+    auto const& reg    = *key.registry;
+    auto const gen     = generation(reg);
+    auto const rev     = revision(reg);
+    auto const current = [gen, rev](Entry const& entry) {
+        return entry.generation == gen and entry.revision == rev;
+    };
+
+    {
+        auto const lock  = std::shared_lock{_mutex};
+        auto const found = _code.find(key);
+        if (found != _code.end() and current(found->second)) {
+            return found->second.code;
+        }
+    }
+
+    // Compiled without holding the lock, only reads the registry. If another
+    // thread was faster its bytecode wins.
+    auto code       = std::make_shared<Bytecode const>(Bytecode::compile(func));
+    auto const lock = std::scoped_lock{_mutex};
+    auto& entry     = _code[key];
+    if (not entry.code or not current(entry)) {
+        entry = Entry{.generation = gen, .revision = rev, .code = std::move(code)};
+    }
+    return entry.code;
+}
+
+auto CodeCache::erase(Function const& func) -> void
+{
+    auto const lock = std::scoped_lock{_mutex};
+    _code.erase(makeKey(func));
+}
+
+auto CodeCache::clear() -> void
+{
+    auto const lock = std::scoped_lock{_mutex};
+    _code.clear();
+}
+
+auto CodeCache::size() const -> std::size_t
+{
+    auto const lock = std::shared_lock{_mutex};
+    return _code.size();
+}
+
+auto CodeCache::makeKey(Function const& func) -> Key
+{
+    return Key{.registry = func.asValue().registry(), .func = func};
+}
+
+}  // namespace snir
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "snir/ir/Bytecode.hpp"
+#include "snir/ir/Function.hpp"
+#include "snir/ir/Registry.hpp"
+#include "snir/ir/ValueId.hpp"
+
+#include <compare>
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <shared_mutex>
+
+namespace snir {
+
+/// \brief Bytecode per function, compiled on the first call through a
+/// Function instead of lowering, fusing and compacting it again each time.
+///
+/// Safe to share between threads, the bytecode is immutable once cached.
+/// There is one entry per registry and function id. It is compiled again
+/// once the generation or revision of the registry changed, see touch().
+struct CodeCache
+{
+    CodeCache() = default;
+
+    [[nodiscard]] auto get(Function const& func) -> std::shared_ptr<Bytecode const>;
+    auto erase(Function const& func) -> void;
+    auto clear() -> void;
+
+    [[nodiscard]] auto size() const -> std::size_t;
+
+private:
+    struct Key
+    {
+        Registry const* registry{nullptr};
+        ValueId func{};
+
+        [[nodiscard]] auto operator<=>(Key const& other) const = default;
+    };
+
+    struct Entry
+    {
+        Generation generation{};
+        Revision revision{};
+        std::shared_ptr<Bytecode const> code;
+    };
+
+    [[nodiscard]] static auto makeKey(Function const& func) -> Key;
+
+    mutable std::shared_mutex _mutex;
+    std::map<Key, Entry> _code;
+};
+
+}  // namespace snir
@@ -0,0 +1,168 @@
+#include "ExecutionService.hpp"
+
+#include "snir/core/Exception.hpp"
+#include "snir/ir/Bytecode.hpp"
+#include "snir/ir/CodeCache.hpp"
+#include "snir/ir/Function.hpp"
+#include "snir/ir/Interpreter.hpp"
+#include "snir/ir/Literal.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace snir {
+
+namespace {
+
+[[nodiscard]] auto call(Interpreter& vm, Bytecode const& code, std::vector<Literal> const& args)
+    -> Literal
+{
+    auto result = vm.execute(code, args);
+    if (not result.has_value()) {
+        raisef<std::invalid_argument>("expected {} arguments", code.arguments.size());
+    }
+    return *result;
+}
+
+// Shared by the jobs of one batch, the last one to finish sets the promise.
+struct Batch
+{
+    std::vector<std::vector<Literal>> rows;
+    std::vector<Literal> results;
+    std::atomic<std::size_t> remaining;
+    std::mutex mutex;
+    std::exception_ptr error;
+    std::promise<std::vector<Literal>> promise;
+};
+
+}  // namespace
+
+ExecutionService::ExecutionService(std::size_t workers)
+{
+    auto const count = std::max(workers, std::size_t{1});
+    _threads.reserve(count);
+    for (auto i = 0zu; i < count; ++i) {
+        _threads.emplace_back([this] { work(); });
+    }
+}
+
+ExecutionService::~ExecutionService()
+{
+    {
+        auto const lock = std::scoped_lock{_mutex};
+        _stopping       = true;
+    }
+    _ready.notify_all();
+    for (auto& thread : _threads) {
+        thread.join();
+    }
+}
+
+auto ExecutionService::submit(Bytecode const& code, std::vector<Literal> args)
+    -> std::future<Literal>
+{
+    auto promise = std::make_shared<std::promise<Literal>>();
+    auto future  = promise->get_future();
+    push([&code, args = std::move(args), promise](Interpreter& vm) {
+        try {
+            promise->set_value(call(vm, code, args));
+        } catch (...) {
+            promise->set_exception(std::current_exception());
+        }
+    });
+    return future;
+}
+
+auto ExecutionService::submit(Function const& func, std::vector<Literal> args)
+    -> std::future<Literal>
+{
+    auto promise = std::make_shared<std::promise<Literal>>();
+    auto future  = promise->get_future();
+    push([this, func, args = std::move(args), promise](Interpreter& vm) {
+        try {
+            promise->set_value(call(vm, *_code.get(func), args));
+        } catch (...) {
+            promise->set_exception(std::current_exception());
+        }
+    });
+    return future;
+}
+
+auto ExecutionService::submitBatch(Bytecode const& code, std::vector<std::vector<Literal>> rows)
+    -> std::future<std::vector<Literal>>
+{
+    auto batch    = std::make_shared<Batch>();
+    auto future   = batch->promise.get_future();
+    auto const n  = rows.size();
+    batch->rows   = std::move(rows);
+    batch->results.resize(n);
+    if (n == 0) {
+        batch->promise.set_value({});
+        return future;
+    }
+
+    auto const jobs  = std::min(workers(), n);
+    auto const chunk = (n + jobs - 1U) / jobs;
+    batch->remaining = (n + chunk - 1U) / chunk;
+    for (auto first = 0zu; first < n; first += chunk) {
+        auto const last = std::min(first + chunk, n);
+        push([&code, batch, first, last](Interpreter& vm) {
+            try {
+                for (auto row = first; row < last; ++row) {
+                    batch->results[row] = call(vm, code, batch->rows[row]);
+                }
+            } catch (...) {
+                auto const lock = std::scoped_lock{batch->mutex};
+                batch->error    = std::current_exception();
+            }
+
+            if (batch->remaining.fetch_sub(1U) != 1U) {
+                return;
+            }
+            if (batch->error) {
+                batch->promise.set_exception(batch->error);
+            } else {
+                batch->promise.set_value(std::move(batch->results));
+            }
+        });
+    }
+    return future;
+}
+
+auto ExecutionService::push(Job job) -> void
+{
+    {
+        auto const lock = std::scoped_lock{_mutex};
+        _jobs.push_back(std::move(job));
+    }
+    _ready.notify_one();
+}
+
+// Pending jobs are still run after the destructor asked to stop.
+auto ExecutionService::work() -> void
+{
+    auto vm = Interpreter{};
+    while (true) {
+        auto job = Job{};
+        {
+            auto lock = std::unique_lock{_mutex};
+            _ready.wait(lock, [this] { return _stopping or not _jobs.empty(); });
+            if (_jobs.empty()) {
+                return;
+            }
+            job = std::move(_jobs.front());
+            _jobs.pop_front();
+        }
+        job(vm);
+    }
+}
+
+}  // namespace snir
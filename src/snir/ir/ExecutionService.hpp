@@ -0,0 +1,72 @@
+#pragma once
+
+#include "snir/ir/Bytecode.hpp"
+#include "snir/ir/CodeCache.hpp"
+#include "snir/ir/Function.hpp"
+#include "snir/ir/Interpreter.hpp"
+#include "snir/ir/Literal.hpp"
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace snir {
+
+/// \brief Fixed pool of worker threads executing calls concurrently. Every
+/// worker owns an Interpreter, so frames are reused and never shared.
+///
+/// The registry, module and bytecode of a submitted call are only read
+/// while it runs. They have to stay alive and must not be modified until
+/// its future is ready, editing the IR while calls are pending is a data
+/// race. Workers never memoize or profile.
+struct ExecutionService
+{
+    explicit ExecutionService(std::size_t workers = std::thread::hardware_concurrency());
+
+    ExecutionService(ExecutionService const& other)                    = delete;
+    ExecutionService(ExecutionService&& other)                         = delete;
+    auto operator=(ExecutionService const& other) -> ExecutionService& = delete;
+    auto operator=(ExecutionService&& other) -> ExecutionService&      = delete;
+
+    /// Finishes every submitted call before joining the workers.
+    ~ExecutionService();
+
+    [[nodiscard]] auto workers() const noexcept -> std::size_t { return _threads.size(); }
+
+    /// \brief Bytecode of the functions submitted so far, shared by all
+    /// workers. Erase a function from it after changing it.
+    [[nodiscard]] auto code() noexcept -> CodeCache& { return _code; }
+
+    [[nodiscard]] auto submit(Bytecode const& code, std::vector<Literal> args)
+        -> std::future<Literal>;
+
+    /// \brief Compiles func on the worker the first time, which only reads
+    /// the registry. Later calls reuse the bytecode from code().
+    [[nodiscard]] auto submit(Function const& func, std::vector<Literal> args)
+        -> std::future<Literal>;
+
+    /// \brief One call of code per row. Rows are split into one job per
+    /// worker, the future holds the results in row order.
+    [[nodiscard]] auto submitBatch(Bytecode const& code, std::vector<std::vector<Literal>> rows)
+        -> std::future<std::vector<Literal>>;
+
+private:
+    using Job = std::function<void(Interpreter&)>;
+
+    auto push(Job job) -> void;
+    auto work() -> void;
+
+    std::mutex _mutex;
+    std::condition_variable _ready;
+    std::deque<Job> _jobs;
+    bool _stopping{false};
+    CodeCache _code;
+    std::vector<std::thread> _threads;
+};
+
+}  // namespace snir
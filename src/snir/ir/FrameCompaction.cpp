@@ -0,0 +1,242 @@
+#include "FrameCompaction.hpp"
+
+#include "snir/ir/Bytecode.hpp"
+#include "snir/ir/OpCode.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <set>
+#include <utility>
+#include <vector>
+
+namespace snir {
+
+namespace {
+
+using Inst = Bytecode::Inst;
+
+/// \brief Set of slots, one bit each.
+struct SlotSet
+{
+    explicit SlotSet(std::size_t size) : _words((size + 63U) / 64U, 0U) {}
+
+    [[nodiscard]] auto contains(std::uint32_t slot) const -> bool
+    {
+        return (_words[slot / 64U] >> (slot % 64U) & 1U) != 0U;
+    }
+
+    auto insert(std::uint32_t slot) -> void { _words[slot / 64U] |= bit(slot); }
+    auto erase(std::uint32_t slot) -> void { _words[slot / 64U] &= ~bit(slot); }
+
+    // Adds all slots of other, returns true if anything was added.
+    auto merge(SlotSet const& other) -> bool
+    {
+        auto changed = false;
+        for (auto i = 0zu; i < _words.size(); ++i) {
+            auto const merged = _words[i] | other._words[i];
+            changed           = changed or merged != _words[i];
+            _words[i]         = merged;
+        }
+        return changed;
+    }
+
+    template<typename Func>
+    auto forEach(Func func) const -> void
+    {
+        for (auto i = 0zu; i < _words.size(); ++i) {
+            for (auto word = _words[i]; word != 0U; word &= word - 1U) {
+                func(static_cast<std::uint32_t>(i * 64U + std::size_t(std::countr_zero(word))));
+            }
+        }
+    }
+
+    [[nodiscard]] auto operator==(SlotSet const& other) const -> bool = default;
+
+private:
+    [[nodiscard]] static auto bit(std::uint32_t slot) -> std::uint64_t
+    {
+        return std::uint64_t{1} << (slot % 64U);
+    }
+
+    std::vector<std::uint64_t> _words;
+};
+
+template<typename Func>
+auto forEachSuccessor(Inst const& inst, std::uint32_t pc, Func func) -> void
+{
+    switch (getOpFormat(inst.op)) {
+        case OpFormat::None:
+        case OpFormat::Return:
+        case OpFormat::ReturnConst:
+        case OpFormat::ReturnBinary: break;
+        case OpFormat::Jump:
+        case OpFormat::JumpCopy: func(inst.dst); break;
+        case OpFormat::Branch:
+            func(inst.dst);
+            func(inst.rhs);
+            break;
+        case OpFormat::CompareBranch:
+            func(inst.dst);
+            func(pc + 1U);
+            break;
+        default: func(pc + 1U); break;
+    }
+}
+
+/// \brief Closed range of pcs in which a slot holds a live value.
+struct Interval
+{
+    std::uint32_t slot{0};
+    std::uint32_t begin{std::numeric_limits<std::uint32_t>::max()};
+    std::uint32_t end{0};
+
+    auto extend(std::uint32_t pc) -> void
+    {
+        begin = std::min(begin, pc);
+        end   = std::max(end, pc);
+    }
+};
+
+struct FrameCompactor
+{
+    explicit FrameCompactor(Bytecode& code)
+        : _code{code}
+        , _liveIn(code.code.size(), SlotSet{code.registers})
+    {}
+
+    auto run() -> std::vector<std::uint32_t>
+    {
+        computeLiveness();
+        auto slots = assignSlots(computeIntervals());
+        rename(slots);
+        return slots;
+    }
+
+private:
+    // Backward transfer of one instruction. The copies of a JumpCopy run in
+    // sequence and are applied one by one.
+    auto transfer(std::uint32_t pc, SlotSet live) const -> SlotSet
+    {
+        auto const& inst = _code.code[pc];
+        if (getOpFormat(inst.op) == OpFormat::JumpCopy) {
+            for (auto i = inst.rhs; i != inst.lhs; --i) {
+                auto const copy = _code.copies[i - 1U];
+                live.erase(copy.dst);
+                live.insert(copy.src);
+            }
+            return live;
+        }
+
+        forEachWrite(inst, [&live](std::uint32_t slot) { live.erase(slot); });
+        forEachRead(inst, [&live](std::uint32_t slot) { live.insert(slot); });
+        return live;
+    }
+
+    [[nodiscard]] auto liveOut(std::uint32_t pc) const -> SlotSet
+    {
+        auto live = SlotSet{_code.registers};
+        forEachSuccessor(_code.code[pc], pc, [&](std::uint32_t next) {
+            if (next < _liveIn.size()) {
+                live.merge(_liveIn[next]);
+            }
+        });
+        return live;
+    }
+
+    auto computeLiveness() -> void
+    {
+        for (auto changed = true; changed;) {
+            changed = false;
+            for (auto pc = static_cast<std::uint32_t>(_code.code.size()); pc-- > 0U;) {
+                auto live = transfer(pc, liveOut(pc));
+                if (live != _liveIn[pc]) {
+                    _liveIn[pc] = std::move(live);
+                    changed     = true;
+                }
+            }
+        }
+    }
+
+    // A slot is live from its first to its last pc in code order. This
+    // covers all holes of the live range, also around loops.
+    [[nodiscard]] auto computeIntervals() const -> std::vector<Interval>
+    {
+        auto intervals = std::vector<Interval>(_code.registers);
+        for (auto slot = 0U; slot < _code.registers; ++slot) {
+            intervals[slot].slot = slot;
+        }
+        for (auto slot = 0U; slot < _code.arguments.size(); ++slot) {
+            intervals[slot].extend(0U);
+        }
+
+        for (auto pc = 0U; pc < _code.code.size(); ++pc) {
+            auto const extend = [&](std::uint32_t slot) { intervals[slot].extend(pc); };
+            auto const& inst  = _code.code[pc];
+            _liveIn[pc].forEach(extend);
+            forEachWrite(inst, extend);
+            if (getOpFormat(inst.op) == OpFormat::JumpCopy) {
+                for (auto i = inst.lhs; i != inst.rhs; ++i) {
+                    extend(_code.copies[i].dst);
+                }
+            }
+        }
+        return intervals;
+    }
+
+    // Linear scan without a register limit: a slot becomes free once the
+    // interval holding it ended. Argument i stays in slot i.
+    [[nodiscard]] auto assignSlots(std::vector<Interval> intervals) -> std::vector<std::uint32_t>
+    {
+        auto const arguments = static_cast<std::uint32_t>(_code.arguments.size());
+        auto slots           = std::vector<std::uint32_t>(_code.registers, unusedSlot);
+
+        std::erase_if(intervals, [](Interval const& i) { return i.begin > i.end; });
+        std::ranges::stable_sort(intervals, std::less{}, &Interval::begin);
+
+        auto next   = arguments;
+        auto free   = std::set<std::uint32_t>{};
+        auto active = std::multiset<std::pair<std::uint32_t, std::uint32_t>>{};
+        for (auto const& interval : intervals) {
+            while (not active.empty() and active.begin()->first < interval.begin) {
+                free.insert(active.begin()->second);
+                active.erase(active.begin());
+            }
+
+            auto slot = interval.slot;
+            if (slot >= arguments) {
+                slot = free.empty() ? next++ : free.extract(free.begin()).value();
+            }
+            slots[interval.slot] = slot;
+            active.emplace(interval.end, slot);
+        }
+
+        _code.registers = next;
+        return slots;
+    }
+
+    auto rename(std::vector<std::uint32_t> const& slots) -> void
+    {
+        auto const map = [&slots](std::uint32_t& slot) { slot = slots[slot]; };
+        for (auto& inst : _code.code) {
+            forEachRead(inst, map);
+            forEachWrite(inst, map);
+        }
+        for (auto& copy : _code.copies) {
+            map(copy.dst);
+            map(copy.src);
+        }
+    }
+
+    Bytecode& _code;
+    std::vector<SlotSet> _liveIn;
+};
+
+}  // namespace
+
+auto compactFrame(Bytecode& code) -> std::vector<std::uint32_t> { return FrameCompactor{code}.run(); }
+
+}  // namespace snir
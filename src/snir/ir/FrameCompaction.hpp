@@ -0,0 +1,21 @@
+#pragma once
+
+#include "snir/ir/Bytecode.hpp"
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace snir {
+
+/// \brief Slot of a register no instruction touches after compaction.
+inline constexpr auto unusedSlot = std::numeric_limits<std::uint32_t>::max();
+
+/// \brief Reuses frame slots of values whose live ranges do not overlap.
+/// Liveness runs over the bytecode CFG, arguments keep their slots and
+/// Bytecode::registers shrinks to the number of slots still needed.
+/// Returns the new slot of every register of the uncompacted frame, or
+/// unusedSlot if the register is never read or written.
+auto compactFrame(Bytecode& code) -> std::vector<std::uint32_t>;
+
+}  // namespace snir
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "snir/core/StringPool.hpp"
 #include "snir/ir/BasicBlock.hpp"
 #include "snir/ir/FunctionDefinition.hpp"
 #include "snir/ir/Identifier.hpp"
@@ -28,14 +29,16 @@ struct Function
 
     auto identifier(std::string_view text) const -> void
     {
-        _value.emplace_or_replace<Identifier>(std::string{text});
+        _value.emplace_or_replace<Identifier>(symbols(*_value.registry()).intern(text));
     }
 
     [[nodiscard]] auto identifier() const -> std::string_view
     {
-        return _value.get<Identifier>().text;
+        return symbols(*_value.registry()).text(symbol());
     }
 
+    [[nodiscard]] auto symbol() const -> Symbol { return _value.get<Identifier>().symbol; }
+
     [[nodiscard]] auto arguments() const -> std::vector<ValueId> const&
     {
         return _value.get<FunctionDefinition>().args;
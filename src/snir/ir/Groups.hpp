@@ -0,0 +1,71 @@
+#pragma once
+
+#include "snir/ir/Branch.hpp"
+#include "snir/ir/InstKind.hpp"
+#include "snir/ir/Literal.hpp"
+#include "snir/ir/Operands.hpp"
+#include "snir/ir/Registry.hpp"
+#include "snir/ir/Result.hpp"
+#include "snir/ir/Type.hpp"
+#include "snir/ir/ValueId.hpp"
+
+#include <utility>
+
+// Groups over the instruction components that are read together. EnTT keeps
+// the storages owned by a group packed and co-indexed for its entities, so
+// reading the whole tuple of one instruction touches the same position in
+// each array instead of going through one sparse set per component.
+//
+// A component can only be owned by a single group, InstKind and Type belong
+// to the hot group and are only observed by the partial ones.
+
+namespace snir {
+
+/// \brief Value producing instructions with operands, i.e. arithmetic,
+/// icmp and trunc.
+[[nodiscard]] inline auto instructionGroup(Registry const& registry) -> decltype(auto)
+{
+    return registry.group_if_exists<InstKind, Type, Operands, Result>();
+}
+
+/// \brief Owns Branch, observes the common instruction components.
+[[nodiscard]] inline auto branchGroup(Registry const& registry) -> decltype(auto)
+{
+    return registry.group_if_exists<Branch>(entt::get<InstKind, Type>);
+}
+
+/// \brief Owns Literal, observes the common instruction components and the
+/// result of the constant.
+[[nodiscard]] inline auto literalGroup(Registry const& registry) -> decltype(auto)
+{
+    return registry.group_if_exists<Literal>(entt::get<InstKind, Type, Result>);
+}
+
+using InstructionGroup = decltype(instructionGroup(std::declval<Registry const&>()));
+using BranchGroup      = decltype(branchGroup(std::declval<Registry const&>()));
+using LiteralGroup     = decltype(literalGroup(std::declval<Registry const&>()));
+
+/// \brief Creates all groups. Has to run before the first instruction is
+/// created, so the storages are packed while the IR is built instead of
+/// being rearranged afterwards. Module does this for every registry it
+/// creates functions in, the lookups above never create a group.
+inline auto declareGroups(Registry& registry) -> void
+{
+    (void)registry.group<InstKind, Type, Operands, Result>();
+    (void)registry.group<Branch>(entt::get<InstKind, Type>);
+    (void)registry.group<Literal>(entt::get<InstKind, Type, Result>);
+}
+
+/// \brief Reads the components of an instruction through the group, or
+/// straight from the registry if the group was never declared.
+template<typename... Components, typename Group>
+[[nodiscard]] auto read(Group const& group, Registry const& registry, ValueId inst)
+    -> decltype(auto)
+{
+    if (group and group.contains(inst)) {
+        return group.template get<Components...>(inst);
+    }
+    return registry.get<Components...>(inst);
+}
+
+}  // namespace snir
@@ -1,9 +1,12 @@
 #include "Identifier.hpp"
 
 #include "snir/core/Exception.hpp"
+#include "snir/core/StringPool.hpp"
+#include "snir/ir/Registry.hpp"
 
 #include <ctre.hpp>
 
+#include <memory>
 #include <stdexcept>
 #include <string_view>
 #include <utility>
@@ -23,4 +26,20 @@ auto parseIdentifier(std::string_view src) -> std::pair<IdentifierKind, std::str
     raisef<std::invalid_argument>("failed to parse '{}' as Identifier", src);
 }
 
+auto symbols(Registry& reg) -> StringPool&
+{
+    // Shared ownership, the pool has to outlive every registry using it.
+    auto* pool = reg.ctx().find<std::shared_ptr<StringPool>>();
+    if (pool == nullptr) {
+        pool = &reg.ctx().emplace<std::shared_ptr<StringPool>>(std::make_shared<StringPool>());
+    }
+    return **pool;
+}
+
+auto shareSymbols(Registry& from, Registry& to) -> void
+{
+    (void)symbols(from);
+    to.ctx().insert_or_assign(from.ctx().get<std::shared_ptr<StringPool>>());
+}
+
 }  // namespace snir
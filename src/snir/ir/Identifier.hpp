@@ -1,15 +1,18 @@
 #pragma once
 
+#include "snir/core/StringPool.hpp"
+#include "snir/ir/Registry.hpp"
+
 #include <cstdint>
-#include <string>
 #include <string_view>
 #include <utility>
 
 namespace snir {
 
+/// \brief Name of a function, the text lives in the symbols of its registry.
 struct Identifier
 {
-    std::string text;
+    Symbol symbol;
 };
 
 enum struct IdentifierKind : std::uint8_t
@@ -21,4 +24,11 @@ enum struct IdentifierKind : std::uint8_t
 [[nodiscard]] auto parseIdentifier(std::string_view src)
     -> std::pair<IdentifierKind, std::string_view>;
 
+/// \brief String pool of the registry, created on first use. All registries
+/// of a module share the pool of the module registry.
+[[nodiscard]] auto symbols(Registry& reg) -> StringPool&;
+
+/// \brief Makes the registry use the string pool of another one.
+auto shareSymbols(Registry& from, Registry& to) -> void;
+
 }  // namespace snir
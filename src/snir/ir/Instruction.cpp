@@ -1,17 +1,35 @@
 #include "Instruction.hpp"
 
+#include "snir/ir/Branch.hpp"
 #include "snir/ir/InstKind.hpp"
+#include "snir/ir/Operands.hpp"
+#include "snir/ir/Phi.hpp"
 #include "snir/ir/Registry.hpp"
 #include "snir/ir/Type.hpp"
+#include "snir/ir/Uses.hpp"
 #include "snir/ir/Value.hpp"
 #include "snir/ir/ValueId.hpp"
 #include "snir/ir/ValueKind.hpp"
 
 #include <algorithm>
 #include <array>
+#include <utility>
 
 namespace snir {
 
+namespace {
+
+template<typename Component>
+auto rewire(Value inst, Component component) -> void
+{
+    auto& reg = *inst.registry();
+    removeUses(reg, inst);
+    inst.emplace_or_replace<Component>(std::move(component));
+    addUses(reg, inst);
+}
+
+}  // namespace
+
 Instruction::Instruction(Value value) noexcept : _value{value} {}
 
 Instruction::Instruction(Registry& registry, ValueId id) noexcept : _value{registry, id} {}
@@ -34,6 +52,12 @@ auto Instruction::isTerminator() const -> bool
     return std::ranges::contains(std::array{InstKind::Return, InstKind::Branch}, kind());
 }
 
+auto Instruction::operands(Operands value) const -> void { rewire(_value, std::move(value)); }
+
+auto Instruction::branch(Branch value) const -> void { rewire(_value, std::move(value)); }
+
+auto Instruction::phi(Phi value) const -> void { rewire(_value, std::move(value)); }
+
 auto Instruction::asValue() const -> Value { return _value; }
 
 Instruction::operator Value() const noexcept { return _value; }
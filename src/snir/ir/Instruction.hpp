@@ -1,6 +1,9 @@
 #pragma once
 
+#include "snir/ir/Branch.hpp"
 #include "snir/ir/InstKind.hpp"
+#include "snir/ir/Operands.hpp"
+#include "snir/ir/Phi.hpp"
 #include "snir/ir/Registry.hpp"
 #include "snir/ir/Type.hpp"
 #include "snir/ir/Value.hpp"
@@ -20,6 +23,12 @@ struct Instruction
 
     [[nodiscard]] auto isTerminator() const -> bool;
 
+    /// \brief Set or replace the registers read by the instruction and keep
+    /// the use lists of the old and new operands up to date.
+    auto operands(Operands value) const -> void;
+    auto branch(Branch value) const -> void;
+    auto phi(Phi value) const -> void;
+
     [[nodiscard]] auto asValue() const -> Value;
     // NOLINTNEXTLINE(hicpp-explicit-conversions)
     [[nodiscard]] explicit(false) operator Value() const noexcept;
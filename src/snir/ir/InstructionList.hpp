@@ -0,0 +1,288 @@
+#pragma once
+
+#include "snir/core/Exception.hpp"
+#include "snir/ir/ValueId.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+namespace snir {
+
+/// \brief Doubly linked list of the instructions in a basic block.
+///
+/// Nodes live in one vector and link to each other by index, so insert,
+/// erase and splice are O(1) and iterators stay valid until their own node
+/// is erased. Erased nodes are recycled last in first out, so undoing edits
+/// in reverse order hands out the same nodes again. A list that is only
+/// appended to iterates in memory order.
+struct InstructionList
+{
+private:
+    static constexpr auto npos = std::numeric_limits<std::uint32_t>::max();
+
+public:
+    template<bool Const>
+    struct Iterator
+    {
+        using List              = std::conditional_t<Const, InstructionList const, InstructionList>;
+        using iterator_concept  = std::bidirectional_iterator_tag;
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type        = ValueId;
+        using difference_type   = std::ptrdiff_t;
+        using pointer           = std::conditional_t<Const, ValueId const*, ValueId*>;
+        using reference         = std::conditional_t<Const, ValueId const&, ValueId&>;
+
+        Iterator() = default;
+
+        Iterator(List* list, std::uint32_t node) noexcept : _list{list}, _node{node} {}
+
+        template<bool OtherConst>
+            requires(Const and not OtherConst)
+        // NOLINTNEXTLINE(hicpp-explicit-conversions)
+        Iterator(Iterator<OtherConst> const& other) noexcept
+            : _list{other._list}
+            , _node{other._node}
+        {}
+
+        [[nodiscard]] auto operator*() const -> reference { return _list->_nodes[_node].value; }
+
+        [[nodiscard]] auto operator->() const -> pointer { return &_list->_nodes[_node].value; }
+
+        auto operator++() -> Iterator&
+        {
+            _node = _list->_nodes[_node].next;
+            return *this;
+        }
+
+        auto operator++(int) -> Iterator
+        {
+            auto tmp = *this;
+            ++*this;
+            return tmp;
+        }
+
+        auto operator--() -> Iterator&
+        {
+            _node = _node == npos ? _list->_tail : _list->_nodes[_node].prev;
+            return *this;
+        }
+
+        auto operator--(int) -> Iterator
+        {
+            auto tmp = *this;
+            --*this;
+            return tmp;
+        }
+
+        [[nodiscard]] friend auto operator==(Iterator const& lhs, Iterator const& rhs) -> bool
+        {
+            return lhs._node == rhs._node;
+        }
+
+    private:
+        friend InstructionList;
+        friend Iterator<not Const>;
+
+        List* _list{nullptr};
+        std::uint32_t _node{npos};
+    };
+
+    using value_type      = ValueId;
+    using size_type       = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using reference       = ValueId&;
+    using const_reference = ValueId const&;
+    using iterator        = Iterator<false>;
+    using const_iterator  = Iterator<true>;
+
+    InstructionList() = default;
+
+    InstructionList(std::initializer_list<ValueId> il)
+    {
+        _nodes.reserve(il.size());
+        for (auto const inst : il) {
+            push_back(inst);
+        }
+    }
+
+    [[nodiscard]] auto empty() const noexcept -> bool { return _size == 0; }
+
+    [[nodiscard]] auto size() const noexcept -> std::size_t { return _size; }
+
+    [[nodiscard]] auto begin() noexcept -> iterator { return iterator{this, _head}; }
+
+    [[nodiscard]] auto begin() const noexcept -> const_iterator
+    {
+        return const_iterator{this, _head};
+    }
+
+    [[nodiscard]] auto end() noexcept -> iterator { return iterator{this, npos}; }
+
+    [[nodiscard]] auto end() const noexcept -> const_iterator { return const_iterator{this, npos}; }
+
+    [[nodiscard]] auto front() const -> ValueId { return _nodes.at(_head).value; }
+
+    [[nodiscard]] auto back() const -> ValueId { return _nodes.at(_tail).value; }
+
+    /// \brief Node of the instruction at pos. Unlike the iterator it stays
+    /// valid when the list is moved, until the instruction is erased.
+    [[nodiscard]] static auto node(const_iterator pos) noexcept -> std::uint32_t
+    {
+        return pos._node;
+    }
+
+    // NOLINTNEXTLINE(readability-identifier-naming)
+    [[nodiscard]] auto iterator_to(std::uint32_t node) noexcept -> iterator
+    {
+        return iterator{this, node};
+    }
+
+    /// \brief Linear in index, meant for tests and diagnostics.
+    [[nodiscard]] auto at(std::size_t index) const -> ValueId
+    {
+        if (index >= size()) {
+            raisef<std::out_of_range>("index {} out of range for {} instructions", index, size());
+        }
+        return *std::next(begin(), static_cast<std::ptrdiff_t>(index));
+    }
+
+    auto push_back(ValueId inst) -> void  // NOLINT(readability-identifier-naming)
+    {
+        link(allocate(inst), npos);
+    }
+
+    auto push_front(ValueId inst) -> void  // NOLINT(readability-identifier-naming)
+    {
+        link(allocate(inst), _head);
+    }
+
+    /// \brief Inserts before pos.
+    auto insert(const_iterator pos, ValueId inst) -> iterator
+    {
+        auto const node = allocate(inst);
+        link(node, pos._node);
+        return iterator{this, node};
+    }
+
+    /// \brief Returns the iterator following the erased instruction.
+    auto erase(const_iterator pos) -> iterator
+    {
+        auto const next = _nodes[pos._node].next;
+        unlink(pos._node);
+        release(pos._node);
+        return iterator{this, next};
+    }
+
+    auto erase(const_iterator first, const_iterator last) -> iterator
+    {
+        while (first != last) {
+            first = erase(first);
+        }
+        return iterator{this, last._node};
+    }
+
+    /// \brief Moves the instruction at it from other to before pos. Within
+    /// one list the node is relinked and iterators to it stay valid.
+    auto splice(const_iterator pos, InstructionList& other, const_iterator it) -> void
+    {
+        if (&other == this) {
+            if (pos._node != it._node) {
+                unlink(it._node);
+                link(it._node, pos._node);
+            }
+            return;
+        }
+
+        (void)insert(pos, *it);
+        (void)other.erase(it);
+    }
+
+    auto clear() -> void
+    {
+        _nodes.clear();
+        _head = npos;
+        _tail = npos;
+        _free = npos;
+        _size = 0;
+    }
+
+    [[nodiscard]] friend auto operator==(InstructionList const& lhs, InstructionList const& rhs)
+        -> bool
+    {
+        return std::ranges::equal(lhs, rhs);
+    }
+
+private:
+    struct Node
+    {
+        ValueId value;
+        std::uint32_t prev{npos};
+        std::uint32_t next{npos};
+    };
+
+    [[nodiscard]] auto allocate(ValueId inst) -> std::uint32_t
+    {
+        if (_free == npos) {
+            _nodes.push_back(Node{.value = inst, .prev = npos, .next = npos});
+            return static_cast<std::uint32_t>(_nodes.size() - 1);
+        }
+
+        auto const node = _free;
+        _free           = _nodes[node].next;
+        _nodes[node]    = Node{.value = inst, .prev = npos, .next = npos};
+        return node;
+    }
+
+    auto release(std::uint32_t node) -> void
+    {
+        _nodes[node].next = _free;
+        _free             = node;
+    }
+
+    // Links the node in before next, npos appends.
+    auto link(std::uint32_t node, std::uint32_t next) -> void
+    {
+        auto const prev    = next == npos ? _tail : _nodes[next].prev;
+        _nodes[node].prev  = prev;
+        _nodes[node].next  = next;
+        (prev == npos ? _head : _nodes[prev].next) = node;
+        (next == npos ? _tail : _nodes[next].prev) = node;
+        ++_size;
+    }
+
+    auto unlink(std::uint32_t node) -> void
+    {
+        auto const prev = _nodes[node].prev;
+        auto const next = _nodes[node].next;
+        (prev == npos ? _head : _nodes[prev].next) = next;
+        (next == npos ? _tail : _nodes[next].prev) = prev;
+        --_size;
+    }
+
+    std::vector<Node> _nodes;
+    std::uint32_t _head{npos};
+    std::uint32_t _tail{npos};
+    std::uint32_t _free{npos};
+    std::size_t _size{0};
+};
+
+/// \brief Erases all instructions satisfying pred, returns the number erased.
+// NOLINTNEXTLINE(readability-identifier-naming)
+template<typename Pred>
+auto erase_if(InstructionList& list, Pred pred) -> std::size_t
+{
+    auto const size = list.size();
+    for (auto it = list.begin(); it != list.end();) {
+        it = pred(*it) ? list.erase(it) : std::next(it);
+    }
+    return size - list.size();
+}
+
+}  // namespace snir
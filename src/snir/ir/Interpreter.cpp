@@ -1,193 +1,302 @@
 #include "Interpreter.hpp"
 
 #include "snir/core/Exception.hpp"
-#include "snir/ir/BasicBlock.hpp"
-#include "snir/ir/Branch.hpp"
-#include "snir/ir/CompareKind.hpp"
+#include "snir/ir/Bytecode.hpp"
+#include "snir/ir/CodeCache.hpp"
 #include "snir/ir/Function.hpp"
-#include "snir/ir/InstKind.hpp"
 #include "snir/ir/Literal.hpp"
-#include "snir/ir/Operands.hpp"
-#include "snir/ir/Result.hpp"
-#include "snir/ir/Type.hpp"
+#include "snir/ir/OpCode.hpp"
+#include "snir/ir/Profile.hpp"
+#include "snir/ir/ResultCache.hpp"
 #include "snir/ir/ValueId.hpp"
 
-#include <algorithm>
-#include <cmath>
+#include <cstddef>
 #include <cstdint>
-#include <functional>
-#include <iterator>
+#include <memory>
 #include <optional>
-#include <ranges>
 #include <span>
 #include <stdexcept>
-#include <variant>
+#include <vector>
+
+#if defined(__GNUC__) or defined(__clang__)
+    #define SNIR_HAS_COMPUTED_GOTO 1
+#else
+    #define SNIR_HAS_COMPUTED_GOTO 0
+#endif
 
 namespace snir {
 
-auto Interpreter::execute(Function const& func, std::span<ValueId const> args)
-    -> std::optional<Literal>
-{
-    _registers.clear();
+namespace {
 
-    if (func.arguments().size() != args.size()) {
-        return std::nullopt;
-    }
+[[nodiscard]] constexpr auto isTransfer(OpCode op) -> bool
+{
+    auto const format = getOpFormat(op);
+    return format == OpFormat::Jump or format == OpFormat::JumpCopy or format == OpFormat::Branch
+        or format == OpFormat::CompareBranch;
+}
 
-    auto const* registry = func.asValue().registry();
+[[nodiscard]] constexpr auto isExit(OpCode op) -> bool
+{
+    auto const format = getOpFormat(op);
+    return format == OpFormat::Return or format == OpFormat::ReturnConst
+        or format == OpFormat::ReturnBinary or op == OpCode::ReturnVoid;
+}
 
-    auto currentBlock = func.basicBlocks().at(0).label;
+template<OpCode Op>
+[[nodiscard]] auto exit(Bytecode const& code, std::span<Slot const> frame, Bytecode::Inst inst)
+    -> Slot
+{
+    if constexpr (getOpFormat(Op) == OpFormat::Return) {
+        return frame[inst.lhs];
+    } else if constexpr (getOpFormat(Op) == OpFormat::ReturnConst) {
+        return code.constants[inst.lhs];
+    } else if constexpr (getOpFormat(Op) == OpFormat::ReturnBinary) {
+        return evaluate<getBaseOpCode(Op)>(frame[inst.lhs], frame[inst.rhs]);
+    } else {
+        return Slot{0};
+    }
+}
 
-    auto instructions = registry->view<InstKind, Type>();
-    auto operands     = registry->view<Operands>();
-    auto result       = registry->view<Result>();
-    auto literal      = registry->view<Literal>();
-    auto compare      = registry->view<CompareKind>();
-    auto branch       = registry->view<Branch>();
+// Executes a single non-returning instruction and yields the next pc.
+template<OpCode Op>
+[[nodiscard]] auto
+step(Bytecode const& code, std::span<Slot> frame, Bytecode::Inst inst, std::uint32_t pc)
+    -> std::uint32_t
+{
+    constexpr auto format = getOpFormat(Op);
+    constexpr auto base   = getBaseOpCode(Op);
 
-    auto shiftLeft = []<typename T>(T lhs, T rhs) {
-        return static_cast<T>(std::uint64_t(lhs) << std::uint64_t(rhs));
-    };
-    auto shiftRight = []<typename T>(T lhs, T rhs) {
-        return static_cast<T>(std::uint64_t(lhs) >> std::uint64_t(rhs));
-    };
+    if constexpr (Op == OpCode::Unreachable) {
+        raisef<std::runtime_error>("reached end of function without return");
+    } else if constexpr (format == OpFormat::Const) {
+        frame[inst.dst] = code.constants[inst.lhs];
+    } else if constexpr (format == OpFormat::ConstPair) {
+        frame[inst.dst] = code.constants[inst.lhs];
+        frame[inst.rhs] = code.constants[inst.lhs + 1U];
+    } else if constexpr (format == OpFormat::Unary) {
+        frame[inst.dst] = evaluate<base>(frame[inst.lhs]);
+    } else if constexpr (format == OpFormat::Binary) {
+        frame[inst.dst] = evaluate<base>(frame[inst.lhs], frame[inst.rhs]);
+    } else if constexpr (format == OpFormat::BinaryConst) {
+        frame[inst.dst] = evaluate<base>(frame[inst.lhs], code.constants[inst.rhs]);
+    } else if constexpr (format == OpFormat::Jump) {
+        return inst.dst;
+    } else if constexpr (format == OpFormat::JumpCopy) {
+        for (auto i = inst.lhs; i != inst.rhs; ++i) {
+            auto const copy = code.copies[i];
+            frame[copy.dst] = frame[copy.src];
+        }
+        return inst.dst;
+    } else if constexpr (format == OpFormat::Branch) {
+        return frame[inst.lhs] != 0 ? inst.dst : inst.rhs;
+    } else if constexpr (format == OpFormat::CompareBranch) {
+        return evaluate<base>(frame[inst.lhs], frame[inst.rhs]) != 0 ? inst.dst : pc + 1U;
+    } else {
+        static_assert(isExit(Op));
+    }
 
-    auto executeConst = [&](ValueId inst) {
-        auto const [res] = result.get(inst);
-        auto const [val] = literal.get(inst);
-        _registers.emplace(res.id, val);
-    };
+    return pc + 1U;
+}
 
-    auto executeTrunc = [&](ValueId inst, Type type) {
-        auto const [res] = result.get(inst);
-        auto const [ops] = operands.get(inst);
-        auto const in    = _registers.at(ops.list[0]);
-        if (type == Type::Int64) {
-            auto toInt64 = [](auto v) { return static_cast<std::int64_t>(v); };
-            _registers.emplace(res.id, std::visit(toInt64, in.value));
-            return;
+[[nodiscard]] auto runSwitch(Bytecode const& code, std::span<Slot> frame) -> Slot
+{
+    auto pc = std::uint32_t{0};
+    while (true) {
+        auto const inst = code.code[pc];
+        switch (inst.op) {
+#define SNIR_OP_CODE(Id, Name, Format)                                                               \
+    case OpCode::Id: {                                                                               \
+        if constexpr (isExit(OpCode::Id)) {                                                          \
+            return exit<OpCode::Id>(code, frame, inst);                                              \
+        } else {                                                                                     \
+            pc = step<OpCode::Id>(code, frame, inst, pc);                                            \
+        }                                                                                            \
+        break;                                                                                       \
+    }
+#include "snir/ir/OpCode.def"
         }
-        if (type == Type::Float) {
-            auto toFloat = [](auto v) { return static_cast<float>(v); };
-            _registers.emplace(res.id, std::visit(toFloat, in.value));
-            return;
+    }
+}
+
+// Switch dispatch counting every instruction, and every edge when control
+// enters the first instruction of a block.
+[[nodiscard]] auto runProfiled(Bytecode const& code, std::span<Slot> frame, FunctionProfile& counts)
+    -> Slot
+{
+    auto pc    = std::uint32_t{0};
+    auto block = counts.blockAt.empty() ? 0 : counts.blockAt[0];
+    while (true) {
+        auto const inst = code.code[pc];
+        ++counts.instructions[pc];
+        switch (inst.op) {
+#define SNIR_OP_CODE(Id, Name, Format)                                                               \
+    case OpCode::Id: {                                                                               \
+        if constexpr (isExit(OpCode::Id)) {                                                          \
+            return exit<OpCode::Id>(code, frame, inst);                                              \
+        } else {                                                                                     \
+            pc = step<OpCode::Id>(code, frame, inst, pc);                                            \
+        }                                                                                            \
+        break;                                                                                       \
+    }
+#include "snir/ir/OpCode.def"
         }
-        if (type == Type::Double) {
-            auto toDouble = [](auto v) { return static_cast<double>(v); };
-            _registers.emplace(res.id, std::visit(toDouble, in.value));
-            return;
+
+        if (auto const next = counts.blockAt[pc]; next != -1) {
+            ++counts.edges[{static_cast<std::uint32_t>(block), static_cast<std::uint32_t>(next)}];
+            block = next;
         }
+    }
+}
+
+#if SNIR_HAS_COMPUTED_GOTO
+    #pragma GCC diagnostic push
+    #pragma GCC diagnostic ignored "-Wpedantic"
 
-        raisef<std::runtime_error>("unsupported type {} for trunc op", type);
+// Threaded dispatch: every handler ends in its own indirect jump to the next
+// handler, which gives the branch predictor one history entry per opcode.
+[[nodiscard]] auto runThreaded(Bytecode const& code, std::span<Slot> frame) -> Slot
+{
+    static void* const labels[] = {  // NOLINT(*-avoid-c-arrays)
+    #define SNIR_OP_CODE(Id, Name, Format) &&Label##Id,
+    #include "snir/ir/OpCode.def"
     };
 
-    auto executeBinaryOp = [&](ValueId inst, Type type, auto op) {
-        auto const [res] = result.get(inst);
-        auto const [ops] = operands.get(inst);
-        auto const lhs   = _registers.at(ops.list[0]).value;
-        auto const rhs   = _registers.at(ops.list[1]).value;
-        if (type == Type::Int64) {
-            auto val = op(std::get<std::int64_t>(lhs), std::get<std::int64_t>(rhs));
-            _registers.emplace(res.id, val);
-            return;
+    auto const* const insts = code.code.data();
+    auto pc                 = std::uint32_t{0};
+    auto inst               = insts[pc];
+    goto *labels[static_cast<std::size_t>(inst.op)];
+
+    #define SNIR_OP_CODE(Id, Name, Format)                                                           \
+        Label##Id:                                                                                   \
+        if constexpr (isExit(OpCode::Id)) {                                                          \
+            return exit<OpCode::Id>(code, frame, inst);                                              \
+        } else {                                                                                     \
+            pc   = step<OpCode::Id>(code, frame, inst, pc);                                          \
+            inst = insts[pc];                                                                        \
+            goto *labels[static_cast<std::size_t>(inst.op)];                                         \
         }
+    #include "snir/ir/OpCode.def"
+}
 
-        raisef<std::runtime_error>("unsupported type {} for integer op", type);
-    };
+    #pragma GCC diagnostic pop
+#else
+[[nodiscard]] auto runThreaded(Bytecode const& code, std::span<Slot> frame) -> Slot
+{
+    return runSwitch(code, frame);
+}
+#endif
 
-    auto executeBinaryFloatOp = [&](ValueId inst, Type type, auto op) {
-        auto const [res] = result.get(inst);
-        auto const [ops] = operands.get(inst);
-        auto const lhs   = _registers.at(ops.list[0]).value;
-        auto const rhs   = _registers.at(ops.list[1]).value;
-        if (type == Type::Float) {
-            auto val = op(std::get<float>(lhs), std::get<float>(rhs));
-            _registers.emplace(res.id, val);
-            return;
-        }
-        if (type == Type::Double) {
-            auto val = op(std::get<double>(lhs), std::get<double>(rhs));
-            _registers.emplace(res.id, val);
-            return;
-        }
+}  // namespace
 
-        raisef<std::runtime_error>("unsupported type {} for float op", type);
-    };
+Interpreter::Interpreter(Dispatch dispatch) : _dispatch{dispatch} {}
+
+auto Interpreter::execute(Function const& func, std::span<ValueId const> args)
+    -> std::optional<Literal>
+{
+    if (func.arguments().size() != args.size()) {
+        return std::nullopt;
+    }
+
+    // Reuses the argument buffer of the previous call.
+    auto const* registry = func.asValue().registry();
+    auto& literals       = _args;
+    literals.clear();
+    for (auto const arg : args) {
+        literals.push_back(registry->get<Literal>(arg));
+    }
 
-    auto executeIntCmp = [&](ValueId inst) {
-        auto const [res] = result.get(inst);
-        auto const [ops] = operands.get(inst);
-        auto const [cmp] = compare.get(inst);
-        auto const lhs   = _registers.at(ops.list[0]).value;
-        auto const rhs   = _registers.at(ops.list[1]).value;
-        if (cmp == CompareKind::Equal) {
-            _registers.emplace(res.id, (lhs == rhs));
-            return;
+    if (_cache != nullptr) {
+        if (auto hit = _cache->find(func, literals); hit.has_value()) {
+            return hit;
         }
-        if (cmp == CompareKind::NotEqual) {
-            _registers.emplace(res.id, (lhs != rhs));
-            return;
+    }
+
+    auto const compiled = _code->get(func);
+    auto const& code    = *compiled;
+    auto* counts     = static_cast<FunctionProfile*>(nullptr);
+    if constexpr (profiling) {
+        if (_profile != nullptr) {
+            counts = &_profile->function(func, code);
         }
+    }
 
-        raisef<std::runtime_error>("unsupported kind {} for integer compare", cmp);
-    };
+    auto result = counts != nullptr ? execute(code, literals, *counts) : execute(code, literals);
+    if (_cache != nullptr and result.has_value()) {
+        _cache->insert(func, literals, *result);
+    }
+    return result;
+}
 
-    auto executeReturn = [&](ValueId inst, Type type) {
-        if (type == Type::Void) {
-            return Literal{std::nan("")};
-        }
+auto Interpreter::execute(Bytecode const& code, std::span<Literal const> args)
+    -> std::optional<Literal>
+{
+    if (not load(code, args)) {
+        return std::nullopt;
+    }
 
-        return _registers.at(std::get<0>(operands.get(inst)).list[0]);
-    };
+    return toLiteral(run(code), code.type);
+}
 
-    auto executeBranch = [&](ValueId inst) {
-        auto [dest]  = branch.get(inst);
-        currentBlock = dest.iftrue;
-    };
+auto Interpreter::execute(
+    Bytecode const& code,
+    std::span<Literal const> args,
+    FunctionProfile& counts
+) -> std::optional<Literal>
+{
+    if (not load(code, args)) {
+        return std::nullopt;
+    }
+    if (counts.instructions.size() != code.code.size()) {
+        raisef<std::invalid_argument>("profile of '{}' is for other code", counts.identifier);
+    }
+    return toLiteral(runProfiled(code, _frame, counts), code.type);
+}
 
-    while (true) {
-        auto const& blocks = func.basicBlocks();
-        auto const block   = std::ranges::find(blocks, currentBlock, &BasicBlock::label);
-        if (block == std::ranges::end(blocks)) {
-            raisef<std::runtime_error>("unknown block");
-        }
+auto Interpreter::run(Bytecode const& code) -> Slot
+{
+    return _dispatch == Dispatch::Threaded ? runThreaded(code, _frame) : runSwitch(code, _frame);
+}
 
-        for (auto const inst : block->instructions) {
-            auto const [kind, type] = instructions.get(inst);
-            switch (kind) {
-                case InstKind::Nop: break;
-                case InstKind::Const: executeConst(inst); break;
-                case InstKind::Trunc: executeTrunc(inst, type); break;
-                case InstKind::Add: executeBinaryOp(inst, type, std::plus{}); break;
-                case InstKind::Sub: executeBinaryOp(inst, type, std::minus{}); break;
-                case InstKind::Mul: executeBinaryOp(inst, type, std::multiplies{}); break;
-                case InstKind::Div: executeBinaryOp(inst, type, std::divides{}); break;
-                case InstKind::Mod: executeBinaryOp(inst, type, std::modulus{}); break;
-                case InstKind::And: executeBinaryOp(inst, type, std::bit_and{}); break;
-                case InstKind::Or: executeBinaryOp(inst, type, std::bit_or{}); break;
-                case InstKind::Xor: executeBinaryOp(inst, type, std::bit_xor{}); break;
-                case InstKind::ShiftLeft: executeBinaryOp(inst, type, shiftLeft); break;
-                case InstKind::ShiftRight: executeBinaryOp(inst, type, shiftRight); break;
-                case InstKind::FloatAdd: executeBinaryFloatOp(inst, type, std::plus{}); break;
-                case InstKind::FloatSub: executeBinaryFloatOp(inst, type, std::minus{}); break;
-                case InstKind::FloatMul: executeBinaryFloatOp(inst, type, std::multiplies{}); break;
-                case InstKind::FloatDiv: executeBinaryFloatOp(inst, type, std::divides{}); break;
-                case InstKind::IntCmp: executeIntCmp(inst); break;
-                case InstKind::Return: return executeReturn(inst, type);
-                case InstKind::Branch: executeBranch(inst); break;
-                case InstKind::Phi:
-                default: raisef<std::runtime_error>("unimplemented: {}<{}>", kind, type);
-            }
+auto Interpreter::resume(
+    Bytecode const& code,
+    std::span<Slot> frame,
+    std::uint32_t& pc,
+    Slice slice
+) -> std::optional<Slot>
+{
+    for (auto i = std::uint32_t{0}; i < slice.instructions; ++i) {
+        auto const inst = code.code[pc];
+        switch (inst.op) {
+#define SNIR_OP_CODE(Id, Name, Format)                                                               \
+    case OpCode::Id: {                                                                               \
+        if constexpr (isExit(OpCode::Id)) {                                                          \
+            return exit<OpCode::Id>(code, frame, inst);                                              \
+        } else {                                                                                     \
+            pc = step<OpCode::Id>(code, frame, inst, pc);                                            \
+        }                                                                                            \
+        break;                                                                                       \
+    }
+#include "snir/ir/OpCode.def"
         }
 
-        if (auto const next = std::ranges::next(block); next != std::ranges::end(blocks)) {
-            currentBlock = next->label;
-        } else {
-            raisef<std::runtime_error>("reached on of function without return");
+        if (slice.blocks and isTransfer(inst.op)) {
+            break;
         }
     }
-
     return std::nullopt;
 }
 
+auto Interpreter::load(Bytecode const& code, std::span<Literal const> args) -> bool
+{
+    if (code.arguments.size() != args.size()) {
+        return false;
+    }
+
+    _frame.assign(code.registers, Slot{0});
+    for (auto i = 0zu; i < args.size(); ++i) {
+        _frame[i] = toSlot(args[i], code.arguments[i]);
+    }
+    return true;
+}
+
 }  // namespace snir
@@ -1,24 +1,183 @@
 #pragma once
 
+#include "snir/core/Exception.hpp"
+#include "snir/ir/Bytecode.hpp"
+#include "snir/ir/CodeCache.hpp"
 #include "snir/ir/Function.hpp"
 #include "snir/ir/Literal.hpp"
+#include "snir/ir/Profile.hpp"
+#include "snir/ir/ResultCache.hpp"
+#include "snir/ir/Type.hpp"
 #include "snir/ir/ValueId.hpp"
 
-#include <map>
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
 #include <optional>
 #include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
 
 namespace snir {
 
 struct Interpreter
 {
-    Interpreter() = default;
+    enum struct Dispatch : std::uint8_t
+    {
+        Switch,
+        Threaded,
+    };
+
+#if defined(SNIR_THREADED_DISPATCH)
+    static constexpr auto defaultDispatch = Dispatch::Threaded;
+#else
+    static constexpr auto defaultDispatch = Dispatch::Switch;
+#endif
+
+#if defined(SNIR_PROFILE)
+    static constexpr auto profiling = true;
+#else
+    static constexpr auto profiling = false;
+#endif
+
+    explicit Interpreter(Dispatch dispatch = defaultDispatch);
+
+    /// \brief Functions executed while a profile is set count into it. Does
+    /// nothing unless built with SNIR_PROFILE, the hot loop is never changed.
+    auto profile(Profile* profile) -> void { _profile = profile; }
+
+    /// \brief Results of functions executed while a cache is set are looked
+    /// up in and added to it.
+    auto memoize(ResultCache* cache) -> void { _cache = cache; }
+
+    /// \brief Functions are compiled on their first call and the bytecode is
+    /// reused until their registry is touched. Each interpreter has its own
+    /// cache, set one to share it, nullptr goes back to the own one.
+    auto cacheCode(CodeCache* cache) -> void { _code = cache != nullptr ? cache : _ownCode.get(); }
 
     [[nodiscard]] auto execute(Function const& func, std::span<ValueId const> args)
         -> std::optional<Literal>;
 
+    [[nodiscard]] auto execute(Bytecode const& code, std::span<Literal const> args)
+        -> std::optional<Literal>;
+
+    /// \brief Typed call, e.g. execute<double>(code, 3, 4.0). The signature
+    /// is checked, arguments go straight into their slots and the result is
+    /// returned unboxed. Integer arguments are passed as i64.
+    template<typename R, typename... Args>
+    [[nodiscard]] auto execute(Bytecode const& code, Args... args) -> R;
+
+    /// Runs with a switch dispatch loop that counts into counts.
+    [[nodiscard]] auto
+    execute(Bytecode const& code, std::span<Literal const> args, FunctionProfile& counts)
+        -> std::optional<Literal>;
+
+    /// Bounds one call of resume().
+    struct Slice
+    {
+        std::uint32_t instructions{1024};
+        bool blocks{false};
+    };
+
+    /// \brief Runs at most slice.instructions from pc, stopping early after a
+    /// jump or branch if slice.blocks is set. Returns the result once the
+    /// function returned, otherwise pc is where to continue.
+    [[nodiscard]] static auto
+    resume(Bytecode const& code, std::span<Slot> frame, std::uint32_t& pc, Slice slice)
+        -> std::optional<Slot>;
+
+    /// Rows executed together by executeBatch, one bit per lane in a mask.
+    static constexpr auto batchLanes = std::size_t{64};
+
+    /// \brief Runs code once per row of the argument columns and writes one
+    /// value per row to result. Rows run batchLanes at a time, every
+    /// instruction handles all lanes. Lanes diverging at a branch continue
+    /// under a mask.
+    ///
+    /// There are no hand written SIMD kernels. The lane loops are plain
+    /// element-wise code in InterpreterBatch.cpp, which the build compiles
+    /// with the full auto-vectorizer (-O3, dynamic cost model on GCC).
+    template<typename R, typename... Args>
+    auto executeBatch(Bytecode const& code, std::span<R> result, std::span<Args const>... args)
+        -> void;
+
 private:
-    std::map<ValueId, Literal> _registers;
+    [[nodiscard]] auto load(Bytecode const& code, std::span<Literal const> args) -> bool;
+    [[nodiscard]] auto run(Bytecode const& code) -> Slot;
+
+    template<typename T>
+    auto loadColumn(std::size_t index, std::span<T const> column) -> void;
+
+    auto runBatch(Bytecode const& code, std::size_t rows) -> void;
+
+    std::vector<Slot> _frame;
+    std::vector<Slot> _lanes;
+    std::vector<Slot> _laneResults;
+    Profile* _profile{nullptr};
+    ResultCache* _cache{nullptr};
+    std::unique_ptr<CodeCache> _ownCode{std::make_unique<CodeCache>()};
+    CodeCache* _code{_ownCode.get()};
+    std::vector<Literal> _args;
+    Dispatch _dispatch;
 };
 
+template<typename R, typename... Args>
+auto Interpreter::execute(Bytecode const& code, Args... args) -> R
+{
+    using Signature = R(detail::ArgumentType<Args>...);
+    if (not detail::SignatureTraits<Signature>::matches(code.type, code.arguments)) {
+        raisef<std::invalid_argument>("arguments do not match the function signature");
+    }
+
+    _frame.assign(code.registers, Slot{0});
+    [[maybe_unused]] auto index = 0zu;
+    ((_frame[index++] = toSlot(static_cast<detail::ArgumentType<Args>>(args))), ...);
+
+    auto const result = run(code);
+    if constexpr (not std::is_void_v<R>) {
+        return fromSlot<R>(result);
+    }
+}
+
+template<typename R, typename... Args>
+auto Interpreter::executeBatch(
+    Bytecode const& code,
+    std::span<R> result,
+    std::span<Args const>... args
+) -> void
+{
+    auto const types = std::array<Type, sizeof...(Args)>{typeOf<Args>()...};
+    if (code.type != typeOf<R>() or not std::ranges::equal(types, code.arguments)) {
+        raisef<std::invalid_argument>("batch columns do not match the function signature");
+    }
+    if (((args.size() != result.size()) or ...)) {
+        raisef<std::invalid_argument>("batch columns must have the same number of rows");
+    }
+
+    _lanes.resize(std::size_t{code.registers} * batchLanes);
+    _laneResults.resize(batchLanes);
+    for (auto row = 0zu; row < result.size(); row += batchLanes) {
+        auto const rows = std::min(batchLanes, result.size() - row);
+        [[maybe_unused]] auto index = 0zu;
+        (loadColumn(index++, args.subspan(row, rows)), ...);
+
+        runBatch(code, rows);
+        for (auto lane = 0zu; lane < rows; ++lane) {
+            result[row + lane] = fromSlot<R>(_laneResults[lane]);
+        }
+    }
+}
+
+template<typename T>
+auto Interpreter::loadColumn(std::size_t index, std::span<T const> column) -> void
+{
+    auto* lanes = _lanes.data() + index * batchLanes;
+    for (auto lane = 0zu; lane < column.size(); ++lane) {
+        lanes[lane] = toSlot(column[lane]);
+    }
+}
+
 }  // namespace snir
@@ -0,0 +1,220 @@
+#include "Interpreter.hpp"
+
+#include "snir/core/Exception.hpp"
+#include "snir/ir/Bytecode.hpp"
+#include "snir/ir/OpCode.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+// The batch engine of the interpreter. Every instruction runs as one loop
+// over the lanes, this file is built with the full auto-vectorizer so those
+// loops become SIMD code, see src/CMakeLists.txt.
+
+namespace snir {
+
+namespace {
+
+using LaneMask = std::uint64_t;
+static_assert(Interpreter::batchLanes == sizeof(LaneMask) * 8U);
+
+constexpr auto allLanes = ~LaneMask{0};
+
+// Stops the current lane group, either at a return or to reschedule.
+constexpr auto yieldGroup = std::numeric_limits<std::uint32_t>::max();
+
+struct LaneGroup
+{
+    std::uint32_t pc;
+    LaneMask mask;
+};
+
+// Without divergence every lane is active and the loop bodies are plain
+// element-wise kernels for the auto-vectorizer.
+template<typename Func>
+auto forLanes(LaneMask mask, Slot* dst, Func func) -> void
+{
+    if (mask == allLanes) {
+        for (auto lane = 0zu; lane < Interpreter::batchLanes; ++lane) {
+            dst[lane] = func(lane);
+        }
+        return;
+    }
+
+    for (auto lane = 0zu; lane < Interpreter::batchLanes; ++lane) {
+        if (((mask >> lane) & 1U) != 0U) {
+            dst[lane] = func(lane);
+        }
+    }
+}
+
+template<typename Func>
+[[nodiscard]] auto laneMask(LaneMask mask, Func predicate) -> LaneMask
+{
+    auto result = LaneMask{0};
+    for (auto lane = 0zu; lane < Interpreter::batchLanes; ++lane) {
+        result |= LaneMask{predicate(lane)} << lane;
+    }
+    return result & mask;
+}
+
+struct BatchState
+{
+    [[nodiscard]] auto lanes(std::uint32_t slot) const -> Slot*
+    {
+        return frame.data() + std::size_t{slot} * Interpreter::batchLanes;
+    }
+
+    auto schedule(std::uint32_t pc, LaneMask mask) -> void
+    {
+        auto found = std::ranges::find(pending, pc, &LaneGroup::pc);
+        if (found != pending.end()) {
+            found->mask |= mask;
+        } else {
+            pending.push_back(LaneGroup{.pc = pc, .mask = mask});
+        }
+    }
+
+    // Keeps running the current group until another one waits, so lanes
+    // can reconverge at the lowest pending pc.
+    [[nodiscard]] auto jump(std::uint32_t target, LaneMask mask) -> std::uint32_t
+    {
+        if (pending.empty()) {
+            return target;
+        }
+        schedule(target, mask);
+        return yieldGroup;
+    }
+
+    [[nodiscard]] auto
+    branch(LaneMask mask, LaneMask taken, std::uint32_t iftrue, std::uint32_t iffalse)
+        -> std::uint32_t
+    {
+        if (taken == mask) {
+            return jump(iftrue, mask);
+        }
+        if (taken == 0U) {
+            return jump(iffalse, mask);
+        }
+        schedule(iftrue, taken);
+        schedule(iffalse, mask & ~taken);
+        return yieldGroup;
+    }
+
+    Bytecode const& code;
+    std::span<Slot> frame;
+    std::span<Slot> result;
+    std::vector<LaneGroup> pending;
+};
+
+// Executes a single instruction for all lanes in mask and yields the next pc.
+// NOLINTNEXTLINE(readability-function-cognitive-complexity)
+template<OpCode Op>
+[[nodiscard]] auto
+batchStep(BatchState& state, Bytecode::Inst inst, std::uint32_t pc, LaneMask mask)
+    -> std::uint32_t
+{
+    constexpr auto format = getOpFormat(Op);
+    constexpr auto base   = getBaseOpCode(Op);
+
+    auto const& code = state.code;
+    auto const lanes = [&state](std::uint32_t slot) { return state.lanes(slot); };
+
+    if constexpr (Op == OpCode::Unreachable) {
+        raisef<std::runtime_error>("reached end of function without return");
+    } else if constexpr (format == OpFormat::Const) {
+        auto const value = code.constants[inst.lhs];
+        forLanes(mask, lanes(inst.dst), [=](auto) { return value; });
+    } else if constexpr (format == OpFormat::ConstPair) {
+        auto const first  = code.constants[inst.lhs];
+        auto const second = code.constants[inst.lhs + 1U];
+        forLanes(mask, lanes(inst.dst), [=](auto) { return first; });
+        forLanes(mask, lanes(inst.rhs), [=](auto) { return second; });
+    } else if constexpr (format == OpFormat::Unary) {
+        auto const* lhs = lanes(inst.lhs);
+        forLanes(mask, lanes(inst.dst), [=](auto i) { return evaluate<base>(lhs[i]); });
+    } else if constexpr (format == OpFormat::Binary) {
+        auto const* lhs = lanes(inst.lhs);
+        auto const* rhs = lanes(inst.rhs);
+        forLanes(mask, lanes(inst.dst), [=](auto i) { return evaluate<base>(lhs[i], rhs[i]); });
+    } else if constexpr (format == OpFormat::BinaryConst) {
+        auto const* lhs  = lanes(inst.lhs);
+        auto const value = code.constants[inst.rhs];
+        forLanes(mask, lanes(inst.dst), [=](auto i) { return evaluate<base>(lhs[i], value); });
+    } else if constexpr (format == OpFormat::Jump) {
+        return state.jump(inst.dst, mask);
+    } else if constexpr (format == OpFormat::JumpCopy) {
+        for (auto i = inst.lhs; i != inst.rhs; ++i) {
+            auto const* src = lanes(code.copies[i].src);
+            forLanes(mask, lanes(code.copies[i].dst), [=](auto l) { return src[l]; });
+        }
+        return state.jump(inst.dst, mask);
+    } else if constexpr (format == OpFormat::Branch) {
+        auto const* cond = lanes(inst.lhs);
+        auto const taken = laneMask(mask, [=](auto i) { return cond[i] != 0; });
+        return state.branch(mask, taken, inst.dst, inst.rhs);
+    } else if constexpr (format == OpFormat::CompareBranch) {
+        auto const* lhs  = lanes(inst.lhs);
+        auto const* rhs  = lanes(inst.rhs);
+        auto const taken = laneMask(mask, [=](auto i) {
+            return evaluate<base>(lhs[i], rhs[i]) != 0;
+        });
+        return state.branch(mask, taken, inst.dst, pc + 1U);
+    } else if constexpr (format == OpFormat::Return) {
+        auto const* lhs = lanes(inst.lhs);
+        forLanes(mask, state.result.data(), [=](auto i) { return lhs[i]; });
+        return yieldGroup;
+    } else if constexpr (format == OpFormat::ReturnConst) {
+        auto const value = code.constants[inst.lhs];
+        forLanes(mask, state.result.data(), [=](auto) { return value; });
+        return yieldGroup;
+    } else if constexpr (format == OpFormat::ReturnBinary) {
+        auto const* lhs = lanes(inst.lhs);
+        auto const* rhs = lanes(inst.rhs);
+        forLanes(mask, state.result.data(), [=](auto i) { return evaluate<base>(lhs[i], rhs[i]); });
+        return yieldGroup;
+    } else {
+        static_assert(Op == OpCode::ReturnVoid);
+        return yieldGroup;
+    }
+
+    return pc + 1U;
+}
+
+}  // namespace
+
+auto Interpreter::runBatch(Bytecode const& code, std::size_t rows) -> void
+{
+    auto state = BatchState{
+        .code    = code,
+        .frame   = _lanes,
+        .result  = _laneResults,
+        .pending = {},
+    };
+
+    auto const active = rows == batchLanes ? allLanes : (LaneMask{1} << rows) - 1U;
+    state.pending.push_back(LaneGroup{.pc = 0, .mask = active});
+
+    while (not state.pending.empty()) {
+        auto const next = std::ranges::min_element(state.pending, {}, &LaneGroup::pc);
+        auto const mask = next->mask;
+        auto pc         = next->pc;
+        state.pending.erase(next);
+
+        while (pc != yieldGroup) {
+            auto const inst = code.code[pc];
+            switch (inst.op) {
+#define SNIR_OP_CODE(Id, Name, Format)                                                               \
+    case OpCode::Id: pc = batchStep<OpCode::Id>(state, inst, pc, mask); break;
+#include "snir/ir/OpCode.def"
+            }
+        }
+    }
+}
+
+}  // namespace snir
@@ -0,0 +1,179 @@
+#include "Journal.hpp"
+
+#include "snir/core/Exception.hpp"
+#include "snir/ir/Branch.hpp"
+#include "snir/ir/CompareKind.hpp"
+#include "snir/ir/FunctionDefinition.hpp"
+#include "snir/ir/Identifier.hpp"
+#include "snir/ir/InstKind.hpp"
+#include "snir/ir/InstructionList.hpp"
+#include "snir/ir/Literal.hpp"
+#include "snir/ir/Operands.hpp"
+#include "snir/ir/Phi.hpp"
+#include "snir/ir/Registry.hpp"
+#include "snir/ir/Result.hpp"
+#include "snir/ir/Type.hpp"
+#include "snir/ir/Uses.hpp"
+#include "snir/ir/ValueId.hpp"
+#include "snir/ir/ValueKind.hpp"
+
+#include <cstddef>
+#include <functional>
+#include <optional>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace snir {
+
+namespace {
+
+// Copies of all components of an entity that are worth restoring, the same
+// set Module::compact carries over.
+template<typename... Components>
+struct Snapshot
+{
+    [[nodiscard]] static auto take(Registry const& reg, ValueId id) -> Snapshot
+    {
+        auto snapshot = Snapshot{};
+        (
+            [&] {
+                if (auto const* component = reg.try_get<Components>(id); component != nullptr) {
+                    std::get<std::optional<Components>>(snapshot.components) = *component;
+                }
+            }(),
+            ...
+        );
+        return snapshot;
+    }
+
+    auto restore(Registry& reg, ValueId id) -> void
+    {
+        (
+            [&] {
+                if (auto& component = std::get<std::optional<Components>>(components); component) {
+                    reg.emplace<Components>(id, std::move(*component));
+                }
+            }(),
+            ...
+        );
+    }
+
+    std::tuple<std::optional<Components>...> components;
+};
+
+using EntitySnapshot = Snapshot<
+    ValueKind,
+    Type,
+    Identifier,
+    FunctionDefinition,
+    InstKind,
+    Operands,
+    Result,
+    CompareKind,
+    Literal,
+    Branch,
+    Phi,
+    Uses>;
+
+[[nodiscard]] auto instructions(Registry& reg, ValueId func, std::size_t block)
+    -> InstructionList&
+{
+    return reg.get<FunctionDefinition>(func).blocks.at(block).instructions;
+}
+
+}  // namespace
+
+auto Journal::begin() -> void { _scopes.push_back(_undo.size()); }
+
+auto Journal::commit() -> void
+{
+    if (_scopes.empty()) {
+        raisef<std::logic_error>("commit without an open journal scope");
+    }
+
+    // The outer scope may still roll back the edits of the inner one.
+    _scopes.pop_back();
+    if (_scopes.empty()) {
+        _undo.clear();
+    }
+}
+
+auto Journal::rollback() -> void
+{
+    if (_scopes.empty()) {
+        raisef<std::logic_error>("rollback without an open journal scope");
+    }
+
+    auto const mark = _scopes.back();
+    _scopes.pop_back();
+    while (_undo.size() > mark) {
+        _undo.back()(*_registry);
+        _undo.pop_back();
+    }
+}
+
+auto Journal::create(ValueKind kind) -> ValueId
+{
+    auto const id = _registry->create();
+    _registry->emplace<ValueKind>(id, kind);
+    record([id](Registry& reg) { reg.destroy(id); });
+    return id;
+}
+
+auto Journal::destroy(ValueId id) -> void
+{
+    removeUses(*_registry, id);
+    if (not _scopes.empty()) {
+        record([id, snapshot = EntitySnapshot::take(*_registry, id)](Registry& reg) mutable {
+            auto const restored = reg.create(id);
+            if (restored != id) {
+                raisef<std::logic_error>("can't restore value {}, id is in use", int(id));
+            }
+            snapshot.restore(reg, id);
+            addUses(reg, id);
+        });
+    }
+    _registry->destroy(id);
+}
+
+auto Journal::insert(
+    ValueId func,
+    std::size_t block,
+    InstructionList::const_iterator pos,
+    ValueId inst
+) -> InstructionList::iterator
+{
+    auto& insts     = instructions(*_registry, func, block);
+    auto const it   = insts.insert(pos, inst);
+    auto const node = InstructionList::node(it);
+    record([func, block, node](Registry& reg) {
+        auto& list = instructions(reg, func, block);
+        list.erase(list.iterator_to(node));
+    });
+    return it;
+}
+
+auto Journal::erase(ValueId func, std::size_t block, InstructionList::const_iterator pos)
+    -> InstructionList::iterator
+{
+    auto& insts     = instructions(*_registry, func, block);
+    auto const inst = *pos;
+    auto const next = insts.erase(pos);
+    auto const node = InstructionList::node(next);
+    record([func, block, node, inst](Registry& reg) {
+        auto& list = instructions(reg, func, block);
+        (void)list.insert(list.iterator_to(node), inst);
+    });
+    return next;
+}
+
+auto Journal::record(std::function<void(Registry&)> undo) -> void
+{
+    if (not _scopes.empty()) {
+        _undo.push_back(std::move(undo));
+    }
+}
+
+}  // namespace snir
@@ -0,0 +1,138 @@
+#pragma once
+
+#include "snir/ir/Branch.hpp"
+#include "snir/ir/InstructionList.hpp"
+#include "snir/ir/Operands.hpp"
+#include "snir/ir/Phi.hpp"
+#include "snir/ir/Registry.hpp"
+#include "snir/ir/Uses.hpp"
+#include "snir/ir/ValueId.hpp"
+#include "snir/ir/ValueKind.hpp"
+
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+namespace snir {
+
+/// \brief Undo journal for speculative edits of a registry.
+///
+/// Edits made through the journal inside a begin() scope record how to
+/// revert them, rollback() replays the records of the innermost scope in
+/// reverse. Both commit and rollback cost is linear in the number of edits
+/// of the scope, independent of the size of the registry. Scopes nest, a
+/// commit of an inner scope hands its records to the outer one. Outside of
+/// a scope edits are applied without recording anything.
+///
+/// Instruction lists are addressed by function and block index instead of
+/// by reference and positions are recorded as list nodes, so replacing a
+/// FunctionDefinition inside the scope is fine. The instructions of a block
+/// have to be edited through the journal while a scope is open, rollback
+/// relies on the list handing out the erased nodes again.
+///
+/// Edits of Operands, Branch and Phi keep the use lists up to date, the
+/// same way the Instruction setters do.
+struct Journal
+{
+    explicit Journal(Registry& registry) : _registry{&registry} {}
+
+    auto begin() -> void;
+    auto commit() -> void;
+    auto rollback() -> void;
+
+    /// \brief Number of open scopes.
+    [[nodiscard]] auto depth() const noexcept -> std::size_t { return _scopes.size(); }
+
+    /// \brief Number of recorded edits in all open scopes.
+    [[nodiscard]] auto size() const noexcept -> std::size_t { return _undo.size(); }
+
+    [[nodiscard]] auto create(ValueKind kind) -> ValueId;
+
+    /// \brief Destroys the entity, rollback restores it with the same id and
+    /// the components a Module::compact keeps, cached analysis is dropped.
+    auto destroy(ValueId id) -> void;
+
+    template<typename Component, typename... Args>
+    auto emplace(ValueId id, Args&&... args) -> Component&
+    {
+        record([id](Registry& reg) {
+            rewire<Component>(reg, id, [id](Registry& r) { r.remove<Component>(id); });
+        });
+        rewire<Component>(*_registry, id, [&](Registry& reg) {
+            (void)reg.emplace<Component>(id, std::forward<Args>(args)...);
+        });
+        return _registry->get<Component>(id);
+    }
+
+    template<typename Component, typename... Args>
+    auto replace(ValueId id, Args&&... args) -> Component&
+    {
+        save<Component>(id);
+        rewire<Component>(*_registry, id, [&](Registry& reg) {
+            (void)reg.replace<Component>(id, std::forward<Args>(args)...);
+        });
+        return _registry->get<Component>(id);
+    }
+
+    template<typename Component>
+    auto remove(ValueId id) -> void
+    {
+        save<Component>(id);
+        rewire<Component>(*_registry, id, [id](Registry& reg) { reg.remove<Component>(id); });
+    }
+
+    /// \brief Records the current value of the component, use before
+    /// changing it in place. Rollback puts the saved copy back. In place
+    /// edits of operands still need removeUses and addUses around them.
+    template<typename Component>
+    auto save(ValueId id) -> void
+    {
+        if (_scopes.empty()) {
+            return;
+        }
+        record([id, old = _registry->get<Component>(id)](Registry& reg) mutable {
+            rewire<Component>(reg, id, [id, &old](Registry& r) {
+                (void)r.emplace_or_replace<Component>(id, std::move(old));
+            });
+        });
+    }
+
+    /// \brief Inserts inst before pos, returns its position.
+    auto insert(ValueId func, std::size_t block, InstructionList::const_iterator pos, ValueId inst)
+        -> InstructionList::iterator;
+
+    /// \brief Returns the position following the erased instruction.
+    auto erase(ValueId func, std::size_t block, InstructionList::const_iterator pos)
+        -> InstructionList::iterator;
+
+private:
+    template<typename Component>
+    static constexpr auto holdsOperands = std::same_as<Component, Operands>
+                                       or std::same_as<Component, Branch>
+                                       or std::same_as<Component, Phi>;
+
+    // Runs the edit between unlinking and relinking the uses of id, if the
+    // component holds operands.
+    template<typename Component, typename Edit>
+    static auto rewire(Registry& reg, ValueId id, Edit edit) -> void
+    {
+        if constexpr (holdsOperands<Component>) {
+            removeUses(reg, id);
+            edit(reg);
+            addUses(reg, id);
+        } else {
+            edit(reg);
+        }
+    }
+
+    auto record(std::function<void(Registry&)> undo) -> void;
+
+    Registry* _registry;
+    std::vector<std::function<void(Registry&)>> _undo;
+    std::vector<std::size_t> _scopes;
+};
+
+}  // namespace snir
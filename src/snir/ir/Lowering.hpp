@@ -0,0 +1,297 @@
+#pragma once
+
+#include "snir/core/Exception.hpp"
+#include "snir/ir/Bytecode.hpp"
+#include "snir/ir/CompareKind.hpp"
+#include "snir/ir/InstKind.hpp"
+#include "snir/ir/OpCode.hpp"
+#include "snir/ir/Type.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+// Lowering steps shared by Bytecode::compile, v4::compile and the constexpr
+// compiler behind StaticFunction. Everything here works in constant evaluation.
+
+namespace snir {
+
+/// \brief Placeholder slot for breaking up copy cycles, replaced by
+/// assignScratchSlot once the number of registers is known.
+inline constexpr auto scratchSlot = std::numeric_limits<std::uint32_t>::max();
+
+[[nodiscard]] constexpr auto isTerminator(OpCode op) -> bool
+{
+    return op == OpCode::Jump or op == OpCode::JumpCopy or op == OpCode::BranchIf
+        or op == OpCode::Return or op == OpCode::ReturnVoid;
+}
+
+[[nodiscard]] constexpr auto selectIntOp(InstKind kind, Type type) -> OpCode
+{
+    if (type != Type::Int64) {
+        raisef<std::runtime_error>("unsupported type {} for integer op", type);
+    }
+
+    switch (kind) {
+        case InstKind::Add: return OpCode::AddI64;
+        case InstKind::Sub: return OpCode::SubI64;
+        case InstKind::Mul: return OpCode::MulI64;
+        case InstKind::Div: return OpCode::DivI64;
+        case InstKind::Mod: return OpCode::ModI64;
+        case InstKind::And: return OpCode::AndI64;
+        case InstKind::Or: return OpCode::OrI64;
+        case InstKind::Xor: return OpCode::XorI64;
+        case InstKind::ShiftLeft: return OpCode::ShiftLeftI64;
+        case InstKind::ShiftRight: return OpCode::ShiftRightI64;
+        default: raisef<std::runtime_error>("unimplemented: {}<{}>", kind, type);
+    }
+}
+
+[[nodiscard]] constexpr auto selectFloatOp(InstKind kind, Type type) -> OpCode
+{
+    if (type == Type::Float) {
+        switch (kind) {
+            case InstKind::FloatAdd: return OpCode::FloatAddF32;
+            case InstKind::FloatSub: return OpCode::FloatSubF32;
+            case InstKind::FloatMul: return OpCode::FloatMulF32;
+            case InstKind::FloatDiv: return OpCode::FloatDivF32;
+            default: break;
+        }
+    }
+    if (type == Type::Double) {
+        switch (kind) {
+            case InstKind::FloatAdd: return OpCode::FloatAddF64;
+            case InstKind::FloatSub: return OpCode::FloatSubF64;
+            case InstKind::FloatMul: return OpCode::FloatMulF64;
+            case InstKind::FloatDiv: return OpCode::FloatDivF64;
+            default: break;
+        }
+    }
+
+    raisef<std::runtime_error>("unsupported type {} for float op", type);
+}
+
+[[nodiscard]] constexpr auto selectCompareOp(CompareKind cmp) -> OpCode
+{
+    if (cmp == CompareKind::Equal) {
+        return OpCode::CmpEq;
+    }
+    if (cmp == CompareKind::NotEqual) {
+        return OpCode::CmpNe;
+    }
+    raisef<std::runtime_error>("unsupported kind {} for integer compare", cmp);
+}
+
+[[nodiscard]] constexpr auto selectTruncOp(Type from, Type to) -> OpCode
+{
+    if (from == Type::Bool) {
+        from = Type::Int64;
+    }
+    if (from == to and to != Type::Bool) {
+        return OpCode::Move;
+    }
+
+    if (from == Type::Int64 and to == Type::Float) {
+        return OpCode::TruncI64ToF32;
+    }
+    if (from == Type::Int64 and to == Type::Double) {
+        return OpCode::TruncI64ToF64;
+    }
+    if (from == Type::Float and to == Type::Int64) {
+        return OpCode::TruncF32ToI64;
+    }
+    if (from == Type::Float and to == Type::Double) {
+        return OpCode::TruncF32ToF64;
+    }
+    if (from == Type::Double and to == Type::Int64) {
+        return OpCode::TruncF64ToI64;
+    }
+    if (from == Type::Double and to == Type::Float) {
+        return OpCode::TruncF64ToF32;
+    }
+
+    raisef<std::runtime_error>("unsupported type {} for trunc op", to);
+}
+
+/// \brief Appends parallel copies to copies in an order where no source is
+/// overwritten before it is read. Cycles are broken up through scratch.
+constexpr auto sequentialize(
+    std::vector<Bytecode::Copy> pending,
+    std::uint32_t scratch,
+    std::vector<Bytecode::Copy>& copies
+) -> void
+{
+    auto const isSource = [&pending](std::uint32_t s) {
+        return std::ranges::contains(pending, s, &Bytecode::Copy::src);
+    };
+
+    while (not pending.empty()) {
+        auto ready = std::ranges::find_if(pending, [&](auto c) { return not isSource(c.dst); });
+        if (ready != pending.end()) {
+            copies.push_back(*ready);
+            pending.erase(ready);
+            continue;
+        }
+
+        auto const saved = pending.front().dst;
+        copies.push_back(Bytecode::Copy{.dst = scratch, .src = saved});
+        for (auto& copy : pending) {
+            if (copy.src == saved) {
+                copy.src = scratch;
+            }
+        }
+    }
+}
+
+/// \brief Places the scratch slot behind all registers of code.
+constexpr auto assignScratchSlot(Bytecode& code) -> void
+{
+    auto used = false;
+    for (auto& copy : code.copies) {
+        for (auto* s : {&copy.dst, &copy.src}) {
+            if (*s == scratchSlot) {
+                *s   = code.registers;
+                used = true;
+            }
+        }
+    }
+    if (used) {
+        ++code.registers;
+    }
+}
+
+/// \brief Emits the jumps between blocks with the phi copies on their edges
+/// and patches the targets once every block has a pc. Block is how the front
+/// end names a block, e.g. its label.
+template<typename Block>
+struct EdgeEmitter
+{
+    /// \brief Unconditional jump to target, running the copies for its phis.
+    constexpr auto jump(Bytecode& code, Block target, std::vector<Bytecode::Copy> copies) -> void
+    {
+        auto const [begin, end] = addCopies(code, std::move(copies));
+        if (begin == end) {
+            emit(code, OpCode::Jump);
+        } else {
+            emit(code, OpCode::JumpCopy, 0, begin, end);
+        }
+        addFixup(code, &Bytecode::Inst::dst, target);
+    }
+
+    /// \brief Conditional branch on the register in slot condition. Edges with
+    /// copies leave through an out-of-line JumpCopy stub.
+    constexpr auto branchIf(
+        Bytecode& code,
+        std::uint32_t condition,
+        Block iftrue,
+        std::vector<Bytecode::Copy> trueCopies,
+        Block iffalse,
+        std::vector<Bytecode::Copy> falseCopies
+    ) -> void
+    {
+        emit(code, OpCode::BranchIf, 0, condition);
+        addEdge(code, &Bytecode::Inst::dst, iftrue, std::move(trueCopies));
+        addEdge(code, &Bytecode::Inst::rhs, iffalse, std::move(falseCopies));
+    }
+
+    /// \brief Terminates the code, appends the stubs and points every jump at
+    /// labelPc(block), the pc the front end recorded for the block.
+    template<typename LabelPc>
+    constexpr auto finish(Bytecode& code, LabelPc const& labelPc) -> void
+    {
+        if (code.code.empty() or not isTerminator(code.code.back().op)) {
+            emit(code, OpCode::Unreachable);
+        }
+
+        for (auto const& stub : _stubs) {
+            code.code.at(stub.pc).*stub.field = pc(code);
+            emit(code, OpCode::JumpCopy, 0, stub.begin, stub.end);
+            addFixup(code, &Bytecode::Inst::dst, stub.target);
+        }
+        for (auto const& fixup : _fixups) {
+            code.code.at(fixup.pc).*fixup.field = labelPc(fixup.block);
+        }
+    }
+
+private:
+    using Range = std::pair<std::uint32_t, std::uint32_t>;
+
+    struct Fixup
+    {
+        std::uint32_t pc;
+        std::uint32_t Bytecode::Inst::* field;
+        Block block;
+    };
+
+    // Out-of-line JumpCopy for a conditional branch edge into a phi block.
+    struct Stub
+    {
+        std::uint32_t pc;
+        std::uint32_t Bytecode::Inst::* field;
+        Block target;
+        std::uint32_t begin;
+        std::uint32_t end;
+    };
+
+    [[nodiscard]] static constexpr auto pc(Bytecode const& code) -> std::uint32_t
+    {
+        return static_cast<std::uint32_t>(code.code.size());
+    }
+
+    static constexpr auto emit(
+        Bytecode& code,
+        OpCode op,
+        std::uint32_t dst = 0,
+        std::uint32_t lhs = 0,
+        std::uint32_t rhs = 0
+    ) -> void
+    {
+        code.code.push_back(Bytecode::Inst{.op = op, .dst = dst, .lhs = lhs, .rhs = rhs});
+    }
+
+    // Appends the sequentialized copies and returns their range in
+    // Bytecode::copies.
+    [[nodiscard]] static constexpr auto
+    addCopies(Bytecode& code, std::vector<Bytecode::Copy> copies) -> Range
+    {
+        auto const begin = static_cast<std::uint32_t>(code.copies.size());
+        sequentialize(std::move(copies), scratchSlot, code.copies);
+        return {begin, static_cast<std::uint32_t>(code.copies.size())};
+    }
+
+    constexpr auto addEdge(
+        Bytecode& code,
+        std::uint32_t Bytecode::Inst::* field,
+        Block target,
+        std::vector<Bytecode::Copy> copies
+    ) -> void
+    {
+        auto const [begin, end] = addCopies(code, std::move(copies));
+        if (begin == end) {
+            addFixup(code, field, target);
+            return;
+        }
+
+        _stubs.push_back(Stub{
+            .pc     = pc(code) - 1U,
+            .field  = field,
+            .target = target,
+            .begin  = begin,
+            .end    = end,
+        });
+    }
+
+    constexpr auto
+    addFixup(Bytecode const& code, std::uint32_t Bytecode::Inst::* field, Block block) -> void
+    {
+        _fixups.push_back(Fixup{.pc = pc(code) - 1U, .field = field, .block = block});
+    }
+
+    std::vector<Fixup> _fixups;
+    std::vector<Stub> _stubs;
+};
+
+}  // namespace snir
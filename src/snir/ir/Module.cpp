@@ -0,0 +1,364 @@
+#include "Module.hpp"
+
+#include "snir/core/Exception.hpp"
+#include "snir/core/FlatSet.hpp"
+#include "snir/core/StringPool.hpp"
+#include "snir/ir/Branch.hpp"
+#include "snir/ir/CompareKind.hpp"
+#include "snir/ir/Function.hpp"
+#include "snir/ir/FunctionDefinition.hpp"
+#include "snir/ir/Groups.hpp"
+#include "snir/ir/Identifier.hpp"
+#include "snir/ir/InstKind.hpp"
+#include "snir/ir/Literal.hpp"
+#include "snir/ir/Operands.hpp"
+#include "snir/ir/Phi.hpp"
+#include "snir/ir/Registry.hpp"
+#include "snir/ir/Result.hpp"
+#include "snir/ir/Type.hpp"
+#include "snir/ir/Uses.hpp"
+#include "snir/ir/ValueId.hpp"
+#include "snir/ir/ValueKind.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace snir {
+
+namespace {
+
+// Everything a function refers to: its arguments, block labels and
+// instructions plus every value, label and incoming block they name.
+[[nodiscard]] auto markReachable(Registry const& reg, std::span<ValueId const> roots)
+    -> FlatSet<ValueId>
+{
+    auto marked = std::vector<ValueId>{roots.begin(), roots.end()};
+    auto mark   = [&marked](ValueId id) { marked.push_back(id); };
+    for (auto const root : roots) {
+        auto const* def = reg.try_get<FunctionDefinition>(root);
+        if (def == nullptr) {
+            continue;
+        }
+
+        std::ranges::for_each(def->args, mark);
+        for (auto const& block : def->blocks) {
+            mark(block.label);
+            for (auto const inst : block.instructions) {
+                mark(inst);
+                forEachOperand(reg, inst, mark);
+                if (auto const* result = reg.try_get<Result>(inst); result != nullptr) {
+                    mark(result->id);
+                }
+                if (auto const* br = reg.try_get<Branch>(inst); br != nullptr) {
+                    mark(br->iftrue);
+                    if (br->iffalse) {
+                        mark(*br->iffalse);
+                    }
+                }
+                if (auto const* phi = reg.try_get<Phi>(inst); phi != nullptr) {
+                    std::ranges::for_each(phi->incoming, mark, &Phi::Incoming::block);
+                }
+            }
+        }
+    }
+    return FlatSet<ValueId>{marked};
+}
+
+[[nodiscard]] auto valuesOf(Registry& reg, ValueKind kind) -> std::vector<ValueId>
+{
+    auto values = std::vector<ValueId>{};
+    auto kinds  = reg.view<ValueKind>();
+    for (auto const id : kinds) {
+        if (kinds.get<ValueKind>(id) == kind) {
+            values.push_back(id);
+        }
+    }
+    return values;
+}
+
+// All functions in the registry count as roots, another module may share it.
+[[nodiscard]] auto functionsIn(Registry& reg) -> std::vector<ValueId>
+{
+    return valuesOf(reg, ValueKind::Function);
+}
+
+// Instructions that left the IR stop being users of the values they read,
+// so the use lists stay valid without rescanning the functions.
+auto unlinkUnreachable(Registry& reg, FlatSet<ValueId> const& reachable) -> void
+{
+    auto dropped = std::vector<ValueId>{};
+    for (auto const id : reg.view<UseSlots>()) {
+        if (not reachable.contains(id)) {
+            dropped.push_back(id);
+        }
+    }
+    for (auto const id : dropped) {
+        removeUses(reg, id);
+    }
+}
+
+[[nodiscard]] auto sweep(Registry& reg, FlatSet<ValueId> const& reachable) -> std::size_t
+{
+    unlinkUnreachable(reg, reachable);
+
+    // Functions and globals are never garbage, only the values inside.
+    auto garbage = std::vector<ValueId>{};
+    auto kinds   = reg.view<ValueKind>();
+    for (auto const id : kinds) {
+        auto const kind  = kinds.get<ValueKind>(id);
+        auto const owned = kind != ValueKind::Function and kind != ValueKind::Global;
+        if (owned and not reachable.contains(id)) {
+            garbage.push_back(id);
+        }
+    }
+
+    reg.destroy(garbage.begin(), garbage.end());
+    return garbage.size();
+}
+
+/// \brief Maps the reachable entities of a registry to new entities.
+struct Renumber
+{
+    [[nodiscard]] auto operator()(ValueId id) const -> ValueId
+    {
+        auto const found = reachable->find(id);
+        if (found == reachable->end()) {
+            raisef<std::logic_error>("reference to unreachable value {}", int(id));
+        }
+        return ids->at(static_cast<std::size_t>(std::distance(reachable->begin(), found)));
+    }
+
+    [[nodiscard]] auto operator()(Result result) const -> Result
+    {
+        return Result{(*this)(result.id)};
+    }
+
+    [[nodiscard]] auto operator()(Operands operands) const -> Operands
+    {
+        std::ranges::transform(operands.list, operands.list.begin(), *this);
+        return operands;
+    }
+
+    [[nodiscard]] auto operator()(Branch br) const -> Branch
+    {
+        br.iftrue = (*this)(br.iftrue);
+        if (br.iffalse) {
+            br.iffalse = (*this)(*br.iffalse);
+        }
+        if (br.condition) {
+            br.condition = (*this)(*br.condition);
+        }
+        return br;
+    }
+
+    [[nodiscard]] auto operator()(Phi phi) const -> Phi
+    {
+        for (auto& incoming : phi.incoming) {
+            incoming.value = (*this)(incoming.value);
+            incoming.block = (*this)(incoming.block);
+        }
+        return phi;
+    }
+
+    [[nodiscard]] auto operator()(Uses uses) const -> Uses
+    {
+        std::ranges::transform(uses.users, uses.users.begin(), *this);
+        return uses;
+    }
+
+    [[nodiscard]] auto operator()(FunctionDefinition def) const -> FunctionDefinition
+    {
+        std::ranges::transform(def.args, def.args.begin(), *this);
+        for (auto& block : def.blocks) {
+            block.label = (*this)(block.label);
+            std::ranges::transform(block.instructions, block.instructions.begin(), *this);
+        }
+        return def;
+    }
+
+    template<typename Component>
+    [[nodiscard]] auto operator()(Component const& component) const -> Component
+    {
+        return component;
+    }
+
+    FlatSet<ValueId> const* reachable;
+    std::vector<ValueId> const* ids;
+};
+
+// Components that are not copied are dropped, e.g. cached analysis results.
+template<typename... Components>
+auto copyComponents(Registry const& from, Registry& to, ValueId id, Renumber const& renumber) -> void
+{
+    auto const target = renumber(id);
+    (
+        [&] {
+            if (auto const* component = from.try_get<Components>(id); component != nullptr) {
+                to.emplace<Components>(target, renumber(*component));
+            }
+        }(),
+        ...
+    );
+}
+
+}  // namespace
+
+Module::Module(Registry& registry, FunctionStorage storage)
+    : _registry{&registry}
+    , _storage{storage}
+{
+    declareGroups(*_registry);
+}
+
+auto Module::create(std::string_view name, Type type) -> Function
+{
+    auto const symbol = symbols().intern(name);
+    if (_symbols.contains(symbol)) {
+        raisef<std::invalid_argument>("duplicate function '{}' in module", name);
+    }
+
+    auto* reg = _registry;
+    if (_storage == FunctionStorage::Isolated) {
+        reg = _isolated.emplace_back(std::make_unique<Registry>()).get();
+        shareSymbols(*_registry, *reg);
+        declareGroups(*reg);
+    }
+
+    auto func = Function::create(*reg, type);
+    func.asValue().emplace<Identifier>(symbol);
+    _functions.push_back(func);
+    _symbols.emplace(symbol, func);
+    return func;
+}
+
+auto Module::function(std::string_view name) const -> std::optional<Function>
+{
+    auto const symbol = symbols().find(name);
+    if (not symbol) {
+        return std::nullopt;
+    }
+    if (auto const found = _symbols.find(*symbol); found != _symbols.end()) {
+        return found->second;
+    }
+    return std::nullopt;
+}
+
+auto Module::erase(std::string_view name) -> void
+{
+    auto const symbol = symbols().find(name);
+    auto const found  = symbol ? _symbols.find(*symbol) : _symbols.end();
+    if (found == _symbols.end()) {
+        raisef<std::out_of_range>("no function '{}' in module", name);
+    }
+
+    auto const func = found->second;
+    auto* reg       = func.asValue().registry();
+    std::erase_if(_functions, [reg, id = static_cast<ValueId>(func)](Function const& f) {
+        return f.asValue().registry() == reg and static_cast<ValueId>(f) == id;
+    });
+    _symbols.erase(found);
+
+    if (_storage == FunctionStorage::Isolated) {
+        std::erase_if(_isolated, [reg](auto const& isolated) { return isolated.get() == reg; });
+        return;
+    }
+
+    for (auto const id : markReachable(*reg, std::array{static_cast<ValueId>(func)})) {
+        if (reg->valid(id)) {
+            reg->destroy(id);
+        }
+    }
+}
+
+auto Module::collectGarbage() -> std::size_t
+{
+    auto destroyed = 0zu;
+    for (auto* reg : registries()) {
+        destroyed += sweep(*reg, markReachable(*reg, functionsIn(*reg)));
+    }
+    return destroyed;
+}
+
+auto Module::compact() -> void
+{
+    for (auto* reg : registries()) {
+        auto const roots = functionsIn(*reg);
+        auto const owned = std::ranges::count_if(_functions, [reg](Function const& func) {
+            return func.asValue().registry() == reg;
+        });
+        if (static_cast<std::size_t>(owned) != roots.size()) {
+            raisef<std::logic_error>("can't compact a registry shared with another module");
+        }
+
+        // Globals are kept like in collectGarbage, although no function uses them.
+        auto seeds = roots;
+        std::ranges::copy(valuesOf(*reg, ValueKind::Global), std::back_inserter(seeds));
+
+        // A fresh registry hands out dense ids in the order of the old ones.
+        auto const reachable = markReachable(*reg, seeds);
+        unlinkUnreachable(*reg, reachable);
+
+        auto fresh = Registry{};
+        auto ids             = std::vector<ValueId>(reachable.size());
+        declareGroups(fresh);
+        shareSymbols(*reg, fresh);
+        fresh.ctx().insert_or_assign(Generation{static_cast<std::uint32_t>(generation(*reg)) + 1});
+        fresh.create(ids.begin(), ids.end());
+
+        auto const renumber = Renumber{.reachable = &reachable, .ids = &ids};
+        for (auto const id : reachable) {
+            copyComponents<
+                ValueKind,
+                Type,
+                Identifier,
+                FunctionDefinition,
+                InstKind,
+                Operands,
+                Result,
+                CompareKind,
+                Literal,
+                Branch,
+                Phi,
+                Uses,
+                UseSlots>(*reg, fresh, id, renumber);
+        }
+
+        for (auto& func : _functions) {
+            if (func.asValue().registry() == reg) {
+                func = Function{*reg, renumber(static_cast<ValueId>(func))};
+            }
+        }
+        for (auto& [name, func] : _symbols) {
+            if (func.asValue().registry() == reg) {
+                func = Function{*reg, renumber(static_cast<ValueId>(func))};
+            }
+        }
+        *reg = std::move(fresh);
+    }
+}
+
+// The module registry of isolated functions only holds module level values.
+auto Module::registries() -> std::vector<Registry*>
+{
+    if (_storage == FunctionStorage::Shared) {
+        return {_registry};
+    }
+
+    auto result = std::vector<Registry*>{};
+    for (auto const& isolated : _isolated) {
+        result.push_back(isolated.get());
+    }
+    return result;
+}
+
+}  // namespace snir
@@ -1,27 +1,83 @@
 #pragma once
 
+#include "snir/core/StringPool.hpp"
+#include "snir/ir/Function.hpp"
+#include "snir/ir/Identifier.hpp"
 #include "snir/ir/Registry.hpp"
+#include "snir/ir/Type.hpp"
 #include "snir/ir/ValueId.hpp"
 
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string_view>
 #include <vector>
 
 namespace snir {
 
+/// \brief Where the values of a function are allocated.
+enum struct FunctionStorage : std::uint8_t
+{
+    Shared,    // In the module registry.
+    Isolated,  // In a registry owned by the function.
+};
+
+/// \brief List of functions plus a symbol table from name to function.
+///
+/// With isolated storage every function lives in a registry of its own, so
+/// different functions can be built, optimized and lowered on different
+/// threads without locking. The module registry then only holds module
+/// level values. Entity ids are only unique within one registry, always go
+/// through the registry of the function handle.
 struct Module
 {
-    explicit Module(Registry& registry) : _registry{&registry} {}
+    explicit Module(Registry& registry, FunctionStorage storage = FunctionStorage::Shared);
 
     [[nodiscard]] auto registry() -> Registry& { return *_registry; }
 
     [[nodiscard]] auto registry() const -> Registry const& { return *_registry; }
 
-    [[nodiscard]] auto functions() -> std::vector<ValueId>& { return _functions; }
+    [[nodiscard]] auto storage() const noexcept -> FunctionStorage { return _storage; }
+
+    /// \brief Interned names of the module, shared by all of its registries.
+    [[nodiscard]] auto symbols() const -> StringPool& { return snir::symbols(*_registry); }
+
+    [[nodiscard]] auto functions() -> std::vector<Function>& { return _functions; }
+
+    [[nodiscard]] auto functions() const -> std::vector<Function> const& { return _functions; }
 
-    [[nodiscard]] auto functions() const -> std::vector<ValueId> const& { return _functions; }
+    /// \brief Creates an empty function and adds it to the symbol table.
+    [[nodiscard]] auto create(std::string_view name, Type type) -> Function;
+
+    [[nodiscard]] auto function(std::string_view name) const -> std::optional<Function>;
+
+    /// \brief Removes the function and all of its values. An isolated
+    /// function drops its whole registry at once.
+    auto erase(std::string_view name) -> void;
+
+    /// \brief Destroys the instructions, registers and labels no function
+    /// reaches anymore, e.g. the ones dropped by DeadStoreElimination and
+    /// RemoveNop. Returns the number of destroyed entities.
+    auto collectGarbage() -> std::size_t;
+
+    /// \brief Rebuilds every registry with only the reachable entities, so
+    /// ids are dense and component storage is packed again. Globals are kept
+    /// like in collectGarbage. Invalidates all ValueIds and handles, drops
+    /// cached analysis results and bumps the generation of each registry so
+    /// ResultCache entries of the old ids miss. The registries must not hold
+    /// functions of another module.
+    auto compact() -> void;
 
 private:
+    [[nodiscard]] auto registries() -> std::vector<Registry*>;
+
     Registry* _registry;
-    std::vector<ValueId> _functions;
+    FunctionStorage _storage;
+    std::vector<Function> _functions;
+    std::map<Symbol, Function> _symbols;
+    std::vector<std::unique_ptr<Registry>> _isolated;
 };
 
 }  // namespace snir
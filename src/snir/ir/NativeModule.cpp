@@ -0,0 +1,146 @@
+#include "NativeModule.hpp"
+
+#include "snir/core/Exception.hpp"
+#include "snir/ir/CWriter.hpp"
+#include "snir/ir/Function.hpp"
+#include "snir/ir/Module.hpp"
+#include "snir/ir/Registry.hpp"
+#include "snir/ir/Type.hpp"
+#include "snir/ir/Value.hpp"
+
+#include "fmt/format.h"
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#if SNIR_HAS_NATIVE_MODULE
+    #include <dlfcn.h>
+    #include <stdlib.h>  // NOLINT(*-deprecated-headers)
+#endif
+
+namespace snir {
+
+#if SNIR_HAS_NATIVE_MODULE
+
+namespace {
+
+/// \brief Directory for the generated files, removed on destruction.
+struct TemporaryDirectory
+{
+    TemporaryDirectory()
+    {
+        auto pattern = (std::filesystem::temp_directory_path() / "snir-XXXXXX").string();
+        if (::mkdtemp(pattern.data()) == nullptr) {
+            raisef<std::runtime_error>("failed to create temporary directory '{}'", pattern);
+        }
+        path = pattern;
+    }
+
+    TemporaryDirectory(TemporaryDirectory const& other)                    = delete;
+    auto operator=(TemporaryDirectory const& other) -> TemporaryDirectory& = delete;
+
+    ~TemporaryDirectory()
+    {
+        auto error = std::error_code{};
+        std::filesystem::remove_all(path, error);
+    }
+
+    std::filesystem::path path;
+};
+
+[[nodiscard]] auto compiler() -> std::string
+{
+    auto const* cc = std::getenv("CC");  // NOLINT(concurrency-mt-unsafe)
+    return cc != nullptr ? std::string{cc} : std::string{"cc"};
+}
+
+}  // namespace
+
+auto NativeModule::compile(Module& module, std::string_view flags) -> NativeModule
+{
+    auto const dir    = TemporaryDirectory{};
+    auto const source = dir.path / "module.c";
+    auto const shared = dir.path / "module.so";
+
+    {
+        auto out    = std::ofstream{source};
+        auto writer = CWriter{out};
+        writer(module);
+        if (not out) {
+            raisef<std::runtime_error>("failed to write '{}'", source.string());
+        }
+    }
+
+    auto const command = fmt::format(
+        "{} -std=c11 {} -shared -fPIC -o '{}' '{}'",
+        compiler(),
+        flags,
+        shared.string(),
+        source.string()
+    );
+    if (std::system(command.c_str()) != 0) {  // NOLINT(concurrency-mt-unsafe)
+        raisef<std::runtime_error>("failed to compile native module: {}", command);
+    }
+
+    auto result    = NativeModule{};
+    result._handle = ::dlopen(shared.c_str(), RTLD_NOW | RTLD_LOCAL);
+    if (result._handle == nullptr) {
+        raisef<std::runtime_error>("failed to load native module: {}", ::dlerror());
+    }
+
+    for (auto const& func : module.functions()) {
+        auto const& reg = *func.asValue().registry();
+        auto symbol     = Symbol{.type = func.type(), .arguments = {}};
+        for (auto const arg : func.arguments()) {
+            symbol.arguments.push_back(reg.get<Type>(arg));
+        }
+
+        auto const name = std::string{func.identifier()};
+        symbol.address  = ::dlsym(result._handle, name.c_str());
+        if (symbol.address == nullptr) {
+            raisef<std::runtime_error>("missing symbol '{}' in native module", name);
+        }
+        result._functions.emplace(name, std::move(symbol));
+    }
+    return result;
+}
+
+NativeModule::~NativeModule()
+{
+    if (_handle != nullptr) {
+        ::dlclose(_handle);
+    }
+}
+
+#else
+
+auto NativeModule::compile(Module& /*module*/, std::string_view /*flags*/) -> NativeModule
+{
+    raisef<std::runtime_error>("native modules need dlopen");
+}
+
+NativeModule::~NativeModule() = default;
+
+#endif
+
+NativeModule::NativeModule(NativeModule&& other) noexcept
+    : _handle{std::exchange(other._handle, nullptr)}
+    , _functions{std::move(other._functions)}
+{}
+
+auto NativeModule::operator=(NativeModule&& other) noexcept -> NativeModule&
+{
+    auto tmp = std::move(other);
+    std::swap(_handle, tmp._handle);
+    std::swap(_functions, tmp._functions);
+    return *this;
+}
+
+}  // namespace snir
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "snir/core/Exception.hpp"
+#include "snir/ir/Bytecode.hpp"
+#include "snir/ir/Module.hpp"
+#include "snir/ir/Type.hpp"
+
+#include <functional>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#if defined(__unix__) or defined(__APPLE__)
+    #define SNIR_HAS_NATIVE_MODULE 1
+#else
+    #define SNIR_HAS_NATIVE_MODULE 0
+#endif
+
+namespace snir {
+
+/// \brief Module compiled to native code by the host C compiler.
+///
+/// The module is written by CWriter, compiled with $CC (default cc) into a
+/// shared object in a temporary directory and loaded with dlopen.
+struct NativeModule
+{
+    [[nodiscard]] static auto compile(Module& module, std::string_view flags = "-O2")
+        -> NativeModule;
+
+    NativeModule(NativeModule const& other) = delete;
+    NativeModule(NativeModule&& other) noexcept;
+    ~NativeModule();
+
+    auto operator=(NativeModule const& other) -> NativeModule& = delete;
+    auto operator=(NativeModule&& other) noexcept -> NativeModule&;
+
+    /// \brief Typed entry point, e.g. get<std::int64_t(std::int64_t)>("func").
+    template<typename Signature>
+    [[nodiscard]] auto get(std::string_view name) const -> Signature*
+    {
+        auto const found = _functions.find(name);
+        if (found == _functions.end()) {
+            raisef<std::invalid_argument>("no function '{}' in native module", name);
+        }
+
+        auto const& func = found->second;
+        if (not detail::SignatureTraits<Signature>::matches(func.type, func.arguments)) {
+            raisef<std::invalid_argument>("signature does not match function '{}'", name);
+        }
+        return reinterpret_cast<Signature*>(func.address);  // NOLINT(*-reinterpret-cast)
+    }
+
+private:
+    struct Symbol
+    {
+        Type type{Type::Void};
+        std::vector<Type> arguments;
+        void* address{nullptr};
+    };
+
+    NativeModule() = default;
+
+    void* _handle{nullptr};
+    std::map<std::string, Symbol, std::less<>> _functions;
+};
+
+}  // namespace snir
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "fmt/format.h"
+
+#include <array>
+#include <cstdint>
+
+namespace snir {
+
+enum struct OpCode : std::uint8_t
+{
+#define SNIR_OP_CODE(Id, Name, Format) Id,
+#include "snir/ir/OpCode.def"
+};
+
+/// \brief How an instruction uses its dst, lhs and rhs fields.
+enum struct OpFormat : std::uint8_t
+{
+    None,           // no operands
+    Const,          // dst = constants[lhs]
+    ConstPair,      // dst = constants[lhs], rhs = constants[lhs + 1]
+    Unary,          // dst = op(lhs)
+    Binary,         // dst = op(lhs, rhs)
+    BinaryConst,    // dst = op(lhs, constants[rhs])
+    Jump,           // pc = dst
+    JumpCopy,       // copies[lhs, rhs), then pc = dst
+    Branch,         // pc = lhs ? dst : rhs
+    CompareBranch,  // pc = op(lhs, rhs) ? dst : pc + 1
+    Return,         // return lhs
+    ReturnConst,    // return constants[lhs]
+    ReturnBinary,   // return op(lhs, rhs)
+};
+
+[[nodiscard]] constexpr auto getOpFormat(OpCode op) -> OpFormat
+{
+    constexpr auto formats = std::array{
+#define SNIR_OP_CODE(Id, Name, Format) OpFormat::Format,
+#include "snir/ir/OpCode.def"
+    };
+
+    return formats.at(static_cast<std::size_t>(op));
+}
+
+/// \brief Returns the opcode a superinstruction was fused from, or op itself.
+[[nodiscard]] constexpr auto getBaseOpCode(OpCode op) -> OpCode
+{
+    constexpr auto bases = std::array{
+#define SNIR_OP_CODE(Id, Name, Format) OpCode::Id,
+#define SNIR_FUSED_OP_CODE(Id, Name, Format, Base) OpCode::Base,
+#include "snir/ir/OpCode.def"
+    };
+
+    return bases.at(static_cast<std::size_t>(op));
+}
+
+}  // namespace snir
+
+template<>
+struct fmt::formatter<snir::OpCode> : formatter<string_view>
+{
+    template<typename FormatContext>
+    auto format(snir::OpCode op, FormatContext& ctx) const
+    {
+        static constexpr auto names = std::array{
+#define SNIR_OP_CODE(Id, Name, Format) string_view{#Name},
+#include "snir/ir/OpCode.def"
+        };
+
+        auto str = names.at(static_cast<std::size_t>(op));
+        return formatter<string_view>::format(str, ctx);
+    }
+};
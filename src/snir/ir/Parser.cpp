@@ -14,6 +14,7 @@
 #include "snir/ir/Literal.hpp"
 #include "snir/ir/Module.hpp"
 #include "snir/ir/Operands.hpp"
+#include "snir/ir/Phi.hpp"
 #include "snir/ir/Registry.hpp"
 #include "snir/ir/Result.hpp"
 #include "snir/ir/Type.hpp"
@@ -31,24 +32,22 @@
 
 namespace snir {
 
-Parser::Parser(Registry& registry) : _registry{&registry} {}
+Parser::Parser(Registry& registry) : _module{&registry} {}
 
-auto Parser::read(std::string_view source) -> Module
+auto Parser::read(std::string_view source, FunctionStorage storage) -> Module
 {
-    auto module = Module{*_registry};
+    auto module = Module{*_module, storage};
 
     for (auto match :
          ctre::search_all<R"(define\s+(\w+)\s+@(\w+)\(([^)]*)\)\s*\{([^}]*)\})">(source)) {
         _locals.clear();
 
-        auto func = Function::create(*_registry, parseType(match.get<1>()));
-        func.identifier(match.get<2>());
+        auto func = module.create(match.get<2>(), parseType(match.get<1>()));
+        _registry = func.asValue().registry();
         func.asValue().emplace<FunctionDefinition>(
             readArguments(match.get<3>()),
             readBlocks(match.get<4>())
         );
-
-        module.functions().push_back(func);
     }
 
     return module;
@@ -91,6 +90,10 @@ auto Parser::readInst(std::string_view source) -> std::optional<ValueId>
         return inst;
     }
 
+    if (auto const inst = readPhiInst(source); inst) {
+        return inst;
+    }
+
     if (strings::contains(source, "; nop")) {
         return Instruction::create(*_registry, InstKind::Nop, Type::Void);
     }
@@ -149,7 +152,7 @@ auto Parser::readBinaryInst(std::string_view source) -> std::optional<ValueId>
 
         auto inst = Instruction::create(*_registry, kind, type);
         inst.asValue().emplace<Result>(result);
-        inst.asValue().emplace<Operands>(InplaceVector<ValueId, 2>{lhs, rhs});
+        inst.operands(Operands{InplaceVector<ValueId, 2>{lhs, rhs}});
         return inst;
     }
 
@@ -170,7 +173,7 @@ auto Parser::readIntCmpInst(std::string_view source) -> std::optional<ValueId>
         auto inst = Instruction::create(*_registry, InstKind::IntCmp, type);
         inst.asValue().emplace<Result>(result);
         inst.asValue().emplace<CompareKind>(cmp);
-        inst.asValue().emplace<Operands>(InplaceVector<ValueId, 2>{lhs, rhs});
+        inst.operands(Operands{InplaceVector<ValueId, 2>{lhs, rhs}});
         return inst;
     }
 
@@ -187,7 +190,7 @@ auto Parser::readTruncInst(std::string_view source) -> std::optional<ValueId>
 
         auto inst = Instruction::create(*_registry, InstKind::Trunc, type);
         inst.asValue().emplace<Result>(result);
-        inst.asValue().emplace<Operands>(InplaceVector<ValueId, 2>{value});
+        inst.operands(Operands{InplaceVector<ValueId, 2>{value}});
         return inst;
     }
 
@@ -202,14 +205,14 @@ auto Parser::readReturnInst(std::string_view source) -> std::optional<ValueId>
         auto const operand         = getOrCreateLocal(opSrc, ValueKind::Register);
 
         auto ret = Instruction::create(*_registry, InstKind::Return, type);
-        ret.asValue().emplace<Operands>(InplaceVector<ValueId, 2>{operand});
+        ret.operands(Operands{InplaceVector<ValueId, 2>{operand}});
         return ret;
     }
 
     if (auto match = ctre::match<R"(ret\s+(\w+))">(source); match) {
         if (match.get<1>() == "void") {
             auto ret = Instruction::create(*_registry, InstKind::Return, Type::Void);
-            ret.asValue().emplace<Operands>();
+            ret.operands(Operands{});
             return ret;
         }
     }
@@ -223,8 +226,8 @@ auto Parser::readBranchInst(std::string_view source) -> std::optional<ValueId>
         auto const iftrue = getOrCreateLocal(m.get<1>().view().substr(1), ValueKind::Label);
 
         auto br = Instruction::create(*_registry, InstKind::Branch, Type::Bool);
-        br.asValue().emplace<Operands>();
-        br.asValue().emplace<Branch>(iftrue, std::nullopt, std::nullopt);
+        br.operands(Operands{});
+        br.branch(Branch{iftrue, std::nullopt, std::nullopt});
         return br;
     }
 
@@ -234,8 +237,8 @@ auto Parser::readBranchInst(std::string_view source) -> std::optional<ValueId>
         auto const iffalse   = getOrCreateLocal(m.get<3>(), ValueKind::Label);
 
         auto br = Instruction::create(*_registry, InstKind::Branch, Type::Bool);
-        br.asValue().emplace<Operands>();
-        br.asValue().emplace<Branch>(iftrue, iffalse, condition);
+        br.operands(Operands{});
+        br.branch(Branch{iftrue, iffalse, condition});
         return br;
     }
 
@@ -258,18 +261,44 @@ auto Parser::readConstInst(std::string_view source) -> std::optional<ValueId>
     return std::nullopt;
 }
 
+auto Parser::readPhiInst(std::string_view source) -> std::optional<ValueId>
+{
+    // %3 = phi i64 [ %1, %0 ], [ %2, %4 ]
+    if (auto match = ctre::match<R"(%(\d+)\s+=\s+phi\s+(\w+)\s+(\[.*\]))">(source); match) {
+        auto const result = getOrCreateLocal(match.get<1>(), ValueKind::Register);
+        auto const type   = parseType(match.get<2>());
+        auto const list   = match.get<3>().view();
+
+        auto phi = Phi{};
+        for (auto in : ctre::search_all<R"(\[\s*%(\d+),\s*%(\d+)\s*\])">(list)) {
+            auto const value = getOrCreateLocal(in.get<1>(), ValueKind::Register);
+            auto const block = getOrCreateLocal(in.get<2>(), ValueKind::Label);
+            phi.incoming.push_back(Phi::Incoming{.value = value, .block = block});
+        }
+
+        auto inst = Instruction::create(*_registry, InstKind::Phi, type);
+        inst.asValue().emplace<Result>(result);
+        inst.phi(std::move(phi));
+        return inst;
+    }
+
+    return std::nullopt;
+}
+
 auto Parser::getOrCreateLocal(std::string_view token, ValueKind kind) -> Value
 {
     if (token.starts_with('%') or token.starts_with('@')) {
         raisef<std::runtime_error>("invalid token prefix '{}' for value", token);
     }
 
-    if (auto found = _locals.find(token); found != _locals.end()) {
+    // Keyed on the interned name, the source doesn't have to outlive the parser.
+    auto const symbol = symbols(*_module).intern(token);
+    if (auto found = _locals.find(symbol); found != _locals.end()) {
         return Value{*_registry, found->second};
     }
 
     auto val = createValue(*_registry, kind);
-    _locals.emplace(token, val);
+    _locals.emplace(symbol, val);
     return val;
 }
 
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "snir/core/StringPool.hpp"
 #include "snir/ir/BasicBlock.hpp"
 #include "snir/ir/Module.hpp"
 #include "snir/ir/Registry.hpp"
@@ -7,9 +8,9 @@
 #include "snir/ir/Value.hpp"
 #include "snir/ir/ValueKind.hpp"
 
-#include <map>
 #include <optional>
 #include <string_view>
+#include <unordered_map>
 
 namespace snir {
 
@@ -17,7 +18,12 @@ struct Parser
 {
     explicit Parser(Registry& registry);
 
-    [[nodiscard]] auto read(std::string_view source) -> Module;
+    /// \brief With isolated storage every function gets a registry of its
+    /// own, the registry passed to the parser holds the module level values.
+    [[nodiscard]] auto read(
+        std::string_view source,
+        FunctionStorage storage = FunctionStorage::Shared
+    ) -> Module;
 
 private:
     [[nodiscard]] auto readArguments(std::string_view source) -> std::vector<ValueId>;
@@ -29,11 +35,13 @@ private:
     [[nodiscard]] auto readReturnInst(std::string_view source) -> std::optional<ValueId>;
     [[nodiscard]] auto readBranchInst(std::string_view source) -> std::optional<ValueId>;
     [[nodiscard]] auto readConstInst(std::string_view source) -> std::optional<ValueId>;
+    [[nodiscard]] auto readPhiInst(std::string_view source) -> std::optional<ValueId>;
 
     [[nodiscard]] auto getOrCreateLocal(std::string_view token, ValueKind kind) -> Value;
 
+    Registry* _module{nullptr};
     Registry* _registry{nullptr};
-    std::map<std::string_view, ValueId> _locals;
+    std::unordered_map<Symbol, ValueId> _locals;
 };
 
 }  // namespace snir
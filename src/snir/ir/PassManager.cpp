@@ -3,6 +3,7 @@
 #include "snir/ir/AnalysisManager.hpp"
 #include "snir/ir/Function.hpp"
 #include "snir/ir/Module.hpp"
+#include "snir/ir/Registry.hpp"
 
 #include "fmt/ostream.h"
 
@@ -16,8 +17,7 @@ PassManager::PassManager(bool log, std::ostream& out) : _out{out}, _log{log} {}
 
 auto PassManager::operator()(Module& m) -> void
 {
-    for (auto& funcId : m.functions()) {
-        auto func = Function(Value{m.registry(), funcId});
+    for (auto& func : m.functions()) {
         std::invoke(*this, func, _analysis);
     }
 }
@@ -27,6 +27,7 @@ auto PassManager::operator()(Function& func, AnalysisManager<Function>& analysis
     for (auto& pass : _passes) {
         auto const start = std::chrono::steady_clock::now();
         pass->run(func, analysis);
+        touch(*func.asValue().registry());
         auto const stop  = std::chrono::steady_clock::now();
         auto const delta = std::chrono::duration_cast<std::chrono::microseconds>(stop - start);
         if (_log) {
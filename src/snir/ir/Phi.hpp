@@ -0,0 +1,20 @@
+#pragma once
+
+#include "snir/ir/ValueId.hpp"
+
+#include <vector>
+
+namespace snir {
+
+struct Phi
+{
+    struct Incoming
+    {
+        ValueId value{};
+        ValueId block{};
+    };
+
+    std::vector<Incoming> incoming;
+};
+
+}  // namespace snir
@@ -6,12 +6,14 @@
 #include "snir/ir/CompareKind.hpp"
 #include "snir/ir/Function.hpp"
 #include "snir/ir/FunctionDefinition.hpp"
+#include "snir/ir/Groups.hpp"
 #include "snir/ir/Identifier.hpp"
 #include "snir/ir/InstKind.hpp"
 #include "snir/ir/Literal.hpp"
 #include "snir/ir/Module.hpp"
 #include "snir/ir/Operands.hpp"
 #include "snir/ir/pass/ControlFlowGraph.hpp"
+#include "snir/ir/Phi.hpp"
 #include "snir/ir/Result.hpp"
 #include "snir/ir/Type.hpp"
 #include "snir/ir/Value.hpp"
@@ -51,11 +53,8 @@ Printer::Printer(std::ostream& out) : _out{out} {}
 
 auto Printer::operator()(Module& module) -> void
 {
-    auto& reg  = module.registry();
     auto dummy = AnalysisManager<Function>{};
-
-    for (auto funcId : module.functions()) {
-        auto func = Function(Value{reg, funcId});
+    for (auto func : module.functions()) {
         (*this)(func, dummy);
     }
 }
@@ -74,7 +73,7 @@ auto Printer::printFunction(Function& func) -> void
 
     auto const [type, identifier, def] = view.get(func.asValue());
 
-    fmt::print(_out, "define {} @{}", type, identifier.text);
+    fmt::print(_out, "define {} @{}", type, symbols(reg).text(identifier.symbol));
     printFunctionArgs(func);
 
     fmt::println(_out, " {{");
@@ -111,11 +110,13 @@ auto Printer::printBasicBlock(Function& func, BasicBlock const& block) -> void
 {
     auto& reg      = *func.asValue().registry();
     auto common    = reg.view<InstKind, Type>();
+    auto insts     = instructionGroup(reg);
+    auto consts    = literalGroup(reg);
+    auto branches  = branchGroup(reg);
     auto result    = reg.view<Result>();
     auto operands  = reg.view<Operands>();
     auto compare   = reg.view<CompareKind>();
-    auto literal   = reg.view<Literal>();
-    auto branch    = reg.view<Branch>();
+    auto phi       = reg.view<Phi>();
     auto valueKind = reg.view<ValueKind>();
 
     auto formatValue = [&](ValueId val) {
@@ -146,9 +147,8 @@ auto Printer::printBasicBlock(Function& func, BasicBlock const& block) -> void
                 break;
             }
             case InstKind::Const: {
-                auto const [id]    = result.get(inst);
-                auto const res     = formatValue(id.id);
-                auto const [value] = literal.get(inst);
+                auto const [id, value] = read<Result, Literal>(consts, reg, inst);
+                auto const res         = formatValue(id.id);
                 fmt::println(_out, "  {} = {} {}", res, type, value);
                 break;
             }
@@ -163,15 +163,29 @@ auto Printer::printBasicBlock(Function& func, BasicBlock const& block) -> void
                 break;
             }
             case InstKind::Branch: {
-                auto [br] = branch.get(inst);
+                auto const& br = read<Branch>(branches, reg, inst);
                 if (not br.condition) {
                     fmt::println(_out, "  {} label %{}", kind, _localIds.add(br.iftrue));
                 } else {
+                    auto const cond  = formatValue(*br.condition);
+                    auto const then  = _localIds.add(br.iftrue);
+                    auto const other = _localIds.add(br.iffalse.value());
+                    fmt::println(_out, "  {} i1 {}, label %{}, label %{}", kind, cond, then, other);
                 }
                 break;
             }
             case InstKind::Phi: {
-                fmt::println(_out, "  {} ", kind);
+                auto const [id] = result.get(inst);
+                auto const [in] = phi.get(inst);
+                auto const res  = formatValue(id.id);
+                fmt::print(_out, "  {} = {} {} ", res, kind, type);
+                for (auto i = 0zu; i < in.incoming.size(); ++i) {
+                    auto const& incoming = in.incoming[i];
+                    auto const value     = formatValue(incoming.value);
+                    auto const label     = _localIds.add(incoming.block);
+                    fmt::print(_out, "{}[ {}, %{} ]", i == 0 ? "" : ", ", value, label);
+                }
+                fmt::println(_out, "");
                 break;
             }
             case InstKind::Add:
@@ -188,30 +202,27 @@ auto Printer::printBasicBlock(Function& func, BasicBlock const& block) -> void
             case InstKind::FloatSub:
             case InstKind::FloatMul:
             case InstKind::FloatDiv: {
-                auto const [id]   = result.get(inst);
-                auto const [args] = operands.get(inst);
-                auto const res    = formatValue(id.id);
-                auto const lhs    = formatValue(args.list[0]);
-                auto const rhs    = formatValue(args.list[1]);
+                auto const [id, args] = read<Result, Operands>(insts, reg, inst);
+                auto const res        = formatValue(id.id);
+                auto const lhs        = formatValue(args.list[0]);
+                auto const rhs        = formatValue(args.list[1]);
                 fmt::println(_out, "  {} = {} {} {}, {}", res, kind, type, lhs, rhs);
                 break;
             }
 
             case InstKind::IntCmp: {
-                auto const [id]   = result.get(inst);
-                auto const [args] = operands.get(inst);
-                auto const res    = formatValue(id.id);
-                auto const [cmp]  = compare.get(inst);
-                auto const lhs    = formatValue(args.list[0]);
-                auto const rhs    = formatValue(args.list[1]);
+                auto const [id, args] = read<Result, Operands>(insts, reg, inst);
+                auto const res        = formatValue(id.id);
+                auto const [cmp]      = compare.get(inst);
+                auto const lhs        = formatValue(args.list[0]);
+                auto const rhs        = formatValue(args.list[1]);
                 fmt::println(_out, "  {} = {} {} {} {}, {}", res, kind, cmp, type, lhs, rhs);
                 break;
             }
             case InstKind::Trunc: {
-                auto const [id]   = result.get(inst);
-                auto const [args] = operands.get(inst);
-                auto const res    = formatValue(id.id);
-                auto const value  = formatValue(args.list[0]);
+                auto const [id, args] = read<Result, Operands>(insts, reg, inst);
+                auto const res        = formatValue(id.id);
+                auto const value      = formatValue(args.list[0]);
                 fmt::println(_out, "  {} = {} {} to {}", res, kind, value, type);
                 break;
             }
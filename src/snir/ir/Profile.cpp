@@ -0,0 +1,174 @@
+#include "Profile.hpp"
+
+#include "snir/ir/BasicBlock.hpp"
+#include "snir/ir/Bytecode.hpp"
+#include "snir/ir/Function.hpp"
+#include "snir/ir/InstKind.hpp"
+#include "snir/ir/OpCode.hpp"
+#include "snir/ir/Registry.hpp"
+
+#include "fmt/format.h"
+#include "fmt/os.h"
+#include "fmt/ostream.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace snir {
+
+namespace {
+
+[[nodiscard]] auto jsonString(std::string_view text) -> std::string
+{
+    auto result = std::string{"\""};
+    for (auto const c : text) {
+        if (c == '"' or c == '\\') {
+            result.push_back('\\');
+        }
+        result.push_back(c);
+    }
+    result.push_back('"');
+    return result;
+}
+
+}  // namespace
+
+FunctionProfile::FunctionProfile(Function const& func, Bytecode const& code)
+    : identifier{func.identifier()}
+    , labels{code.labels}
+    , blockAt(code.code.size(), -1)
+    , instructions(code.code.size(), 0U)
+{
+    auto const* registry = func.asValue().registry();
+    for (auto const& block : func.basicBlocks()) {
+        auto& kinds = blocks.emplace_back();
+        for (auto const inst : block.instructions) {
+            kinds.push_back(registry->get<InstKind>(inst));
+        }
+    }
+
+    for (auto i = 0zu; i < labels.size(); ++i) {
+        if (labels[i] < blockAt.size()) {
+            blockAt[labels[i]] = static_cast<std::int32_t>(i);
+        }
+    }
+
+    ops.reserve(code.code.size());
+    for (auto const& inst : code.code) {
+        ops.push_back(inst.op);
+    }
+}
+
+auto FunctionProfile::block(std::size_t index) const -> std::uint64_t
+{
+    auto const pc = labels.at(index);
+    return pc < instructions.size() ? instructions[pc] : 0U;
+}
+
+auto FunctionProfile::kinds() const -> std::map<InstKind, std::uint64_t>
+{
+    auto result = std::map<InstKind, std::uint64_t>{};
+    for (auto i = 0zu; i < blocks.size(); ++i) {
+        for (auto const kind : blocks[i]) {
+            result[kind] += block(i);
+        }
+    }
+    return result;
+}
+
+auto Profile::function(Function const& func, Bytecode const& code) -> FunctionProfile&
+{
+    auto const found = _functions.find(func.identifier());
+    if (found != _functions.end()) {
+        return found->second;
+    }
+
+    auto profile = FunctionProfile{func, code};
+    auto name    = profile.identifier;
+    return _functions.emplace(std::move(name), std::move(profile)).first->second;
+}
+
+auto Profile::hotBlocks(std::size_t count) const -> std::vector<HotBlock>
+{
+    auto result = std::vector<HotBlock>{};
+    for (auto const& [identifier, func] : _functions) {
+        for (auto i = 0zu; i < func.blocks.size(); ++i) {
+            result.push_back(HotBlock{.identifier = identifier, .block = i, .count = func.block(i)});
+        }
+    }
+
+    std::ranges::stable_sort(result, std::ranges::greater{}, &HotBlock::count);
+    result.resize(std::min(count, result.size()));
+    return result;
+}
+
+auto Profile::writeText(std::ostream& out) const -> void
+{
+    for (auto const& [identifier, func] : _functions) {
+        fmt::println(out, "function {}", identifier);
+        for (auto i = 0zu; i < func.blocks.size(); ++i) {
+            fmt::println(out, "  block {}: {}", i, func.block(i));
+        }
+        for (auto const& [edge, count] : func.edges) {
+            fmt::println(out, "  edge {} -> {}: {}", edge.first, edge.second, count);
+        }
+        for (auto const& [kind, count] : func.kinds()) {
+            fmt::println(out, "  kind {}: {}", kind, count);
+        }
+        for (auto i = 0zu; i < func.blocks.size(); ++i) {
+            for (auto j = 0zu; j < func.blocks[i].size(); ++j) {
+                fmt::println(out, "  inst {}.{} {}: {}", i, j, func.blocks[i][j], func.block(i));
+            }
+        }
+        for (auto pc = 0zu; pc < func.ops.size(); ++pc) {
+            fmt::println(out, "  pc {} {}: {}", pc, func.ops[pc], func.instructions[pc]);
+        }
+    }
+}
+
+auto Profile::writeJson(std::ostream& out) const -> void
+{
+    fmt::print(out, "{{\"functions\": [");
+    auto separator = std::string_view{};
+    for (auto const& [identifier, func] : _functions) {
+        auto const name = jsonString(identifier);
+        fmt::print(out, "{}\n  {{\"identifier\": {}, \"blocks\": [", separator, name);
+        for (auto i = 0zu; i < func.blocks.size(); ++i) {
+            fmt::print(out, "{}{}", i == 0 ? "" : ", ", func.block(i));
+        }
+
+        fmt::print(out, "], \"edges\": [");
+        auto comma = std::string_view{};
+        for (auto const& [edge, count] : func.edges) {
+            auto const [from, to] = edge;
+            fmt::print(out, "{}{{\"from\": {}, \"to\": {}, \"count\": {}}}", comma, from, to, count);
+            comma = ", ";
+        }
+
+        fmt::print(out, "], \"kinds\": {{");
+        comma = {};
+        for (auto const& [kind, count] : func.kinds()) {
+            fmt::print(out, "{}{}: {}", comma, jsonString(fmt::format("{}", kind)), count);
+            comma = ", ";
+        }
+
+        fmt::print(out, "}}, \"bytecode\": [");
+        for (auto pc = 0zu; pc < func.ops.size(); ++pc) {
+            auto const op    = jsonString(fmt::format("{}", func.ops[pc]));
+            auto const count = func.instructions[pc];
+            fmt::print(out, "{}{{\"op\": {}, \"count\": {}}}", pc == 0 ? "" : ", ", op, count);
+        }
+        fmt::print(out, "]}}");
+        separator = ",";
+    }
+    fmt::println(out, "\n]}}");
+}
+
+}  // namespace snir
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "snir/ir/Bytecode.hpp"
+#include "snir/ir/Function.hpp"
+#include "snir/ir/InstKind.hpp"
+#include "snir/ir/OpCode.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace snir {
+
+/// \brief Execution counts of one function, blocks are numbered in the
+/// order of Function::basicBlocks().
+///
+/// The interpreter only counts bytecode instructions and taken edges.
+/// Every instruction of a block runs as often as the block, so block,
+/// instruction and InstKind counts are derived from these.
+struct FunctionProfile
+{
+    FunctionProfile() = default;
+    FunctionProfile(Function const& func, Bytecode const& code);
+
+    /// Executions of the block with the given number.
+    [[nodiscard]] auto block(std::size_t index) const -> std::uint64_t;
+
+    /// Executions per InstKind, summed over all blocks.
+    [[nodiscard]] auto kinds() const -> std::map<InstKind, std::uint64_t>;
+
+    std::string identifier;
+    std::vector<std::vector<InstKind>> blocks;
+    std::vector<std::uint32_t> labels;
+    std::vector<std::int32_t> blockAt;  ///< Block starting at each pc or -1.
+    std::vector<OpCode> ops;
+    std::vector<std::uint64_t> instructions;
+    std::map<std::pair<std::uint32_t, std::uint32_t>, std::uint64_t> edges;
+};
+
+/// \brief Execution counts collected by the interpreter, keyed by function
+/// identifier. Needs a build with SNIR_PROFILE.
+struct Profile
+{
+    struct HotBlock
+    {
+        std::string_view identifier;
+        std::size_t block{0};
+        std::uint64_t count{0};
+    };
+
+    Profile() = default;
+
+    /// Counters for func, created on first use for the given code.
+    [[nodiscard]] auto function(Function const& func, Bytecode const& code) -> FunctionProfile&;
+
+    [[nodiscard]] auto functions() const -> std::map<std::string, FunctionProfile, std::less<>> const&
+    {
+        return _functions;
+    }
+
+    /// The most executed blocks of all functions, hottest first.
+    [[nodiscard]] auto hotBlocks(std::size_t count) const -> std::vector<HotBlock>;
+
+    auto writeText(std::ostream& out) const -> void;
+    auto writeJson(std::ostream& out) const -> void;
+
+private:
+    std::map<std::string, FunctionProfile, std::less<>> _functions;
+};
+
+}  // namespace snir
@@ -4,8 +4,41 @@
 
 #include <entt/entity/registry.hpp>
 
+#include <cstdint>
+
 namespace snir {
 
 using Registry = entt::registry;
 
+/// \brief Counts how often the ids of a registry were renumbered, see
+/// Module::compact. Anything keyed by ValueId outside of the registry has to
+/// include it to tell the old ids from the new ones.
+enum struct Generation : std::uint32_t
+{
+};
+
+[[nodiscard]] inline auto generation(Registry const& reg) -> Generation
+{
+    auto const* gen = reg.ctx().find<Generation>();
+    return gen != nullptr ? *gen : Generation{};
+}
+
+/// \brief Counts the changes to the IR of a registry. PassManager bumps it
+/// after every pass, call touch() after editing functions directly. Caches
+/// of compiled code compare it to tell stale entries.
+enum struct Revision : std::uint32_t
+{
+};
+
+[[nodiscard]] inline auto revision(Registry const& reg) -> Revision
+{
+    auto const* rev = reg.ctx().find<Revision>();
+    return rev != nullptr ? *rev : Revision{};
+}
+
+inline auto touch(Registry& reg) -> void
+{
+    reg.ctx().insert_or_assign(Revision{static_cast<std::uint32_t>(revision(reg)) + 1});
+}
+
 }  // namespace snir
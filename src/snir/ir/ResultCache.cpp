@@ -0,0 +1,112 @@
+#include "ResultCache.hpp"
+
+#include "snir/ir/Bytecode.hpp"
+#include "snir/ir/Function.hpp"
+#include "snir/ir/Literal.hpp"
+#include "snir/ir/Registry.hpp"
+#include "snir/ir/Type.hpp"
+
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <optional>
+#include <span>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace snir {
+
+ResultCache::ResultCache(std::size_t maxBytes) : _maxBytes{maxBytes} {}
+
+auto ResultCache::find(Function const& func, std::span<Literal const> args)
+    -> std::optional<Literal>
+{
+    auto const found = _index.find(makeKey(func, args));
+    if (found == _index.end()) {
+        ++_stats.misses;
+        return std::nullopt;
+    }
+
+    ++_stats.hits;
+    _entries.splice(_entries.begin(), _entries, found->second);
+    return found->second->result;
+}
+
+auto ResultCache::insert(Function const& func, std::span<Literal const> args, Literal result)
+    -> void
+{
+    auto key        = makeKey(func, args);
+    auto const size = sizeOf(key);
+    if (size > _maxBytes or _index.contains(key)) {
+        return;
+    }
+
+    while (_bytes + size > _maxBytes) {
+        auto const& last = _entries.back();
+        _bytes -= sizeOf(last.key);
+        _index.erase(last.key);
+        _entries.pop_back();
+        ++_stats.evictions;
+    }
+
+    _entries.push_front(Entry{.key = std::move(key), .result = result});
+    _index.emplace(_entries.front().key, _entries.begin());
+    _bytes += size;
+}
+
+auto ResultCache::clear() -> void
+{
+    _entries.clear();
+    _index.clear();
+    _bytes = 0;
+}
+
+auto ResultCache::KeyHash::operator()(Key const& key) const noexcept -> std::size_t
+{
+    auto hash    = std::hash<Registry const*>{}(key.registry);
+    auto combine = [&hash](std::size_t value) {
+        hash ^= value + 0x9e3779b97f4a7c15U + (hash << 6U) + (hash >> 2U);
+    };
+
+    combine(std::hash<Generation>{}(key.generation));
+    combine(std::hash<ValueId>{}(key.func));
+    for (auto const arg : key.args) {
+        combine(std::hash<Type>{}(arg.type));
+        combine(std::hash<Slot>{}(arg.bits));
+    }
+    return hash;
+}
+
+// The type of each argument is part of the key, a call with literals of
+// the wrong type has to miss and fail in Interpreter::load instead of
+// returning the result of the bit-equal call. NaNs compare equal by their
+// bits.
+auto ResultCache::makeKey(Function const& func, std::span<Literal const> args) -> Key
+{
+    static constexpr auto types = std::array{Type::Bool, Type::Int64, Type::Float, Type::Double};
+    static_assert(types.size() == std::variant_size_v<decltype(Literal::value)>);
+
+    auto const* reg = func.asValue().registry();
+    auto key        = Key{.registry = reg, .generation = generation(*reg), .func = func, .args = {}};
+    auto literal    = [](auto value) { return toSlot(value); };
+    key.args.reserve(args.size());
+    for (auto const& arg : args) {
+        key.args.push_back(Argument{
+            .type = types.at(arg.value.index()),
+            .bits = std::visit(literal, arg.value),
+        });
+    }
+    return key;
+}
+
+// Estimate of the heap memory of one entry: the list node, the index
+// node with its copy of the key and both argument vectors.
+auto ResultCache::sizeOf(Key const& key) -> std::size_t
+{
+    auto const node  = sizeof(Entry) + 2U * sizeof(void*);
+    auto const index = sizeof(Key) + sizeof(Iterator) + 2U * sizeof(void*);
+    return node + index + 2U * key.args.size() * sizeof(Argument);
+}
+
+}  // namespace snir
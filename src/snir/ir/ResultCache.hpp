@@ -0,0 +1,92 @@
+#pragma once
+
+#include "snir/ir/Bytecode.hpp"
+#include "snir/ir/Function.hpp"
+#include "snir/ir/Literal.hpp"
+#include "snir/ir/Registry.hpp"
+#include "snir/ir/Type.hpp"
+#include "snir/ir/ValueId.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <optional>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+namespace snir {
+
+/// \brief Bounded LRU of function results keyed by the argument tuple.
+///
+/// Functions are pure, so a result only depends on the function and its
+/// arguments. Entries are dropped least recently used first once their
+/// estimated size exceeds the memory cap. Call clear() after changing a
+/// function that has cached results. Keys include the generation of the
+/// registry, entries from before a Module::compact are never hit again and
+/// age out.
+struct ResultCache
+{
+    struct Stats
+    {
+        std::uint64_t hits{0};
+        std::uint64_t misses{0};
+        std::uint64_t evictions{0};
+    };
+
+    explicit ResultCache(std::size_t maxBytes);
+
+    [[nodiscard]] auto find(Function const& func, std::span<Literal const> args)
+        -> std::optional<Literal>;
+    auto insert(Function const& func, std::span<Literal const> args, Literal result) -> void;
+    auto clear() -> void;
+
+    [[nodiscard]] auto stats() const noexcept -> Stats const& { return _stats; }
+    [[nodiscard]] auto size() const noexcept -> std::size_t { return _entries.size(); }
+    [[nodiscard]] auto bytes() const noexcept -> std::size_t { return _bytes; }
+    [[nodiscard]] auto maxBytes() const noexcept -> std::size_t { return _maxBytes; }
+
+private:
+    // Literals of different types may share their bits, e.g. 0 and 0.0.
+    struct Argument
+    {
+        Type type{};
+        Slot bits{};
+
+        [[nodiscard]] auto operator==(Argument const& other) const -> bool = default;
+    };
+
+    struct Key
+    {
+        Registry const* registry{nullptr};
+        Generation generation{};
+        ValueId func{};
+        std::vector<Argument> args;
+
+        [[nodiscard]] auto operator==(Key const& other) const -> bool = default;
+    };
+
+    struct KeyHash
+    {
+        [[nodiscard]] auto operator()(Key const& key) const noexcept -> std::size_t;
+    };
+
+    struct Entry
+    {
+        Key key;
+        Literal result;
+    };
+
+    using Iterator = std::list<Entry>::iterator;
+
+    [[nodiscard]] static auto makeKey(Function const& func, std::span<Literal const> args) -> Key;
+    [[nodiscard]] static auto sizeOf(Key const& key) -> std::size_t;
+
+    std::list<Entry> _entries;  // most recently used first
+    std::unordered_map<Key, Iterator, KeyHash> _index;
+    std::size_t _bytes{0};
+    std::size_t _maxBytes;
+    Stats _stats;
+};
+
+}  // namespace snir
@@ -0,0 +1,249 @@
+#include "Scheduler.hpp"
+
+#include "snir/core/Exception.hpp"
+#include "snir/ir/Bytecode.hpp"
+#include "snir/ir/Interpreter.hpp"
+#include "snir/ir/Literal.hpp"
+
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <map>
+#include <new>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace snir {
+
+namespace {
+
+// Released coroutine frames by size, kept until the thread exits.
+struct FrameRecycler
+{
+    FrameRecycler() = default;
+
+    FrameRecycler(FrameRecycler const& other)                    = delete;
+    FrameRecycler(FrameRecycler&& other)                         = delete;
+    auto operator=(FrameRecycler const& other) -> FrameRecycler& = delete;
+    auto operator=(FrameRecycler&& other) -> FrameRecycler&      = delete;
+
+    ~FrameRecycler()
+    {
+        for (auto& [size, blocks] : free) {
+            for (auto* block : blocks) {
+                ::operator delete(block, size);
+            }
+        }
+    }
+
+    std::map<std::size_t, std::vector<void*>> free;
+};
+
+[[nodiscard]] auto recycler() -> FrameRecycler&
+{
+    thread_local auto instance = FrameRecycler{};
+    return instance;
+}
+
+}  // namespace
+
+auto FramePool::acquire(std::size_t size) -> std::vector<Slot>
+{
+    if (_free.empty()) {
+        return std::vector<Slot>(size, Slot{0});
+    }
+
+    auto frame = std::move(_free.back());
+    _free.pop_back();
+    frame.assign(size, Slot{0});
+    return frame;
+}
+
+auto FramePool::release(std::vector<Slot> frame) -> void { _free.push_back(std::move(frame)); }
+
+auto Execution::promise_type::operator new(std::size_t size) -> void*
+{
+    auto& blocks = recycler().free[size];
+    if (blocks.empty()) {
+        return ::operator new(size);
+    }
+
+    auto* block = blocks.back();
+    blocks.pop_back();
+    return block;
+}
+
+auto Execution::promise_type::operator delete(void* ptr, std::size_t size) noexcept -> void
+{
+    try {
+        recycler().free[size].push_back(ptr);
+    } catch (std::bad_alloc const&) {
+        ::operator delete(ptr, size);
+    }
+}
+
+auto Execution::promise_type::get_return_object() -> Execution
+{
+    return Execution{std::coroutine_handle<promise_type>::from_promise(*this)};
+}
+
+auto Execution::start(
+    Bytecode const& code,
+    std::vector<Slot> frame,
+    Interpreter::Slice slice,
+    FramePool& pool
+) -> Execution
+{
+    auto pc = std::uint32_t{0};
+    while (true) {
+        auto result = std::optional<Slot>{};
+        try {
+            result = Interpreter::resume(code, frame, pc, slice);
+        } catch (...) {
+            pool.release(std::move(frame));
+            throw;
+        }
+
+        if (result.has_value()) {
+            pool.release(std::move(frame));
+            co_return toLiteral(*result, code.type);
+        }
+        co_await std::suspend_always{};
+    }
+}
+
+Execution::Execution(Execution&& other) noexcept : _handle{std::exchange(other._handle, nullptr)} {}
+
+Execution::~Execution()
+{
+    if (_handle) {
+        _handle.destroy();
+    }
+}
+
+auto Execution::operator=(Execution&& other) noexcept -> Execution&
+{
+    auto tmp = std::move(other);
+    std::swap(_handle, tmp._handle);
+    return *this;
+}
+
+auto Execution::result() const -> std::optional<Literal>
+{
+    if (not done()) {
+        raisef<std::logic_error>("execution has not finished");
+    }
+    if (auto const& error = _handle.promise().error; error) {
+        std::rethrow_exception(error);
+    }
+    return _handle.promise().result;
+}
+
+Scheduler::Scheduler(Interpreter::Slice slice) : _slice{slice}
+{
+    // Executions would never make progress and run() would spin forever.
+    if (_slice.instructions == 0) {
+        raisef<std::invalid_argument>("slice has to run at least one instruction");
+    }
+}
+
+auto Scheduler::spawn(Bytecode const& code, std::span<Literal const> args) -> Ticket
+{
+    if (code.arguments.size() != args.size()) {
+        raisef<std::invalid_argument>("expected {} arguments", code.arguments.size());
+    }
+
+    auto frame = _pool.acquire(code.registers);
+    for (auto i = 0zu; i < args.size(); ++i) {
+        frame[i] = toSlot(args[i], code.arguments[i]);
+    }
+
+    auto ticket = Ticket{};
+    if (_freeTickets.empty()) {
+        ticket.index = static_cast<std::uint32_t>(_outcomes.size());
+        _outcomes.emplace_back();
+    } else {
+        ticket.index = _freeTickets.back();
+        _freeTickets.pop_back();
+    }
+    ticket.version = _outcomes[ticket.index].version;
+
+    _ready.push_back(Task{
+        .ticket    = ticket,
+        .execution = Execution::start(code, std::move(frame), _slice, _pool),
+    });
+    return ticket;
+}
+
+auto Scheduler::step() -> bool
+{
+    if (_ready.empty()) {
+        return false;
+    }
+
+    auto task = std::move(_ready.front());
+    _ready.pop_front();
+    task.execution.resume();
+    if (not task.execution.done()) {
+        _ready.push_back(std::move(task));
+        return true;
+    }
+
+    auto& outcome = _outcomes[task.ticket.index];
+    outcome.done  = true;
+    try {
+        outcome.value = task.execution.result();
+    } catch (...) {
+        outcome.error = std::current_exception();
+    }
+    return true;
+}
+
+auto Scheduler::run() -> void
+{
+    while (step()) {}
+}
+
+auto Scheduler::finished(Ticket ticket) const -> bool { return outcome(ticket).done; }
+
+auto Scheduler::result(Ticket ticket) const -> std::optional<Literal>
+{
+    auto const& found = outcome(ticket);
+    if (not found.done) {
+        raisef<std::logic_error>("execution {} has not finished", ticket.index);
+    }
+    if (found.error) {
+        std::rethrow_exception(found.error);
+    }
+    return found.value;
+}
+
+auto Scheduler::take(Ticket ticket) -> std::optional<Literal>
+{
+    auto const& found = outcome(ticket);
+    if (not found.done) {
+        raisef<std::logic_error>("execution {} has not finished", ticket.index);
+    }
+
+    auto taken                      = std::exchange(_outcomes[ticket.index], Outcome{});
+    _outcomes[ticket.index].version = taken.version + 1;
+    _freeTickets.push_back(ticket.index);
+    if (taken.error) {
+        std::rethrow_exception(taken.error);
+    }
+    return taken.value;
+}
+
+auto Scheduler::outcome(Ticket ticket) const -> Outcome const&
+{
+    if (ticket.index >= _outcomes.size() or _outcomes[ticket.index].version != ticket.version) {
+        raisef<std::out_of_range>("ticket {} is unknown or was taken", ticket.index);
+    }
+    return _outcomes[ticket.index];
+}
+
+}  // namespace snir
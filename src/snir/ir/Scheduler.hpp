@@ -0,0 +1,160 @@
+#pragma once
+
+#include "snir/ir/Bytecode.hpp"
+#include "snir/ir/Interpreter.hpp"
+#include "snir/ir/Literal.hpp"
+
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace snir {
+
+/// \brief Frames of finished executions, reused by the next ones instead of
+/// allocating a new frame per call.
+struct FramePool
+{
+    FramePool() = default;
+
+    [[nodiscard]] auto acquire(std::size_t size) -> std::vector<Slot>;
+    auto release(std::vector<Slot> frame) -> void;
+
+    /// Number of frames waiting for reuse.
+    [[nodiscard]] auto idle() const noexcept -> std::size_t { return _free.size(); }
+
+private:
+    std::vector<std::vector<Slot>> _free;
+};
+
+/// \brief Interpreter invocation as a coroutine. Every resume() runs one
+/// slice and suspends again, until the function returned.
+struct Execution
+{
+    struct promise_type  // NOLINT(readability-identifier-naming)
+    {
+        /// Coroutine frames are recycled per thread, they all have one size.
+        [[nodiscard]] static auto operator new(std::size_t size) -> void*;
+        static auto operator delete(void* ptr, std::size_t size) noexcept -> void;
+
+        [[nodiscard]] auto get_return_object() -> Execution;
+        [[nodiscard]] auto initial_suspend() noexcept -> std::suspend_always { return {}; }
+        [[nodiscard]] auto final_suspend() noexcept -> std::suspend_always { return {}; }
+        auto return_value(std::optional<Literal> value) -> void { result = value; }
+        auto unhandled_exception() -> void { error = std::current_exception(); }
+
+        std::optional<Literal> result;
+        std::exception_ptr error;
+    };
+
+    /// \brief Suspends before the first instruction. code and pool have to
+    /// outlive the execution, frame holds the arguments and goes back to
+    /// pool once the function returned or threw.
+    [[nodiscard]] static auto
+    start(Bytecode const& code, std::vector<Slot> frame, Interpreter::Slice slice, FramePool& pool)
+        -> Execution;
+
+    Execution(Execution const& other) = delete;
+    Execution(Execution&& other) noexcept;
+    ~Execution();
+
+    auto operator=(Execution const& other) -> Execution& = delete;
+    auto operator=(Execution&& other) noexcept -> Execution&;
+
+    [[nodiscard]] auto done() const -> bool { return _handle.done(); }
+
+    /// Runs the next slice.
+    auto resume() -> void { _handle.resume(); }
+
+    /// The return value once done, rethrows if the function failed.
+    [[nodiscard]] auto result() const -> std::optional<Literal>;
+
+private:
+    explicit Execution(std::coroutine_handle<promise_type> handle) : _handle{handle} {}
+
+    std::coroutine_handle<promise_type> _handle;
+};
+
+/// \brief Cooperative round-robin scheduler. Many executions are in flight
+/// at once, each one runs for a bounded slice before the next one is
+/// resumed, so a long running call never starves the short ones.
+struct Scheduler
+{
+    /// \brief Handle of a spawned execution. Slots are reused once their
+    /// result was taken, the version tells a stale ticket from the new one.
+    struct Ticket
+    {
+        std::uint32_t index{0};
+        std::uint32_t version{0};
+
+        [[nodiscard]] auto operator==(Ticket const& other) const -> bool = default;
+    };
+
+    /// \brief Throws if the slice doesn't run a single instruction.
+    explicit Scheduler(Interpreter::Slice slice = {});
+
+    Scheduler(Scheduler const& other)                    = delete;
+    Scheduler(Scheduler&& other)                         = delete;
+    ~Scheduler()                                         = default;
+    auto operator=(Scheduler const& other) -> Scheduler& = delete;
+    auto operator=(Scheduler&& other) -> Scheduler&      = delete;
+
+    /// \brief Queues a call of code, which has to outlive it. Nothing runs
+    /// until step() or run().
+    [[nodiscard]] auto spawn(Bytecode const& code, std::span<Literal const> args) -> Ticket;
+
+    /// Resumes the next execution for one slice, false if none is left.
+    auto step() -> bool;
+
+    /// Steps until every execution finished.
+    auto run() -> void;
+
+    /// Executions not finished yet.
+    [[nodiscard]] auto pending() const noexcept -> std::size_t { return _ready.size(); }
+
+    [[nodiscard]] auto finished(Ticket ticket) const -> bool;
+
+    /// The return value of a finished execution, rethrows if it failed.
+    [[nodiscard]] auto result(Ticket ticket) const -> std::optional<Literal>;
+
+    /// \brief Like result(), but frees the ticket for the next spawn. Until
+    /// then the outcome of every execution is kept.
+    [[nodiscard]] auto take(Ticket ticket) -> std::optional<Literal>;
+
+    /// Tickets whose result wasn't taken yet.
+    [[nodiscard]] auto tickets() const noexcept -> std::size_t
+    {
+        return _outcomes.size() - _freeTickets.size();
+    }
+
+    [[nodiscard]] auto pool() const noexcept -> FramePool const& { return _pool; }
+
+private:
+    struct Task
+    {
+        Ticket ticket;
+        Execution execution;
+    };
+
+    struct Outcome
+    {
+        std::uint32_t version{0};
+        bool done{false};
+        std::optional<Literal> value;
+        std::exception_ptr error;
+    };
+
+    [[nodiscard]] auto outcome(Ticket ticket) const -> Outcome const&;
+
+    Interpreter::Slice _slice;
+    FramePool _pool;
+    std::deque<Task> _ready;
+    std::vector<Outcome> _outcomes;
+    std::vector<std::uint32_t> _freeTickets;
+};
+
+}  // namespace snir
@@ -0,0 +1,621 @@
+#pragma once
+
+#include "snir/core/Exception.hpp"
+#include "snir/core/FixedString.hpp"
+#include "snir/ir/Bytecode.hpp"
+#include "snir/ir/InstKind.hpp"
+#include "snir/ir/Lowering.hpp"
+#include "snir/ir/OpCode.hpp"
+#include "snir/ir/Type.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace snir {
+
+/// \brief Bytecode with a fixed capacity, usable as a template argument.
+template<std::size_t N>
+struct StaticCode
+{
+    Type type{Type::Void};
+    std::array<Type, N> arguments{};
+    std::array<Bytecode::Inst, N> code{};
+    std::array<Slot, N> constants{};
+    std::array<Bytecode::Copy, N> copies{};
+    std::uint32_t numArguments{0};
+    std::uint32_t numInsts{0};
+    std::uint32_t registers{0};
+};
+
+namespace detail {
+
+[[nodiscard]] constexpr auto isWordChar(char c) -> bool
+{
+    return (c >= 'a' and c <= 'z') or (c >= 'A' and c <= 'Z') or (c >= '0' and c <= '9') or c == '_'
+        or c == '.';
+}
+
+[[nodiscard]] constexpr auto parseStaticNumber(std::string_view text) -> std::uint32_t
+{
+    auto value = std::uint32_t{0};
+    for (auto const c : text) {
+        if (c < '0' or c > '9') {
+            raisef<std::runtime_error>("invalid number '{}'", text);
+        }
+        value = value * 10U + static_cast<std::uint32_t>(c - '0');
+    }
+    return value;
+}
+
+/// \brief Tokens of one line of IR text, usable in constant evaluation.
+struct StaticLexer
+{
+    constexpr explicit StaticLexer(std::string_view text) : _text{text} {}
+
+    [[nodiscard]] constexpr auto accept(std::string_view token) -> bool
+    {
+        skipSpace();
+        if (not _text.starts_with(token)) {
+            return false;
+        }
+        _text.remove_prefix(token.size());
+        return true;
+    }
+
+    constexpr auto expect(std::string_view token) -> void
+    {
+        if (not accept(token)) {
+            raisef<std::runtime_error>("expected '{}' before '{}'", token, _text);
+        }
+    }
+
+    [[nodiscard]] constexpr auto word() -> std::string_view
+    {
+        skipSpace();
+        auto const end  = std::ranges::find_if_not(_text, isWordChar);
+        auto const size = static_cast<std::size_t>(end - _text.begin());
+        if (size == 0) {
+            raisef<std::runtime_error>("expected a word before '{}'", _text);
+        }
+
+        auto const token = _text.substr(0, size);
+        _text.remove_prefix(size);
+        return token;
+    }
+
+    /// A register or label, %N.
+    [[nodiscard]] constexpr auto local() -> std::uint32_t
+    {
+        expect("%");
+        return parseStaticNumber(word());
+    }
+
+private:
+    constexpr auto skipSpace() -> void
+    {
+        while (not _text.empty() and (_text.front() == ' ' or _text.front() == '\t')) {
+            _text.remove_prefix(1);
+        }
+    }
+
+    std::string_view _text;
+};
+
+[[nodiscard]] constexpr auto findStaticType(std::string_view name) -> std::optional<Type>
+{
+    constexpr auto types = std::array{
+#define SNIR_TYPE(Id, Name) std::pair{std::string_view{#Name}, Type::Id},
+#include "snir/ir/Type.def"
+    };
+
+    auto const found = std::ranges::find(types, name, &std::pair<std::string_view, Type>::first);
+    return found != types.end() ? std::optional{found->second} : std::nullopt;
+}
+
+[[nodiscard]] constexpr auto parseStaticType(std::string_view name) -> Type
+{
+    if (auto const type = findStaticType(name); type.has_value()) {
+        return *type;
+    }
+    raisef<std::runtime_error>("unknown type '{}'", name);
+}
+
+[[nodiscard]] constexpr auto parseStaticKind(std::string_view name) -> InstKind
+{
+    using Entry = std::pair<std::string_view, InstKind>;
+
+    constexpr auto kinds = std::array{
+#define SNIR_INST_KIND(Id, Name) Entry{std::string_view{#Name}, InstKind::Id},
+#include "snir/ir/InstKind.def"
+    };
+
+    auto const found = std::ranges::find(kinds, name, &Entry::first);
+    if (found == kinds.end()) {
+        raisef<std::runtime_error>("unknown instruction '{}'", name);
+    }
+    return found->second;
+}
+
+/// \brief Decimal literal, rounded like strtod while its digits fit into
+/// the 53 bits of a double.
+[[nodiscard]] constexpr auto parseStaticLiteral(std::string_view text, Type type) -> Slot
+{
+    auto mantissa = std::int64_t{0};
+    auto scale    = 1.0;
+    auto fraction = false;
+    for (auto const c : text) {
+        if (c == '.' and not fraction) {
+            fraction = true;
+        } else if (c >= '0' and c <= '9') {
+            mantissa = mantissa * 10 + (c - '0');
+            scale    = fraction ? scale * 10.0 : scale;
+        } else {
+            raisef<std::runtime_error>("invalid literal '{}'", text);
+        }
+    }
+
+    switch (type) {
+        case Type::Bool: return toSlot(mantissa != 0);
+        case Type::Int64: return toSlot(mantissa);
+        case Type::Float: return toSlot(static_cast<float>(static_cast<double>(mantissa) / scale));
+        case Type::Double: return toSlot(static_cast<double>(mantissa) / scale);
+        default: raisef<std::runtime_error>("unsupported type {} for literal", type);
+    }
+}
+
+/// \brief Lowers the first function of IR source to the same Bytecode as
+/// Parser and Bytecode::compile, without a registry and in constant
+/// evaluation.
+struct StaticCompiler
+{
+    constexpr explicit StaticCompiler(std::string_view source) : _source{source} {}
+
+    [[nodiscard]] constexpr auto run() -> Bytecode
+    {
+        auto const define = _source.find("define");
+        auto const open   = _source.find('{', define);
+        auto const close  = _source.find('}', open);
+        if (close == std::string_view::npos) {
+            raisef<std::runtime_error>("no function definition");
+        }
+
+        auto const header = define + std::string_view{"define"}.size();
+        readSignature(_source.substr(header, open - header));
+        readBlocks(_source.substr(open + 1U, close - open - 1U));
+        if (_blocks.empty()) {
+            raisef<std::runtime_error>("function has no basic blocks");
+        }
+
+        for (auto const& block : _blocks) {
+            _block = block.label;
+            _labels.emplace_back(block.label, pc());
+            for (auto const line : block.lines) {
+                compileLine(line);
+            }
+        }
+
+        _edges.finish(_code, [this](std::uint32_t label) { return labelPc(label); });
+        for (auto const& block : _blocks) {
+            _code.labels.push_back(labelPc(block.label));
+        }
+
+        _code.registers = static_cast<std::uint32_t>(_slots.size());
+        assignScratchSlot(_code);
+        return std::move(_code);
+    }
+
+private:
+    using Label = std::pair<std::uint32_t, std::uint32_t>;
+    using Typed = std::pair<std::uint32_t, Type>;
+
+    struct Block
+    {
+        std::uint32_t label;
+        std::vector<std::string_view> lines;
+    };
+
+    [[nodiscard]] static constexpr auto trim(std::string_view line) -> std::string_view
+    {
+        auto const first = line.find_first_not_of(" \t\r");
+        if (first == std::string_view::npos) {
+            return {};
+        }
+        return line.substr(first, line.find_last_not_of(" \t\r") - first + 1U);
+    }
+
+    constexpr auto readSignature(std::string_view header) -> void
+    {
+        auto lex   = StaticLexer{header};
+        _code.type = parseStaticType(lex.word());
+        lex.expect("@");
+        (void)lex.word();
+        lex.expect("(");
+        while (not lex.accept(")")) {
+            auto const type = parseStaticType(lex.word());
+            auto const arg  = lex.local();
+            _code.arguments.push_back(type);
+            _types.emplace_back(arg, type);
+            (void)slot(arg);
+            (void)lex.accept(",");
+        }
+    }
+
+    // Splits the body into blocks and records the type of every register.
+    constexpr auto readBlocks(std::string_view body) -> void
+    {
+        while (not body.empty()) {
+            auto const end  = std::min(body.find('\n'), body.size());
+            auto const line = trim(body.substr(0, end));
+            body.remove_prefix(std::min(end + 1U, body.size()));
+            if (line.empty() or line.starts_with(';')) {
+                continue;
+            }
+
+            if (line.ends_with(':')) {
+                auto const label = parseStaticNumber(line.substr(0, line.size() - 1U));
+                _blocks.push_back(Block{.label = label, .lines = {}});
+                continue;
+            }
+            if (_blocks.empty()) {
+                raisef<std::runtime_error>("instruction outside of a block: '{}'", line);
+            }
+
+            _blocks.back().lines.push_back(line);
+            if (line.starts_with('%')) {
+                auto lex       = StaticLexer{line};
+                auto const dst = lex.local();
+                lex.expect("=");
+                _types.emplace_back(dst, resultType(lex));
+            }
+        }
+    }
+
+    [[nodiscard]] static constexpr auto resultType(StaticLexer lex) -> Type
+    {
+        auto const op = lex.word();
+        if (op == "icmp") {
+            return Type::Bool;
+        }
+        if (op == "trunc") {
+            (void)lex.local();
+            lex.expect("to");
+        }
+        if (auto const type = findStaticType(op); type.has_value()) {
+            return *type;
+        }
+        return parseStaticType(lex.word());
+    }
+
+    constexpr auto compileLine(std::string_view line) -> void
+    {
+        auto lex = StaticLexer{line};
+        if (lex.accept("ret")) {
+            if (lex.accept("void")) {
+                emit(OpCode::ReturnVoid);
+            } else {
+                (void)lex.word();
+                emit(OpCode::Return, 0, slot(lex.local()));
+            }
+            return;
+        }
+        if (lex.accept("br")) {
+            compileBranch(lex);
+            return;
+        }
+
+        auto const dst = lex.local();
+        lex.expect("=");
+        auto const op = lex.word();
+        if (op == "phi") {
+            return;
+        }
+
+        if (op == "trunc") {
+            auto const src = lex.local();
+            lex.expect("to");
+            auto const to = parseStaticType(lex.word());
+            emit(selectTruncOp(typeOf(src), to), slot(dst), slot(src));
+            return;
+        }
+
+        if (auto const type = findStaticType(op); type.has_value()) {
+            auto const index = static_cast<std::uint32_t>(_code.constants.size());
+            _code.constants.push_back(parseStaticLiteral(lex.word(), *type));
+            emit(OpCode::Const, slot(dst), index);
+            return;
+        }
+
+        auto code = OpCode::Unreachable;
+        if (op == "icmp") {
+            auto const cmp = lex.word();
+            if (cmp != "eq" and cmp != "ne") {
+                raisef<std::runtime_error>("unsupported kind {} for integer compare", cmp);
+            }
+            code = cmp == "eq" ? OpCode::CmpEq : OpCode::CmpNe;
+            (void)lex.word();
+        } else {
+            auto const kind = parseStaticKind(op);
+            auto const type = parseStaticType(lex.word());
+            auto const real = kind == InstKind::FloatAdd or kind == InstKind::FloatSub
+                           or kind == InstKind::FloatMul or kind == InstKind::FloatDiv;
+            code = real ? selectFloatOp(kind, type) : selectIntOp(kind, type);
+        }
+
+        auto const lhs = lex.local();
+        lex.expect(",");
+        auto const rhs = lex.local();
+        emit(code, slot(dst), slot(lhs), slot(rhs));
+    }
+
+    constexpr auto compileBranch(StaticLexer lex) -> void
+    {
+        if (lex.accept("label")) {
+            auto const target = lex.local();
+            _edges.jump(_code, target, edgeCopies(target));
+            return;
+        }
+
+        lex.expect("i1");
+        auto const condition = lex.local();
+        lex.expect(",");
+        lex.expect("label");
+        auto const iftrue = lex.local();
+        lex.expect(",");
+        lex.expect("label");
+        auto const iffalse = lex.local();
+
+        auto const conditionSlot = slot(condition);
+        auto trueCopies          = edgeCopies(iftrue);
+        auto falseCopies         = edgeCopies(iffalse);
+        _edges.branchIf(
+            _code,
+            conditionSlot,
+            iftrue,
+            std::move(trueCopies),
+            iffalse,
+            std::move(falseCopies)
+        );
+    }
+
+    // Parallel copies for the phis of target on the edge from the current block.
+    constexpr auto edgeCopies(std::uint32_t target) -> std::vector<Bytecode::Copy>
+    {
+        auto const found = std::ranges::find(_blocks, target, &Block::label);
+        if (found == _blocks.end()) {
+            raisef<std::runtime_error>("unknown block {}", target);
+        }
+
+        auto pending = std::vector<Bytecode::Copy>{};
+        for (auto const line : found->lines) {
+            auto lex = StaticLexer{line};
+            if (not line.starts_with('%')) {
+                continue;
+            }
+
+            auto const dst = lex.local();
+            lex.expect("=");
+            if (lex.word() != "phi") {
+                continue;
+            }
+
+            (void)lex.word();
+            auto incoming = std::optional<std::uint32_t>{};
+            while (lex.accept("[")) {
+                auto const value = lex.local();
+                lex.expect(",");
+                auto const block = lex.local();
+                lex.expect("]");
+                (void)lex.accept(",");
+                if (block == _block) {
+                    incoming = value;
+                }
+            }
+            if (not incoming.has_value()) {
+                raisef<std::runtime_error>("phi has no incoming value for block {}", _block);
+            }
+
+            auto const copy = Bytecode::Copy{.dst = slot(dst), .src = slot(*incoming)};
+            if (copy.dst != copy.src) {
+                pending.push_back(copy);
+            }
+        }
+        return pending;
+    }
+
+    [[nodiscard]] constexpr auto typeOf(std::uint32_t reg) const -> Type
+    {
+        auto const found = std::ranges::find(_types, reg, &Typed::first);
+        if (found == _types.end()) {
+            raisef<std::runtime_error>("use of undefined register {}", reg);
+        }
+        return found->second;
+    }
+
+    [[nodiscard]] constexpr auto slot(std::uint32_t reg) -> std::uint32_t
+    {
+        auto const found = std::ranges::find(_slots, reg);
+        if (found != _slots.end()) {
+            return static_cast<std::uint32_t>(found - _slots.begin());
+        }
+        _slots.push_back(reg);
+        return static_cast<std::uint32_t>(_slots.size() - 1U);
+    }
+
+    [[nodiscard]] constexpr auto labelPc(std::uint32_t label) const -> std::uint32_t
+    {
+        auto const found = std::ranges::find(_labels, label, &Label::first);
+        if (found == _labels.end()) {
+            raisef<std::runtime_error>("unknown block {}", label);
+        }
+        return found->second;
+    }
+
+    [[nodiscard]] constexpr auto pc() const -> std::uint32_t
+    {
+        return static_cast<std::uint32_t>(_code.code.size());
+    }
+
+    constexpr auto
+    emit(OpCode op, std::uint32_t dst = 0, std::uint32_t lhs = 0, std::uint32_t rhs = 0) -> void
+    {
+        _code.code.push_back(Bytecode::Inst{.op = op, .dst = dst, .lhs = lhs, .rhs = rhs});
+    }
+
+    std::string_view _source;
+    Bytecode _code;
+    std::vector<std::uint32_t> _slots;
+    std::vector<Typed> _types;
+    std::vector<Label> _labels;
+    std::vector<Block> _blocks;
+    EdgeEmitter<std::uint32_t> _edges;
+    std::uint32_t _block{0};
+};
+
+template<FixedString Source>
+[[nodiscard]] consteval auto compileStatic()
+{
+    constexpr auto capacity = [] {
+        auto const code = StaticCompiler{Source.view()}.run();
+        return std::max({
+            code.arguments.size(),
+            code.code.size(),
+            code.constants.size(),
+            code.copies.size(),
+            std::size_t{1},
+        });
+    }();
+
+    auto const code = StaticCompiler{Source.view()}.run();
+    auto result     = StaticCode<capacity>{};
+    result.type     = code.type;
+    std::ranges::copy(code.arguments, result.arguments.begin());
+    std::ranges::copy(code.code, result.code.begin());
+    std::ranges::copy(code.constants, result.constants.begin());
+    std::ranges::copy(code.copies, result.copies.begin());
+    result.numArguments = static_cast<std::uint32_t>(code.arguments.size());
+    result.numInsts     = static_cast<std::uint32_t>(code.code.size());
+    result.registers    = code.registers;
+    return result;
+}
+
+// Runs the instruction at Pc with every operand known to the host compiler
+// and falls through into the next one. Returns the result once the function
+// returned, otherwise sets pc to where the dispatch loop continues.
+// NOLINTNEXTLINE(readability-function-cognitive-complexity)
+template<auto const& Code, std::uint32_t Pc>
+constexpr auto runStatic(Slot* frame, std::uint32_t& pc) -> std::optional<Slot>
+{
+    constexpr auto inst   = Code.code[Pc];
+    constexpr auto format = getOpFormat(inst.op);
+    constexpr auto base   = getBaseOpCode(inst.op);
+
+    auto const jump = [&pc](std::uint32_t target) -> std::optional<Slot> {
+        pc = target;
+        return std::nullopt;
+    };
+
+    if constexpr (inst.op == OpCode::Unreachable) {
+        raisef<std::runtime_error>("reached end of function without return");
+    } else if constexpr (inst.op == OpCode::ReturnVoid) {
+        return Slot{0};
+    } else if constexpr (format == OpFormat::Const) {
+        frame[inst.dst] = Code.constants[inst.lhs];
+    } else if constexpr (format == OpFormat::ConstPair) {
+        frame[inst.dst] = Code.constants[inst.lhs];
+        frame[inst.rhs] = Code.constants[inst.lhs + 1U];
+    } else if constexpr (format == OpFormat::Unary) {
+        frame[inst.dst] = evaluate<base>(frame[inst.lhs]);
+    } else if constexpr (format == OpFormat::Binary) {
+        frame[inst.dst] = evaluate<base>(frame[inst.lhs], frame[inst.rhs]);
+    } else if constexpr (format == OpFormat::BinaryConst) {
+        frame[inst.dst] = evaluate<base>(frame[inst.lhs], Code.constants[inst.rhs]);
+    } else if constexpr (format == OpFormat::Jump) {
+        return jump(inst.dst);
+    } else if constexpr (format == OpFormat::JumpCopy) {
+        for (auto i = inst.lhs; i != inst.rhs; ++i) {
+            frame[Code.copies[i].dst] = frame[Code.copies[i].src];
+        }
+        return jump(inst.dst);
+    } else if constexpr (format == OpFormat::Branch) {
+        return jump(frame[inst.lhs] != 0 ? inst.dst : inst.rhs);
+    } else if constexpr (format == OpFormat::CompareBranch) {
+        return jump(evaluate<base>(frame[inst.lhs], frame[inst.rhs]) != 0 ? inst.dst : Pc + 1U);
+    } else if constexpr (format == OpFormat::Return) {
+        return frame[inst.lhs];
+    } else if constexpr (format == OpFormat::ReturnConst) {
+        return Code.constants[inst.lhs];
+    } else {
+        static_assert(format == OpFormat::ReturnBinary);
+        return evaluate<base>(frame[inst.lhs], frame[inst.rhs]);
+    }
+
+    if constexpr (Pc + 1U < Code.numInsts) {
+        return runStatic<Code, Pc + 1U>(frame, pc);
+    } else {
+        return jump(Pc + 1U);
+    }
+}
+
+template<auto const& Code, std::uint32_t... Pc>
+constexpr auto runStatic(Slot* frame, std::integer_sequence<std::uint32_t, Pc...> /*pcs*/) -> Slot
+{
+    auto pc     = std::uint32_t{0};
+    auto result = std::optional<Slot>{};
+    while (not result.has_value()) {
+        ((pc == Pc ? (void)(result = runStatic<Code, Pc>(frame, pc)) : (void)0), ...);
+    }
+    return *result;
+}
+
+}  // namespace detail
+
+/// \brief Bytecode compiled from IR source while compiling the program.
+template<FixedString Source>
+inline constexpr auto staticCode = detail::compileStatic<Source>();
+
+/// \brief IR source embedded in C++, parsed and lowered in constant
+/// evaluation, e.g. StaticFunction<"define i64 @f(...) ...",
+/// std::int64_t(std::int64_t)>. Every instruction becomes its own template
+/// instance with operands and constants known to the host compiler, which
+/// can inline and fold the whole function. Nothing is parsed at startup
+/// and calls can be constant expressions.
+template<FixedString Source, typename Signature>
+struct StaticFunction;
+
+template<FixedString Source, typename R, typename... Args>
+struct StaticFunction<Source, R(Args...)>
+{
+    static constexpr auto const& code = staticCode<Source>;
+
+    static_assert(
+        detail::SignatureTraits<R(detail::ArgumentType<Args>...)>::matches(
+            code.type,
+            std::span{code.arguments}.first(code.numArguments)
+        ),
+        "signature does not match the function"
+    );
+
+    constexpr auto operator()(Args... args) const -> R
+    {
+        auto frame                  = std::array<Slot, code.registers + 1U>{};
+        [[maybe_unused]] auto index = 0zu;
+        ((frame[index++] = toSlot(static_cast<detail::ArgumentType<Args>>(args))), ...);
+
+        auto const pcs    = std::make_integer_sequence<std::uint32_t, code.numInsts>{};
+        auto const result = detail::runStatic<code>(frame.data(), pcs);
+        if constexpr (not std::is_void_v<R>) {
+            return fromSlot<R>(result);
+        }
+    }
+};
+
+}  // namespace snir
@@ -0,0 +1,377 @@
+#include "Superinstruction.hpp"
+
+#include "snir/core/Exception.hpp"
+#include "snir/ir/Bytecode.hpp"
+#include "snir/ir/OpCode.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace snir {
+
+namespace {
+
+using Inst = Bytecode::Inst;
+
+[[nodiscard]] constexpr auto endsBlock(OpCode op) -> bool
+{
+    switch (getOpFormat(op)) {
+        case OpFormat::None:
+        case OpFormat::Jump:
+        case OpFormat::JumpCopy:
+        case OpFormat::Branch:
+        case OpFormat::CompareBranch:
+        case OpFormat::Return:
+        case OpFormat::ReturnConst:
+        case OpFormat::ReturnBinary: return true;
+        default: return false;
+    }
+}
+
+/// \brief Superinstruction with the given format fused from base, if any.
+[[nodiscard]] constexpr auto findFused(OpFormat format, OpCode base) -> std::optional<OpCode>
+{
+    constexpr auto ops = std::array{
+#define SNIR_OP_CODE(Id, Name, Format) OpCode::Id,
+#include "snir/ir/OpCode.def"
+    };
+
+    for (auto const op : ops) {
+        if (op != base and getOpFormat(op) == format and getBaseOpCode(op) == base) {
+            return op;
+        }
+    }
+    return std::nullopt;
+}
+
+[[nodiscard]] constexpr auto isCommutative(OpCode op) -> bool
+{
+    return op == OpCode::AddI64 or op == OpCode::MulI64;
+}
+
+[[nodiscard]] constexpr auto isFoldable(OpCode op) -> bool
+{
+    // Division by zero has to fail at runtime, not while compiling.
+    return getOpFormat(op) == OpFormat::Binary and op != OpCode::DivI64 and op != OpCode::ModI64;
+}
+
+template<OpCode Op>
+[[nodiscard]] auto fold(Slot lhs, Slot rhs) -> Slot
+{
+    if constexpr (getOpFormat(Op) == OpFormat::Binary) {
+        return evaluate<Op>(lhs, rhs);
+    } else {
+        raisef<std::logic_error>("{} is not a binary opcode", Op);
+    }
+}
+
+[[nodiscard]] auto fold(OpCode op, Slot lhs, Slot rhs) -> Slot
+{
+    switch (op) {
+#define SNIR_OP_CODE(Id, Name, Format)                                                               \
+    case OpCode::Id: return fold<OpCode::Id>(lhs, rhs);
+#include "snir/ir/OpCode.def"
+    }
+    raisef<std::logic_error>("unknown opcode {}", static_cast<int>(op));
+}
+
+/// \brief Instructions that start a basic block. Nothing is fused across them.
+[[nodiscard]] auto findLeaders(Bytecode const& code) -> std::vector<bool>
+{
+    auto leaders = std::vector<bool>(code.code.size() + 1U, false);
+    leaders[0]   = true;
+    for (auto pc = 0zu; pc < code.code.size(); ++pc) {
+        forEachTarget(code.code[pc], [&](std::uint32_t target) { leaders[target] = true; });
+        if (endsBlock(code.code[pc].op)) {
+            leaders[pc + 1U] = true;
+        }
+    }
+    return leaders;
+}
+
+struct SuperinstructionFuser
+{
+    explicit SuperinstructionFuser(Bytecode& code)
+        : _code{code}
+        , _in{code.code}
+        , _leaders{findLeaders(code)}
+        , _uses(code.registers, 0U)
+    {
+        for (auto const& inst : _in) {
+            forEachRead(inst, [this](std::uint32_t slot) { ++_uses[slot]; });
+        }
+        for (auto const& copy : code.copies) {
+            ++_uses[copy.src];
+        }
+    }
+
+    auto run() -> void
+    {
+        auto remap = std::vector<std::uint32_t>(_in.size() + 1U, 0U);
+        for (auto pc = 0zu; pc < _in.size();) {
+            auto const start = static_cast<std::uint32_t>(_out.size());
+            auto const count = fuseAt(pc);
+            for (auto i = 0zu; i < count; ++i) {
+                remap[pc + i] = start;
+            }
+            pc += count;
+        }
+        remap.back() = static_cast<std::uint32_t>(_out.size());
+
+        for (auto& inst : _out) {
+            forEachTarget(inst, [&](std::uint32_t& target) { target = remap[target]; });
+        }
+        for (auto& label : _code.labels) {
+            label = remap[label];
+        }
+        _code.code = std::move(_out);
+    }
+
+private:
+    // Emits the code for the instructions starting at pc and returns how
+    // many of them were consumed.
+    auto fuseAt(std::size_t pc) -> std::size_t
+    {
+        if (canFoldConstants(pc)) {
+            return foldConstants(pc);
+        }
+        if (canFuseConstOperand(pc)) {
+            return fuseConstOperand(pc);
+        }
+        if (canFuseConstPair(pc)) {
+            return fuseConstPair(pc);
+        }
+        if (canFuseCompareBranch(pc)) {
+            return fuseCompareBranch(pc);
+        }
+        if (canFuseReturnBinary(pc)) {
+            return fuseReturnBinary(pc);
+        }
+        if (canFuseReturnConst(pc)) {
+            return fuseReturnConst(pc);
+        }
+
+        _out.push_back(_in[pc]);
+        return 1;
+    }
+
+    // const, const, binop: both constants are only read by the binop.
+    [[nodiscard]] auto canFoldConstants(std::size_t pc) const -> bool
+    {
+        if (not inBlock(pc, 3) or not isConst(pc) or not isConst(pc + 1U)) {
+            return false;
+        }
+
+        auto const& op = _in[pc + 2U];
+        auto const a   = _in[pc].dst;
+        auto const b   = _in[pc + 1U].dst;
+        return isFoldable(op.op) and a != b and isSingleUse(a) and isSingleUse(b)
+           and ((op.lhs == a and op.rhs == b) or (op.lhs == b and op.rhs == a));
+    }
+
+    // A folded value that is returned right away skips the frame as well.
+    auto foldConstants(std::size_t pc) -> std::size_t
+    {
+        auto const& op    = _in[pc + 2U];
+        auto const value  = [&](std::uint32_t slot) {
+            auto const& def = _in[pc].dst == slot ? _in[pc] : _in[pc + 1U];
+            return _code.constants[def.lhs];
+        };
+        auto const folded = fold(op.op, value(op.lhs), value(op.rhs));
+        auto const index  = static_cast<std::uint32_t>(_code.constants.size());
+        _code.constants.push_back(folded);
+        if (isReturnOf(pc + 3U, op.dst)) {
+            _out.push_back(Inst{.op = OpCode::ReturnConst, .lhs = index});
+            return 4;
+        }
+        _out.push_back(Inst{.op = OpCode::Const, .dst = op.dst, .lhs = index});
+        return 3;
+    }
+
+    // const, binop: the constant becomes an immediate operand.
+    [[nodiscard]] auto canFuseConstOperand(std::size_t pc) const -> bool
+    {
+        if (not inBlock(pc, 2) or not isConst(pc)) {
+            return false;
+        }
+
+        auto const& op = _in[pc + 1U];
+        auto const k   = _in[pc].dst;
+        if (not findFused(OpFormat::BinaryConst, op.op) or not isSingleUse(k) or op.lhs == op.rhs) {
+            return false;
+        }
+        return op.rhs == k or (op.lhs == k and isCommutative(op.op));
+    }
+
+    auto fuseConstOperand(std::size_t pc) -> std::size_t
+    {
+        auto const& op  = _in[pc + 1U];
+        auto const lhs  = op.rhs == _in[pc].dst ? op.lhs : op.rhs;
+        auto const code = *findFused(OpFormat::BinaryConst, op.op);
+        _out.push_back(Inst{.op = code, .dst = op.dst, .lhs = lhs, .rhs = _in[pc].lhs});
+        return 2;
+    }
+
+    // const, const: one dispatch for both, unless the second one can be
+    // fused with the instruction after it.
+    [[nodiscard]] auto canFuseConstPair(std::size_t pc) const -> bool
+    {
+        return inBlock(pc, 2) and isConst(pc) and isConst(pc + 1U)
+           and _in[pc + 1U].lhs == _in[pc].lhs + 1U and not canFoldConstants(pc + 1U)
+           and not canFuseConstOperand(pc + 1U) and not canFuseReturnConst(pc + 1U);
+    }
+
+    auto fuseConstPair(std::size_t pc) -> std::size_t
+    {
+        _out.push_back(Inst{
+            .op  = OpCode::ConstPair,
+            .dst = _in[pc].dst,
+            .lhs = _in[pc].lhs,
+            .rhs = _in[pc + 1U].dst,
+        });
+        return 2;
+    }
+
+    // icmp, br i1: the condition never reaches the frame.
+    [[nodiscard]] auto canFuseCompareBranch(std::size_t pc) const -> bool
+    {
+        if (not inBlock(pc, 2)) {
+            return false;
+        }
+
+        auto const& cmp = _in[pc];
+        auto const& br  = _in[pc + 1U];
+        return findFused(OpFormat::CompareBranch, cmp.op) and br.op == OpCode::BranchIf
+           and br.lhs == cmp.dst and isSingleUse(cmp.dst);
+    }
+
+    auto fuseCompareBranch(std::size_t pc) -> std::size_t
+    {
+        auto const& cmp  = _in[pc];
+        auto const& br   = _in[pc + 1U];
+        auto const next  = static_cast<std::uint32_t>(pc + 2U);
+        auto const fused = [&](OpCode base, std::uint32_t target) {
+            auto const op = *findFused(OpFormat::CompareBranch, base);
+            return Inst{.op = op, .dst = target, .lhs = cmp.lhs, .rhs = cmp.rhs};
+        };
+
+        if (br.dst == next) {
+            auto const inverse = cmp.op == OpCode::CmpEq ? OpCode::CmpNe : OpCode::CmpEq;
+            _out.push_back(fused(inverse, br.rhs));
+            return 2;
+        }
+
+        _out.push_back(fused(cmp.op, br.dst));
+        if (br.rhs != next) {
+            _out.push_back(Inst{.op = OpCode::Jump, .dst = br.rhs});
+        }
+        return 2;
+    }
+
+    // binop, ret: the result is returned without a frame store.
+    [[nodiscard]] auto canFuseReturnBinary(std::size_t pc) const -> bool
+    {
+        if (not inBlock(pc, 2)) {
+            return false;
+        }
+
+        auto const& op  = _in[pc];
+        auto const& ret = _in[pc + 1U];
+        return findFused(OpFormat::ReturnBinary, op.op) and ret.op == OpCode::Return
+           and ret.lhs == op.dst and isSingleUse(op.dst);
+    }
+
+    auto fuseReturnBinary(std::size_t pc) -> std::size_t
+    {
+        auto const& op  = _in[pc];
+        auto const code = *findFused(OpFormat::ReturnBinary, op.op);
+        _out.push_back(Inst{.op = code, .lhs = op.lhs, .rhs = op.rhs});
+        return 2;
+    }
+
+    // const, ret: the constant is returned without a frame store.
+    [[nodiscard]] auto canFuseReturnConst(std::size_t pc) const -> bool
+    {
+        return isConst(pc) and isReturnOf(pc + 1U, _in[pc].dst);
+    }
+
+    auto fuseReturnConst(std::size_t pc) -> std::size_t
+    {
+        _out.push_back(Inst{.op = OpCode::ReturnConst, .lhs = _in[pc].lhs});
+        return 2;
+    }
+
+    // pc returns slot, the only read of it, in the block of the instruction before.
+    [[nodiscard]] auto isReturnOf(std::size_t pc, std::uint32_t slot) const -> bool
+    {
+        return pc < _in.size() and not _leaders[pc] and _in[pc].op == OpCode::Return
+           and _in[pc].lhs == slot and isSingleUse(slot);
+    }
+
+    [[nodiscard]] auto inBlock(std::size_t pc, std::size_t count) const -> bool
+    {
+        if (pc + count > _in.size()) {
+            return false;
+        }
+        for (auto i = pc + 1U; i < pc + count; ++i) {
+            if (_leaders[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    [[nodiscard]] auto isConst(std::size_t pc) const -> bool { return _in[pc].op == OpCode::Const; }
+
+    [[nodiscard]] auto isSingleUse(std::uint32_t slot) const -> bool { return _uses[slot] == 1U; }
+
+    Bytecode& _code;
+    std::vector<Inst> _in;
+    std::vector<Inst> _out;
+    std::vector<bool> _leaders;
+    std::vector<std::uint32_t> _uses;
+};
+
+}  // namespace
+
+auto countOpCodePairs(Bytecode const& code) -> OpCodePairs
+{
+    auto pairs = OpCodePairs{};
+    countOpCodePairs(code, pairs);
+    return pairs;
+}
+
+auto countOpCodePairs(Bytecode const& code, OpCodePairs& counts) -> void
+{
+    auto const leaders = findLeaders(code);
+    for (auto pc = 1zu; pc < code.code.size(); ++pc) {
+        if (not leaders[pc]) {
+            ++counts[std::pair{code.code[pc - 1U].op, code.code[pc].op}];
+        }
+    }
+}
+
+auto isFusedPair(OpCode first, OpCode second) -> bool
+{
+    if (first == OpCode::Const) {
+        return second == OpCode::Const or second == OpCode::Return
+            or findFused(OpFormat::BinaryConst, second).has_value();
+    }
+    if (second == OpCode::BranchIf) {
+        return findFused(OpFormat::CompareBranch, first).has_value();
+    }
+    if (second == OpCode::Return) {
+        return findFused(OpFormat::ReturnBinary, first).has_value();
+    }
+    return false;
+}
+
+auto fuseSuperinstructions(Bytecode& code) -> void { SuperinstructionFuser{code}.run(); }
+
+}  // namespace snir
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "snir/ir/Bytecode.hpp"
+#include "snir/ir/OpCode.hpp"
+
+#include <cstddef>
+#include <map>
+#include <utility>
+
+namespace snir {
+
+using OpCodePairs = std::map<std::pair<OpCode, OpCode>, std::size_t>;
+
+/// \brief Number of times each opcode pair executes back to back inside a
+/// basic block. Used to pick the patterns fused by fuseSuperinstructions.
+[[nodiscard]] auto countOpCodePairs(Bytecode const& code) -> OpCodePairs;
+
+/// \brief Adds the pairs of code to counts, for a table over a corpus.
+auto countOpCodePairs(Bytecode const& code, OpCodePairs& counts) -> void;
+
+/// \brief True if fuseSuperinstructions has a pattern starting with first
+/// followed by second. Whether it applies also depends on the operands.
+[[nodiscard]] auto isFusedPair(OpCode first, OpCode second) -> bool;
+
+/// \brief Rewrites adjacent instructions of the same block into single
+/// superinstructions. Jump targets are remapped, semantics are unchanged.
+///
+/// The patterns follow the pair table `snir-opt -v` prints for several
+/// inputs, run it over test/files before adding or dropping one.
+auto fuseSuperinstructions(Bytecode& code) -> void;
+
+}  // namespace snir
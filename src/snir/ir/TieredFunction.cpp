@@ -0,0 +1,99 @@
+#include "TieredFunction.hpp"
+
+#include "snir/ir/Bytecode.hpp"
+#include "snir/ir/ClosureFunction.hpp"
+#include "snir/ir/Interpreter.hpp"
+#include "snir/ir/Literal.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace snir {
+
+TieredFunction::TieredFunction(Bytecode code, TierPolicy policy)
+    : _code{std::move(code)}
+    , _policy{policy}
+    , _heads(_code.code.size() + 1U, false)
+{
+    for (auto const label : _code.labels) {
+        _heads[label] = true;
+    }
+}
+
+auto TieredFunction::call(std::span<Literal const> args) -> std::optional<Literal>
+{
+    if (_code.arguments.size() != args.size()) {
+        return std::nullopt;
+    }
+
+    // One slot more than the interpreter needs, for the closure result.
+    thread_local auto frame = std::vector<Slot>{};
+    frame.assign(_code.registers + 1U, Slot{0});
+    for (auto i = 0zu; i < args.size(); ++i) {
+        frame[i] = toSlot(args[i], _code.arguments[i]);
+    }
+
+    auto const calls     = _calls.fetch_add(1, std::memory_order_relaxed) + 1U;
+    auto const* compiled = _compiled.load(std::memory_order_acquire);
+    if (compiled == nullptr and calls >= _policy.calls) {
+        compiled = promote();
+    }
+    return toLiteral(compiled != nullptr ? compiled->run(frame) : interpret(frame), _code.type);
+}
+
+auto TieredFunction::tier() const noexcept -> Tier
+{
+    return _compiled.load(std::memory_order_acquire) != nullptr ? Tier::Compiled : Tier::Interpreted;
+}
+
+auto TieredFunction::interpret(std::span<Slot> frame) -> Slot
+{
+    auto const slice = Interpreter::Slice{
+        .instructions = std::numeric_limits<std::uint32_t>::max(),
+        .blocks       = true,
+    };
+
+    auto pc    = std::uint32_t{0};
+    auto block = pc;
+    while (true) {
+        if (auto const result = Interpreter::resume(_code, frame, pc, slice); result.has_value()) {
+            return *result;
+        }
+        if (not _heads[pc]) {
+            continue;
+        }
+
+        // Entering the same or an earlier block is a loop, edge copies that
+        // are laid out after the blocks do not count.
+        auto const loop = pc <= block;
+        block           = pc;
+        if (not loop) {
+            continue;
+        }
+
+        auto const edges     = _backEdges.fetch_add(1, std::memory_order_relaxed) + 1U;
+        auto const* compiled = _compiled.load(std::memory_order_acquire);
+        if (compiled != nullptr or edges >= _policy.backEdges) {
+            _osr.fetch_add(1, std::memory_order_relaxed);
+            return (compiled != nullptr ? compiled : promote())->run(frame, pc);
+        }
+    }
+}
+
+auto TieredFunction::promote() -> ClosureFunction const*
+{
+    std::call_once(_once, [this] {
+        _closure = std::make_unique<ClosureFunction>(ClosureFunction::compile(_code));
+        _compiled.store(_closure.get(), std::memory_order_release);
+    });
+    return _compiled.load(std::memory_order_acquire);
+}
+
+}  // namespace snir
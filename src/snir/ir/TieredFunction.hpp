@@ -0,0 +1,72 @@
+#pragma once
+
+#include "snir/ir/Bytecode.hpp"
+#include "snir/ir/ClosureFunction.hpp"
+#include "snir/ir/Literal.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace snir {
+
+/// \brief Counts at which a TieredFunction is compiled.
+struct TierPolicy
+{
+    std::uint64_t calls{1'000};
+    std::uint64_t backEdges{10'000};
+};
+
+/// \brief Function that starts out interpreted and moves to a ClosureFunction
+/// once hot. Cold functions never pay for compiling.
+///
+/// Calls and loop back edges are counted. The first call crossing a
+/// threshold compiles, then every call switches over atomically. A loop
+/// crossing the back edge threshold moves into the compiled code at the
+/// next block boundary, with the frame the interpreter left behind.
+/// Calls may run concurrently from several threads.
+struct TieredFunction
+{
+    enum struct Tier : std::uint8_t
+    {
+        Interpreted,
+        Compiled,
+    };
+
+    explicit TieredFunction(Bytecode code, TierPolicy policy = {});
+
+    TieredFunction(TieredFunction const& other)                    = delete;
+    TieredFunction(TieredFunction&& other)                         = delete;
+    ~TieredFunction()                                              = default;
+    auto operator=(TieredFunction const& other) -> TieredFunction& = delete;
+    auto operator=(TieredFunction&& other) -> TieredFunction&      = delete;
+
+    [[nodiscard]] auto call(std::span<Literal const> args) -> std::optional<Literal>;
+
+    [[nodiscard]] auto tier() const noexcept -> Tier;
+    [[nodiscard]] auto calls() const noexcept -> std::uint64_t { return _calls.load(); }
+    [[nodiscard]] auto backEdges() const noexcept -> std::uint64_t { return _backEdges.load(); }
+
+    /// Calls that moved to the compiled tier in the middle of a loop.
+    [[nodiscard]] auto replacements() const noexcept -> std::uint64_t { return _osr.load(); }
+
+private:
+    [[nodiscard]] auto interpret(std::span<Slot> frame) -> Slot;
+    [[nodiscard]] auto promote() -> ClosureFunction const*;
+
+    Bytecode _code;
+    TierPolicy _policy;
+    std::vector<bool> _heads;
+    std::atomic<std::uint64_t> _calls{0};
+    std::atomic<std::uint64_t> _backEdges{0};
+    std::atomic<std::uint64_t> _osr{0};
+    std::once_flag _once;
+    std::unique_ptr<ClosureFunction> _closure;
+    std::atomic<ClosureFunction const*> _compiled{nullptr};
+};
+
+}  // namespace snir
@@ -0,0 +1,163 @@
+#include "Uses.hpp"
+
+#include "snir/ir/FunctionDefinition.hpp"
+#include "snir/ir/Registry.hpp"
+#include "snir/ir/Result.hpp"
+#include "snir/ir/ValueId.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace snir {
+
+namespace {
+
+[[nodiscard]] auto usesOf(Registry& reg, ValueId value) -> Uses&
+{
+    auto* uses = reg.try_get<Uses>(value);
+    return uses != nullptr ? *uses : reg.emplace<Uses>(value);
+}
+
+auto link(Registry& reg, ValueId value, ValueId user, std::uint32_t operand) -> std::uint32_t
+{
+    auto& uses      = usesOf(reg, value);
+    auto const slot = static_cast<std::uint32_t>(uses.users.size());
+    uses.users.push_back(user);
+    uses.operands.push_back(operand);
+    return slot;
+}
+
+// Swap and pop, the moved use gets its slot updated.
+auto unlinkUse(Registry& reg, Uses& uses, std::size_t slot) -> void
+{
+    auto const last = uses.users.size() - 1;
+    if (slot != last) {
+        uses.users[slot]    = uses.users[last];
+        uses.operands[slot] = uses.operands[last];
+
+        auto* moved = reg.try_get<UseSlots>(uses.users[slot]);
+        if (moved != nullptr and uses.operands[slot] < moved->slots.size()) {
+            moved->slots[uses.operands[slot]] = static_cast<std::uint32_t>(slot);
+        }
+    }
+    uses.users.pop_back();
+    uses.operands.pop_back();
+}
+
+}  // namespace
+
+auto useCount(Registry const& reg, ValueId value) -> std::size_t
+{
+    auto const* uses = reg.try_get<Uses>(value);
+    return uses != nullptr ? uses->users.size() : 0;
+}
+
+auto users(Registry const& reg, ValueId value) -> std::span<ValueId const>
+{
+    auto const* uses = reg.try_get<Uses>(value);
+    return uses != nullptr ? std::span<ValueId const>{uses->users} : std::span<ValueId const>{};
+}
+
+auto addUses(Registry& reg, ValueId inst) -> void
+{
+    auto slots = std::vector<std::uint32_t>{};
+    forEachOperand(reg, inst, [&reg, &slots, inst](ValueId op) {
+        auto const operand = static_cast<std::uint32_t>(slots.size());
+        slots.push_back(link(reg, op, inst, operand));
+    });
+    reg.emplace_or_replace<UseSlots>(inst, std::move(slots));
+}
+
+auto removeUses(Registry& reg, ValueId inst) -> void
+{
+    auto* slots = reg.try_get<UseSlots>(inst);
+    if (slots == nullptr) {
+        return;
+    }
+
+    auto const saved = std::move(slots->slots);
+    reg.remove<UseSlots>(inst);
+
+    auto operand = 0zu;
+    forEachOperand(reg, inst, [&](ValueId op) {
+        auto* uses = reg.try_get<Uses>(op);
+        if (uses == nullptr) {
+            ++operand;
+            return;
+        }
+
+        // A slot is only trusted if it still points back at this operand,
+        // operands changed without removeUses fall back to a search.
+        auto slot  = operand < saved.size() ? std::size_t{saved[operand]} : uses->users.size();
+        auto valid = slot < uses->users.size() and uses->users[slot] == inst
+                 and uses->operands[slot] == operand;
+        if (not valid) {
+            auto const found = std::ranges::find(uses->users, inst);
+            slot             = static_cast<std::size_t>(std::distance(uses->users.begin(), found));
+            valid            = found != uses->users.end();
+        }
+        if (valid) {
+            unlinkUse(reg, *uses, slot);
+        }
+        ++operand;
+    });
+}
+
+auto replaceAllUsesWith(Registry& reg, ValueId value, ValueId replacement) -> void
+{
+    if (value == replacement) {
+        return;
+    }
+
+    auto moved = Uses{};
+    if (auto* uses = reg.try_get<Uses>(value); uses != nullptr) {
+        moved = std::exchange(*uses, Uses{});
+    }
+
+    for (auto i = 0zu; i < moved.users.size(); ++i) {
+        auto const user    = moved.users[i];
+        auto const operand = moved.operands[i];
+
+        auto index = 0U;
+        forEachOperand(reg, user, [&index, operand, replacement](ValueId& op) {
+            if (index++ == operand) {
+                op = replacement;
+            }
+        });
+
+        auto const slot = link(reg, replacement, user, operand);
+        auto* slots     = reg.try_get<UseSlots>(user);
+        if (slots != nullptr and operand < slots->slots.size()) {
+            slots->slots[operand] = slot;
+        }
+    }
+}
+
+auto rebuildUses(Registry& reg, ValueId func) -> void
+{
+    auto const& def = reg.get<FunctionDefinition>(func);
+    for (auto const arg : def.args) {
+        reg.remove<Uses>(arg);
+    }
+    for (auto const& block : def.blocks) {
+        for (auto const inst : block.instructions) {
+            if (auto const* result = reg.try_get<Result>(inst); result != nullptr) {
+                reg.remove<Uses>(result->id);
+            }
+            forEachOperand(reg, inst, [&reg](ValueId op) { reg.remove<Uses>(op); });
+        }
+    }
+
+    for (auto const& block : def.blocks) {
+        for (auto const inst : block.instructions) {
+            addUses(reg, inst);
+        }
+    }
+}
+
+}  // namespace snir
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "snir/ir/Branch.hpp"
+#include "snir/ir/Operands.hpp"
+#include "snir/ir/Phi.hpp"
+#include "snir/ir/Registry.hpp"
+#include "snir/ir/ValueId.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace snir {
+
+/// \brief Instructions reading a register. An instruction is listed once per
+/// operand, so reading a value twice counts as two uses.
+///
+/// The Instruction setters and every helper below keep the lists up to
+/// date. Code that changes operand components directly has to call
+/// removeUses before and addUses after, or rebuildUses for the function.
+struct Uses
+{
+    std::vector<ValueId> users;
+    std::vector<std::uint32_t> operands;  // Operand index within each user.
+};
+
+/// \brief Position of every operand of an instruction in the use list of the
+/// value it reads, so a use is unlinked with a swap and pop.
+struct UseSlots
+{
+    std::vector<std::uint32_t> slots;
+};
+
+/// \brief Calls func for every register read by the instruction: operands,
+/// the branch condition and incoming phi values. The order of the calls
+/// defines the operand index.
+template<typename Reg, typename Func>
+auto forEachOperand(Reg& reg, ValueId inst, Func func) -> void
+{
+    if (auto* ops = reg.template try_get<Operands>(inst); ops != nullptr) {
+        for (auto& op : ops->list) {
+            func(op);
+        }
+    }
+    if (auto* br = reg.template try_get<Branch>(inst); br != nullptr and br->condition) {
+        func(*br->condition);
+    }
+    if (auto* phi = reg.template try_get<Phi>(inst); phi != nullptr) {
+        for (auto& incoming : phi->incoming) {
+            func(incoming.value);
+        }
+    }
+}
+
+[[nodiscard]] auto useCount(Registry const& reg, ValueId value) -> std::size_t;
+[[nodiscard]] auto users(Registry const& reg, ValueId value) -> std::span<ValueId const>;
+
+/// \brief Registers the instruction as a user of all of its operands.
+auto addUses(Registry& reg, ValueId inst) -> void;
+
+/// \brief Unregisters the instruction from all of its operands, used before
+/// an instruction is erased or its operands change. O(1) per operand.
+auto removeUses(Registry& reg, ValueId inst) -> void;
+
+/// \brief Rewrites every read of value to read replacement instead and moves
+/// the users over.
+auto replaceAllUsesWith(Registry& reg, ValueId value, ValueId replacement) -> void;
+
+/// \brief Recomputes the lists of all arguments, results and operands of
+/// the function from its instructions. Linear in the size of the function.
+auto rebuildUses(Registry& reg, ValueId func) -> void;
+
+}  // namespace snir
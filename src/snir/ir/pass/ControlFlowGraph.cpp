@@ -64,6 +64,13 @@ auto ControlFlowGraph::addBlockToGraph(BasicBlock const& block) -> void
         fmt::println("; branch in block {} to {}", int(_nodeIds[node]), int(_nodeIds[dest]));
         _graph.add(dest);
         _graph.connect(node, dest);
+
+        if (branch.iffalse) {
+            auto const other = _nodeIds.add(*branch.iffalse);
+            fmt::println("; branch in block {} to {}", int(_nodeIds[node]), int(_nodeIds[other]));
+            _graph.add(other);
+            _graph.connect(node, other);
+        }
     }
 }
 
@@ -4,11 +4,13 @@
 #include "snir/ir/AnalysisManager.hpp"
 #include "snir/ir/Function.hpp"
 #include "snir/ir/Instruction.hpp"
-#include "snir/ir/Operands.hpp"
 #include "snir/ir/Result.hpp"
-#include "snir/ir/Value.hpp"
+#include "snir/ir/Uses.hpp"
 
+#include <algorithm>
+#include <map>
 #include <ranges>
+#include <vector>
 
 namespace snir {
 
@@ -20,40 +22,65 @@ struct DeadStoreElimination
 
     auto operator()(Function& f, AnalysisManager<Function>& /*analysis*/) -> void
     {
-        _used.clear();
+        _defs.clear();
+        _worklist.clear();
+        _dead.clear();
+
         auto* reg    = f.asValue().registry();
         auto& blocks = f.basicBlocks();
 
-        auto nop = Instruction::create(*reg, InstKind::Nop, Type::Void);
-
-        for (auto& block : std::ranges::reverse_view(blocks)) {
-            auto rb = std::rbegin(block.instructions);
-            auto re = std::rend(block.instructions);
-            std::transform(rb, re, rb, [this, reg, nop](auto id) {
-                return replaceWithNopIfUnused(Value{*reg, id}, nop);
-            });
+        // Every instruction defines at most one register and has no side
+        // effect besides it, one without users is dead.
+        for (auto const& block : blocks) {
+            for (auto const id : block.instructions) {
+                if (auto const* result = reg->try_get<Result>(id); result != nullptr) {
+                    _defs.emplace(result->id, id);
+                    if (useCount(*reg, result->id) == 0) {
+                        _worklist.push_back(id);
+                    }
+                }
+            }
         }
-    }
 
-private:
-    auto replaceWithNopIfUnused(Value inst, ValueId nop) -> ValueId
-    {
-        auto const* result = inst.try_get<Result>();
-        if (result != nullptr and not _used.contains(result->id)) {
-            return nop;
-        }
+        // Removing a dead instruction can drop the last use of its operands.
+        while (not _worklist.empty()) {
+            auto const inst = _worklist.back();
+            _worklist.pop_back();
+            _dead.push_back(inst);
+
+            auto operands = std::vector<ValueId>{};
+            forEachOperand(*reg, inst, [&operands](ValueId op) { operands.push_back(op); });
+            removeUses(*reg, inst);
 
-        auto const* operands = inst.try_get<Operands>();
-        if (operands != nullptr) {
-            for (auto const op : operands->list) {
-                _used.insert(op);
+            std::ranges::sort(operands);
+            auto const [first, last] = std::ranges::unique(operands);
+            for (auto const op : std::ranges::subrange(operands.begin(), first)) {
+                auto const def = _defs.find(op);
+                if (def != _defs.end() and useCount(*reg, op) == 0) {
+                    _worklist.push_back(def->second);
+                }
             }
         }
 
-        return inst;
+        if (_dead.empty()) {
+            return;
+        }
+
+        auto const dead = FlatSet<ValueId>{_dead};
+        auto const nop  = Instruction::create(*reg, InstKind::Nop, Type::Void);
+        for (auto& block : blocks) {
+            std::ranges::replace_if(
+                block.instructions,
+                [&dead](ValueId id) { return dead.contains(id); },
+                nop
+            );
+        }
     }
 
-    FlatSet<ValueId> _used;
+private:
+    std::map<ValueId, ValueId> _defs;
+    std::vector<ValueId> _worklist;
+    std::vector<ValueId> _dead;
 };
 
 }  // namespace snir
@@ -16,7 +16,7 @@ struct RemoveNop
     {
         auto instKind = func.asValue().registry()->view<InstKind>();
         for (auto& block : func.basicBlocks()) {
-            std::erase_if(block.instructions, [&](ValueId id) {
+            erase_if(block.instructions, [&](ValueId id) {
                 auto const [kind] = instKind.get(id);
                 return kind == InstKind::Nop;
             });
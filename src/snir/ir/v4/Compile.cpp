@@ -0,0 +1,203 @@
+#include "Compile.hpp"
+
+#include "snir/core/Exception.hpp"
+#include "snir/ir/Bytecode.hpp"
+#include "snir/ir/FrameCompaction.hpp"
+#include "snir/ir/InstKind.hpp"
+#include "snir/ir/Lowering.hpp"
+#include "snir/ir/OpCode.hpp"
+#include "snir/ir/Superinstruction.hpp"
+#include "snir/ir/Type.hpp"
+#include "snir/ir/v4/SharedValueStore.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace snir::v4 {
+
+namespace {
+
+constexpr auto unassigned = std::numeric_limits<std::uint32_t>::max();
+
+struct Compiler
+{
+    Compiler(SharedValueStore const& store, FunctionId id)
+        : _store{store}
+        , _func{store.functions().get(id)}
+        , _slots(store.values().size(), unassigned)
+        , _labels(_func.blocks.size(), 0)
+    {}
+
+    [[nodiscard]] auto run() -> Bytecode
+    {
+        if (_func.blocks.empty()) {
+            raisef<std::runtime_error>("function '{}' has no basic blocks", _func.identifier);
+        }
+
+        _code.type = _func.type;
+        for (auto const arg : _func.arguments) {
+            _code.arguments.push_back(_store.values().get(arg).type);
+            (void)slot(arg);
+        }
+
+        for (auto b = 0zu; b < _func.blocks.size(); ++b) {
+            auto const& block = _func.blocks[b];
+            _block            = BlockId(b);
+            _labels[b]        = pc();
+            for (auto i = block.begin; i != block.end; ++i) {
+                compileInst(_store.instructions().get(_func.instructions[i]));
+            }
+        }
+
+        _edges.finish(_code, [this](BlockId block) {
+            return _labels.at(static_cast<std::size_t>(block));
+        });
+        _code.labels = _labels;
+
+        _code.registers = _numSlots;
+        assignScratchSlot(_code);
+        return std::move(_code);
+    }
+
+private:
+    auto compileInst(Inst const& inst) -> void
+    {
+        switch (inst.kind) {
+            case InstKind::Nop: break;
+            case InstKind::Phi: break;
+            case InstKind::Const: {
+                auto const index = static_cast<std::uint32_t>(_code.constants.size());
+                _code.constants.push_back(toSlot(_store.literals().get(inst.literalId), inst.type));
+                emit(OpCode::Const, slot(inst.result), index);
+                break;
+            }
+            case InstKind::Return: {
+                if (inst.type == Type::Void) {
+                    emit(OpCode::ReturnVoid);
+                } else {
+                    emit(OpCode::Return, 0, slot(_store.unaryOps().get(inst.unaryOpId).operand));
+                }
+                break;
+            }
+            case InstKind::Branch: compileBranch(_store.branches().get(inst.branchId)); break;
+            case InstKind::IntCmp: {
+                if (inst.type != Type::Int64 and inst.type != Type::Bool) {
+                    raisef<std::runtime_error>("unsupported type {} for integer compare", inst.type);
+                }
+                auto const& op = _store.binaryOps().get(inst.binaryOpId);
+                compileBinary(inst, selectCompareOp(op.compare));
+                break;
+            }
+            case InstKind::Trunc: {
+                auto const operand = _store.unaryOps().get(inst.unaryOpId).operand;
+                auto const from    = _store.values().get(operand).type;
+                emit(selectTruncOp(from, inst.type), slot(inst.result), slot(operand));
+                break;
+            }
+            case InstKind::FloatAdd:
+            case InstKind::FloatSub:
+            case InstKind::FloatMul:
+            case InstKind::FloatDiv: compileBinary(inst, selectFloatOp(inst.kind, inst.type)); break;
+            default: compileBinary(inst, selectIntOp(inst.kind, inst.type)); break;
+        }
+    }
+
+    auto compileBinary(Inst const& inst, OpCode op) -> void
+    {
+        auto const& ops = _store.binaryOps().get(inst.binaryOpId);
+        emit(op, slot(inst.result), slot(ops.lhs), slot(ops.rhs));
+    }
+
+    auto compileBranch(Branch const& br) -> void
+    {
+        if (br.condition != noValue and br.iffalse != noBlock) {
+            auto const condition = slot(br.condition);
+            auto trueCopies      = edgeCopies(br.iftrue);
+            auto falseCopies     = edgeCopies(br.iffalse);
+            _edges.branchIf(
+                _code,
+                condition,
+                br.iftrue,
+                std::move(trueCopies),
+                br.iffalse,
+                std::move(falseCopies)
+            );
+            return;
+        }
+
+        _edges.jump(_code, br.iftrue, edgeCopies(br.iftrue));
+    }
+
+    // Parallel copies for the phis of target on the edge from the current block.
+    auto edgeCopies(BlockId target) -> std::vector<Bytecode::Copy>
+    {
+        auto const& block = _func.blocks.at(static_cast<std::size_t>(target));
+
+        auto pending = std::vector<Bytecode::Copy>{};
+        for (auto i = block.begin; i != block.end; ++i) {
+            auto const& inst = _store.instructions().get(_func.instructions[i]);
+            if (inst.kind != InstKind::Phi) {
+                continue;
+            }
+
+            auto const incoming = _store.incoming(_store.phis().get(inst.phiId));
+            auto const found    = std::ranges::find(incoming, _block, &Incoming::block);
+            if (found == incoming.end()) {
+                raisef<std::runtime_error>("phi has no incoming value for block {}", int(_block));
+            }
+
+            auto const copy = Bytecode::Copy{.dst = slot(inst.result), .src = slot(found->value)};
+            if (copy.dst != copy.src) {
+                pending.push_back(copy);
+            }
+        }
+        return pending;
+    }
+
+    [[nodiscard]] auto slot(ValueId reg) -> std::uint32_t
+    {
+        auto& s = _slots.at(static_cast<std::size_t>(reg));
+        if (s == unassigned) {
+            s = _numSlots++;
+        }
+        return s;
+    }
+
+    [[nodiscard]] auto pc() const -> std::uint32_t
+    {
+        return static_cast<std::uint32_t>(_code.code.size());
+    }
+
+    auto emit(OpCode op, std::uint32_t dst = 0, std::uint32_t lhs = 0, std::uint32_t rhs = 0) -> void
+    {
+        _code.code.push_back(Bytecode::Inst{.op = op, .dst = dst, .lhs = lhs, .rhs = rhs});
+    }
+
+    SharedValueStore const& _store;
+    Function const& _func;
+    Bytecode _code;
+    std::vector<std::uint32_t> _slots;
+    std::vector<std::uint32_t> _labels;
+    EdgeEmitter<BlockId> _edges;
+    std::uint32_t _numSlots{0};
+    BlockId _block{noBlock};
+};
+
+}  // namespace
+
+auto compile(SharedValueStore const& store, FunctionId id, bool optimize) -> Bytecode
+{
+    auto code = Compiler{store, id}.run();
+    if (optimize) {
+        fuseSuperinstructions(code);
+        (void)compactFrame(code);
+    }
+    return code;
+}
+
+}  // namespace snir::v4
@@ -0,0 +1,14 @@
+#pragma once
+
+#include "snir/ir/Bytecode.hpp"
+#include "snir/ir/v4/SharedValueStore.hpp"
+
+namespace snir::v4 {
+
+/// \brief Lowers a function to the same bytecode as Bytecode::compile, so it
+/// runs on the Interpreter and every backend built on top of it. Slots,
+/// labels and types are looked up in dense arrays indexed by id.
+[[nodiscard]] auto compile(SharedValueStore const& store, FunctionId id, bool optimize = true)
+    -> Bytecode;
+
+}  // namespace snir::v4
@@ -0,0 +1,166 @@
+#include "Printer.hpp"
+
+#include "snir/ir/InstKind.hpp"
+#include "snir/ir/Type.hpp"
+#include "snir/ir/v4/SharedValueStore.hpp"
+
+#include "fmt/os.h"
+#include "fmt/ostream.h"
+
+#include <cstddef>
+#include <ostream>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace snir::v4 {
+
+Printer::Printer(std::ostream& out) : _out{out} {}
+
+auto Printer::operator()(SharedValueStore const& store) -> void
+{
+    for (auto i = 0zu; i < store.functions().size(); ++i) {
+        (*this)(store, FunctionId(i));
+    }
+}
+
+auto Printer::operator()(SharedValueStore const& store, FunctionId id) -> void
+{
+    auto const& func = store.functions().get(id);
+    _localIds.clear();
+
+    _preds.assign(func.blocks.size(), {});
+    for (auto b = 0zu; b < func.blocks.size(); ++b) {
+        auto const& block = func.blocks[b];
+        if (block.begin == block.end) {
+            continue;
+        }
+
+        auto const& last = store.instructions().get(func.instructions[block.end - 1U]);
+        if (last.kind == InstKind::Branch) {
+            auto const& br = store.branches().get(last.branchId);
+            _preds[static_cast<std::size_t>(br.iftrue)].push_back(BlockId(b));
+            if (br.iffalse != noBlock) {
+                _preds[static_cast<std::size_t>(br.iffalse)].push_back(BlockId(b));
+            }
+        }
+    }
+
+    fmt::print(_out, "define {} @{}(", func.type, func.identifier);
+    for (auto i = 0zu; i < func.arguments.size(); ++i) {
+        auto const arg = func.arguments[i];
+        auto const sep = i == 0 ? "" : ", ";
+        fmt::print(_out, "{}{} %{}", sep, store.values().get(arg).type, _localIds.add(arg));
+    }
+    fmt::println(_out, ") {{");
+
+    for (auto b = 0zu; b < func.blocks.size(); ++b) {
+        printBlock(store, func, BlockId(b));
+        if (b != func.blocks.size() - 1zu) {
+            fmt::println(_out, "");
+        }
+    }
+    fmt::println(_out, "}}\n");
+}
+
+auto Printer::printBlock(SharedValueStore const& store, Function const& func, BlockId id) -> void
+{
+    auto const& block = func.blocks[static_cast<std::size_t>(id)];
+    auto const& preds = _preds[static_cast<std::size_t>(id)];
+
+    fmt::print(_out, "{}:", _localIds.add(block.label));
+    if (not preds.empty()) {
+        auto const label = [&](BlockId pred) {
+            return _localIds.add(func.blocks[static_cast<std::size_t>(pred)].label);
+        };
+        fmt::print(_out, "\t\t\t\t\t\t; preds = %{}", label(preds[0]));
+        for (auto pred : std::span{preds}.subspan(1)) {
+            fmt::print(_out, ", %{}", label(pred));
+        }
+    }
+    fmt::println(_out, "");
+
+    for (auto i = block.begin; i != block.end; ++i) {
+        printInst(store, func, store.instructions().get(func.instructions[i]));
+    }
+}
+
+// NOLINTNEXTLINE(readability-function-cognitive-complexity)
+auto Printer::printInst(SharedValueStore const& store, Function const& func, Inst const& inst) -> void
+{
+    auto const formatValue = [&](ValueId val) { return fmt::format("%{}", _localIds.add(val)); };
+    auto const label = [&](BlockId block) {
+        return _localIds.add(func.blocks[static_cast<std::size_t>(block)].label);
+    };
+
+    auto const kind = inst.kind;
+    auto const type = inst.type;
+    switch (kind) {
+        case InstKind::Nop: {
+            fmt::println(_out, "  ; {}", kind);
+            break;
+        }
+        case InstKind::Const: {
+            auto const res = formatValue(inst.result);
+            fmt::println(_out, "  {} = {} {}", res, type, store.literals().get(inst.literalId));
+            break;
+        }
+        case InstKind::Return: {
+            if (type == Type::Void) {
+                fmt::println(_out, "  {} {}", kind, type);
+            } else {
+                auto const value = formatValue(store.unaryOps().get(inst.unaryOpId).operand);
+                fmt::println(_out, "  {} {} {}", kind, type, value);
+            }
+            break;
+        }
+        case InstKind::Branch: {
+            auto const& br = store.branches().get(inst.branchId);
+            if (br.condition == noValue) {
+                fmt::println(_out, "  {} label %{}", kind, label(br.iftrue));
+            } else {
+                auto const cond  = formatValue(br.condition);
+                auto const then  = label(br.iftrue);
+                auto const other = label(br.iffalse);
+                fmt::println(_out, "  {} i1 {}, label %{}, label %{}", kind, cond, then, other);
+            }
+            break;
+        }
+        case InstKind::Phi: {
+            auto const res = formatValue(inst.result);
+            fmt::print(_out, "  {} = {} {} ", res, kind, type);
+            auto const incoming = store.incoming(store.phis().get(inst.phiId));
+            for (auto i = 0zu; i < incoming.size(); ++i) {
+                auto const value = formatValue(incoming[i].value);
+                auto const block = label(incoming[i].block);
+                fmt::print(_out, "{}[ {}, %{} ]", i == 0 ? "" : ", ", value, block);
+            }
+            fmt::println(_out, "");
+            break;
+        }
+        case InstKind::IntCmp: {
+            auto const& op = store.binaryOps().get(inst.binaryOpId);
+            auto const res = formatValue(inst.result);
+            auto const lhs = formatValue(op.lhs);
+            auto const rhs = formatValue(op.rhs);
+            fmt::println(_out, "  {} = {} {} {} {}, {}", res, kind, op.compare, type, lhs, rhs);
+            break;
+        }
+        case InstKind::Trunc: {
+            auto const res   = formatValue(inst.result);
+            auto const value = formatValue(store.unaryOps().get(inst.unaryOpId).operand);
+            fmt::println(_out, "  {} = {} {} to {}", res, kind, value, type);
+            break;
+        }
+        default: {
+            auto const& op = store.binaryOps().get(inst.binaryOpId);
+            auto const res = formatValue(inst.result);
+            auto const lhs = formatValue(op.lhs);
+            auto const rhs = formatValue(op.rhs);
+            fmt::println(_out, "  {} = {} {} {}, {}", res, kind, type, lhs, rhs);
+            break;
+        }
+    }
+}
+
+}  // namespace snir::v4
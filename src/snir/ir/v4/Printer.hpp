@@ -0,0 +1,32 @@
+#pragma once
+
+#include "snir/core/LocalIdMap.hpp"
+#include "snir/ir/v4/SharedValueStore.hpp"
+
+#include <functional>
+#include <ostream>
+#include <vector>
+
+namespace snir::v4 {
+
+/// \brief Writes the same text as snir::Printer, the predecessors come from
+/// the branch records instead of a ControlFlowGraph analysis. A register
+/// that shares its number with a block label is printed by that number,
+/// not by its internal id.
+struct Printer
+{
+    explicit Printer(std::ostream& out);
+
+    auto operator()(SharedValueStore const& store) -> void;
+    auto operator()(SharedValueStore const& store, FunctionId id) -> void;
+
+private:
+    auto printBlock(SharedValueStore const& store, Function const& func, BlockId id) -> void;
+    auto printInst(SharedValueStore const& store, Function const& func, Inst const& inst) -> void;
+
+    std::reference_wrapper<std::ostream> _out;
+    LocalIdMap<ValueId, int> _localIds;
+    std::vector<std::vector<BlockId>> _preds;
+};
+
+}  // namespace snir::v4
@@ -0,0 +1,212 @@
+#include "Reader.hpp"
+
+#include "snir/core/Exception.hpp"
+#include "snir/ir/BasicBlock.hpp"
+#include "snir/ir/Branch.hpp"
+#include "snir/ir/CompareKind.hpp"
+#include "snir/ir/Function.hpp"
+#include "snir/ir/InstKind.hpp"
+#include "snir/ir/Literal.hpp"
+#include "snir/ir/Module.hpp"
+#include "snir/ir/Operands.hpp"
+#include "snir/ir/Parser.hpp"
+#include "snir/ir/Phi.hpp"
+#include "snir/ir/Registry.hpp"
+#include "snir/ir/Result.hpp"
+#include "snir/ir/Type.hpp"
+#include "snir/ir/v4/SharedValueStore.hpp"
+#include "snir/ir/ValueId.hpp"
+#include "snir/ir/ValueKind.hpp"
+
+#include <cstdint>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace snir::v4 {
+
+namespace {
+
+struct Converter
+{
+    Converter(Registry& registry, SharedValueStore& store) : _registry{&registry}, _store{&store} {}
+
+    auto run(snir::Function const& func) -> void
+    {
+        _values.clear();
+        _blocks.clear();
+        _types.clear();
+
+        auto result = Function{
+            .identifier   = std::string{func.identifier()},
+            .type         = func.type(),
+            .arguments    = {},
+            .blocks       = {},
+            .instructions = {},
+        };
+
+        collectTypes(func);
+        for (auto const& block : func.basicBlocks()) {
+            _blocks.emplace(block.label, BlockId(_blocks.size()));
+        }
+        for (auto const arg : func.arguments()) {
+            _types.emplace(arg, _registry->get<Type>(arg));
+            result.arguments.push_back(value(arg));
+        }
+
+        for (auto const& block : func.basicBlocks()) {
+            auto converted = Block{.label = label(block.label)};
+            converted.begin = static_cast<std::uint32_t>(result.instructions.size());
+            for (auto const inst : block.instructions) {
+                result.instructions.push_back(convert(inst));
+            }
+            converted.end = static_cast<std::uint32_t>(result.instructions.size());
+            result.blocks.push_back(converted);
+        }
+
+        (void)_store->functions().add(std::move(result));
+    }
+
+private:
+    // Uses can come before the definition in loops, all result types have
+    // to be known before any instruction is converted.
+    auto collectTypes(snir::Function const& func) -> void
+    {
+        for (auto const& block : func.basicBlocks()) {
+            for (auto const inst : block.instructions) {
+                if (auto const* result = _registry->try_get<Result>(inst); result != nullptr) {
+                    auto const [kind, type] = _registry->get<InstKind, Type>(inst);
+                    _types.emplace(result->id, kind == InstKind::IntCmp ? Type::Bool : type);
+                }
+            }
+        }
+    }
+
+    // NOLINTNEXTLINE(readability-function-cognitive-complexity)
+    [[nodiscard]] auto convert(snir::ValueId id) -> InstId
+    {
+        auto const [kind, type] = _registry->get<InstKind, Type>(id);
+        auto inst               = Inst{};
+        inst.kind               = kind;
+        inst.type               = type;
+        if (auto const* result = _registry->try_get<Result>(id); result != nullptr) {
+            inst.result = value(result->id);
+        }
+
+        switch (kind) {
+            case InstKind::Nop: break;
+            case InstKind::Const: {
+                inst.literalId = _store->literals().add(_registry->get<Literal>(id));
+                break;
+            }
+            case InstKind::Return: {
+                if (type != Type::Void) {
+                    auto const& ops = _registry->get<Operands>(id);
+                    inst.unaryOpId  = _store->unaryOps().add(UnaryOp{.operand = value(ops.list[0])});
+                }
+                break;
+            }
+            case InstKind::Branch: {
+                auto const& br       = _registry->get<snir::Branch>(id);
+                auto const converted = Branch{
+                    .condition = br.condition ? value(*br.condition) : noValue,
+                    .iftrue    = block(br.iftrue),
+                    .iffalse   = br.iffalse ? block(*br.iffalse) : noBlock,
+                };
+                inst.branchId = _store->branches().add(converted);
+                break;
+            }
+            case InstKind::Phi: {
+                auto incoming = std::vector<Incoming>{};
+                for (auto const& in : _registry->get<snir::Phi>(id).incoming) {
+                    incoming.push_back(Incoming{.value = value(in.value), .block = block(in.block)});
+                }
+                inst.phiId = _store->addPhi(incoming);
+                break;
+            }
+            case InstKind::Trunc: {
+                auto const& ops = _registry->get<Operands>(id);
+                inst.unaryOpId  = _store->unaryOps().add(UnaryOp{.operand = value(ops.list[0])});
+                break;
+            }
+            default: {
+                auto const& ops = _registry->get<Operands>(id);
+                auto op         = BinaryOp{.lhs = value(ops.list[0]), .rhs = value(ops.list[1])};
+                if (kind == InstKind::IntCmp) {
+                    op.compare = _registry->get<CompareKind>(id);
+                }
+                inst.binaryOpId = _store->binaryOps().add(op);
+                break;
+            }
+        }
+
+        return _store->instructions().add(inst);
+    }
+
+    [[nodiscard]] auto value(snir::ValueId id) -> ValueId
+    {
+        if (auto const found = _values.find(id); found != _values.end()) {
+            return found->second;
+        }
+
+        auto const type = _types.find(id);
+        if (type == _types.end()) {
+            raisef<std::runtime_error>("use of undefined register {}", int(id));
+        }
+
+        auto const reg    = Value{.kind = ValueKind::Register, .type = type->second};
+        auto const result = _store->values().add(reg);
+        _values.emplace(id, result);
+        return result;
+    }
+
+    [[nodiscard]] auto label(snir::ValueId id) -> ValueId
+    {
+        if (auto const found = _values.find(id); found != _values.end()) {
+            return found->second;
+        }
+
+        auto const result = _store->values().add(Value{.kind = ValueKind::Label, .type = Type::Void});
+        _values.emplace(id, result);
+        return result;
+    }
+
+    [[nodiscard]] auto block(snir::ValueId id) const -> BlockId
+    {
+        auto const found = _blocks.find(id);
+        if (found == _blocks.end()) {
+            raisef<std::runtime_error>("unknown block {}", int(id));
+        }
+        return found->second;
+    }
+
+    Registry* _registry;
+    SharedValueStore* _store;
+    std::map<snir::ValueId, ValueId> _values;
+    std::map<snir::ValueId, BlockId> _blocks;
+    std::map<snir::ValueId, Type> _types;
+};
+
+}  // namespace
+
+auto fromModule(Module& module) -> SharedValueStore
+{
+    auto store = SharedValueStore{};
+    for (auto const& func : module.functions()) {
+        Converter{*func.asValue().registry(), store}.run(func);
+    }
+    return store;
+}
+
+auto read(std::string_view source) -> SharedValueStore
+{
+    auto registry = Registry{};
+    auto parser   = Parser{registry};
+    auto module   = parser.read(source);
+    return fromModule(module);
+}
+
+}  // namespace snir::v4
@@ -0,0 +1,18 @@
+#pragma once
+
+#include "snir/ir/Module.hpp"
+#include "snir/ir/v4/SharedValueStore.hpp"
+
+#include <string_view>
+
+namespace snir::v4 {
+
+/// \brief Converts every function of a registry based module. Registers
+/// and labels are numbered densely per store in order of appearance.
+[[nodiscard]] auto fromModule(Module& module) -> SharedValueStore;
+
+/// \brief Parses source with the registry based Parser and converts it.
+/// The text format is only defined once, the registry is dropped after.
+[[nodiscard]] auto read(std::string_view source) -> SharedValueStore;
+
+}  // namespace snir::v4
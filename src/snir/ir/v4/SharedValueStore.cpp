@@ -0,0 +1,39 @@
+#include "SharedValueStore.hpp"
+
+#include "snir/ir/Literal.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace snir::v4 {
+
+auto SharedValueStore::addPhi(std::span<Incoming const> incoming) -> PhiId
+{
+    auto const first = static_cast<std::uint32_t>(_incoming.size());
+    _incoming.insert(_incoming.end(), incoming.begin(), incoming.end());
+    return _phis.add(Phi{.first = first, .count = static_cast<std::uint32_t>(incoming.size())});
+}
+
+auto SharedValueStore::memoryUsage() const -> std::size_t
+{
+    auto bytes = _values.size() * sizeof(Value);
+    bytes += _instructions.size() * sizeof(Inst);
+    bytes += _unaryOps.size() * sizeof(UnaryOp);
+    bytes += _binaryOps.size() * sizeof(BinaryOp);
+    bytes += _branches.size() * sizeof(Branch);
+    bytes += _phis.size() * sizeof(Phi);
+    bytes += _literals.size() * sizeof(Literal);
+    bytes += _incoming.size() * sizeof(Incoming);
+
+    for (auto i = 0zu; i < _functions.size(); ++i) {
+        auto const& func = _functions.get(FunctionId(i));
+        bytes += sizeof(Function);
+        bytes += func.arguments.size() * sizeof(ValueId);
+        bytes += func.blocks.size() * sizeof(Block);
+        bytes += func.instructions.size() * sizeof(InstId);
+    }
+    return bytes;
+}
+
+}  // namespace snir::v4
@@ -0,0 +1,196 @@
+#pragma once
+
+#include "snir/core/ValueStore.hpp"
+#include "snir/ir/CompareKind.hpp"
+#include "snir/ir/InstKind.hpp"
+#include "snir/ir/Literal.hpp"
+#include "snir/ir/Type.hpp"
+#include "snir/ir/ValueKind.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+// Structure-of-arrays storage for the IR. Every record kind lives in its own
+// ValueStore and refers to the others through typed 32-bit indices, instead
+// of one registry entity per value with separately pooled components.
+
+namespace snir::v4 {
+
+enum struct ValueId : std::int32_t
+{
+};
+enum struct InstId : std::int32_t
+{
+};
+enum struct UnaryOpId : std::int32_t
+{
+};
+enum struct BinaryOpId : std::int32_t
+{
+};
+enum struct BranchId : std::int32_t
+{
+};
+enum struct PhiId : std::int32_t
+{
+};
+enum struct LiteralId : std::int32_t
+{
+};
+enum struct BlockId : std::int32_t
+{
+};
+enum struct FunctionId : std::int32_t
+{
+};
+
+inline constexpr auto noValue = ValueId{-1};
+inline constexpr auto noBlock = BlockId{-1};
+
+/// \brief Register or block label.
+struct Value
+{
+    ValueKind kind{ValueKind::Register};
+    Type type{Type::Void};
+};
+
+/// \brief Common part of every instruction, the operands are in the store
+/// selected by kind.
+struct Inst
+{
+    InstKind kind{InstKind::Nop};
+    Type type{Type::Void};
+    ValueId result{noValue};
+
+    union
+    {
+        std::int32_t payload{-1};
+        UnaryOpId unaryOpId;
+        BinaryOpId binaryOpId;
+        BranchId branchId;
+        PhiId phiId;
+        LiteralId literalId;
+    };
+};
+
+/// \brief Operand of ret and trunc.
+struct UnaryOp
+{
+    ValueId operand{noValue};
+};
+
+/// \brief Operands of arithmetic and icmp, compare is only used by icmp.
+struct BinaryOp
+{
+    ValueId lhs{noValue};
+    ValueId rhs{noValue};
+    CompareKind compare{CompareKind::Equal};
+};
+
+struct Branch
+{
+    ValueId condition{noValue};
+    BlockId iftrue{noBlock};
+    BlockId iffalse{noBlock};
+};
+
+struct Incoming
+{
+    ValueId value{noValue};
+    BlockId block{noBlock};
+};
+
+/// \brief Range of incoming values in SharedValueStore::incoming().
+struct Phi
+{
+    std::uint32_t first{0};
+    std::uint32_t count{0};
+};
+
+/// \brief Range of instructions in Function::instructions.
+struct Block
+{
+    ValueId label{noValue};
+    std::uint32_t begin{0};
+    std::uint32_t end{0};
+};
+
+struct Function
+{
+    std::string identifier;
+    Type type{Type::Void};
+    std::vector<ValueId> arguments;
+    std::vector<Block> blocks;
+    std::vector<InstId> instructions;
+};
+
+struct SharedValueStore
+{
+    SharedValueStore()  = default;
+    ~SharedValueStore() = default;
+
+    SharedValueStore(SharedValueStore const& other)                    = delete;
+    auto operator=(SharedValueStore const& other) -> SharedValueStore& = delete;
+
+    SharedValueStore(SharedValueStore&& other)                    = default;
+    auto operator=(SharedValueStore&& other) -> SharedValueStore& = default;
+
+    [[nodiscard]] auto values() -> ValueStore<ValueId, Value>& { return _values; }
+    [[nodiscard]] auto values() const -> ValueStore<ValueId, Value> const& { return _values; }
+
+    [[nodiscard]] auto instructions() -> ValueStore<InstId, Inst>& { return _instructions; }
+    [[nodiscard]] auto instructions() const -> ValueStore<InstId, Inst> const&
+    {
+        return _instructions;
+    }
+
+    [[nodiscard]] auto unaryOps() -> ValueStore<UnaryOpId, UnaryOp>& { return _unaryOps; }
+    [[nodiscard]] auto unaryOps() const -> ValueStore<UnaryOpId, UnaryOp> const& { return _unaryOps; }
+
+    [[nodiscard]] auto binaryOps() -> ValueStore<BinaryOpId, BinaryOp>& { return _binaryOps; }
+    [[nodiscard]] auto binaryOps() const -> ValueStore<BinaryOpId, BinaryOp> const&
+    {
+        return _binaryOps;
+    }
+
+    [[nodiscard]] auto branches() -> ValueStore<BranchId, Branch>& { return _branches; }
+    [[nodiscard]] auto branches() const -> ValueStore<BranchId, Branch> const& { return _branches; }
+
+    [[nodiscard]] auto phis() -> ValueStore<PhiId, Phi>& { return _phis; }
+    [[nodiscard]] auto phis() const -> ValueStore<PhiId, Phi> const& { return _phis; }
+
+    [[nodiscard]] auto literals() -> ValueStore<LiteralId, Literal>& { return _literals; }
+    [[nodiscard]] auto literals() const -> ValueStore<LiteralId, Literal> const& { return _literals; }
+
+    [[nodiscard]] auto functions() -> ValueStore<FunctionId, Function>& { return _functions; }
+    [[nodiscard]] auto functions() const -> ValueStore<FunctionId, Function> const&
+    {
+        return _functions;
+    }
+
+    [[nodiscard]] auto incoming(Phi phi) const -> std::span<Incoming const>
+    {
+        return std::span{_incoming}.subspan(phi.first, phi.count);
+    }
+
+    [[nodiscard]] auto addPhi(std::span<Incoming const> incoming) -> PhiId;
+
+    /// \brief Bytes held by all stores, excluding function identifiers.
+    [[nodiscard]] auto memoryUsage() const -> std::size_t;
+
+private:
+    ValueStore<ValueId, Value> _values;
+    ValueStore<InstId, Inst> _instructions;
+    ValueStore<UnaryOpId, UnaryOp> _unaryOps;
+    ValueStore<BinaryOpId, BinaryOp> _binaryOps;
+    ValueStore<BranchId, Branch> _branches;
+    ValueStore<PhiId, Phi> _phis;
+    ValueStore<LiteralId, Literal> _literals;
+    ValueStore<FunctionId, Function> _functions;
+    std::vector<Incoming> _incoming;
+};
+
+}  // namespace snir::v4
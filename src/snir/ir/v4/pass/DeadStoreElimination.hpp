@@ -0,0 +1,92 @@
+#pragma once
+
+#include "snir/ir/InstKind.hpp"
+#include "snir/ir/Type.hpp"
+#include "snir/ir/v4/SharedValueStore.hpp"
+
+#include <cstddef>
+#include <ranges>
+#include <string_view>
+#include <vector>
+
+namespace snir::v4 {
+
+/// \brief Turns instructions whose result is never read into nops, the
+/// used set is a bit per value of the store.
+struct DeadStoreElimination
+{
+    static constexpr auto name = std::string_view{"DeadStoreElimination"};
+
+    DeadStoreElimination() = default;
+
+    auto operator()(SharedValueStore& store, FunctionId id) -> void
+    {
+        auto& func = store.functions().get(id);
+        _used.assign(store.values().size(), false);
+
+        // Loops read these values in blocks that are visited before the definition.
+        for (auto const inst : func.instructions) {
+            markControlFlowUses(store, store.instructions().get(inst));
+        }
+
+        for (auto const& block : std::ranges::reverse_view(func.blocks)) {
+            for (auto i = block.end; i != block.begin; --i) {
+                auto& inst = store.instructions().get(func.instructions[i - 1U]);
+                if (inst.result != noValue and not used(inst.result)) {
+                    inst = Inst{};
+                    continue;
+                }
+                markOperands(store, inst);
+            }
+        }
+    }
+
+private:
+    auto markControlFlowUses(SharedValueStore const& store, Inst const& inst) -> void
+    {
+        if (inst.kind == InstKind::Branch) {
+            if (auto const& br = store.branches().get(inst.branchId); br.condition != noValue) {
+                mark(br.condition);
+            }
+        }
+        if (inst.kind == InstKind::Phi) {
+            for (auto const& incoming : store.incoming(store.phis().get(inst.phiId))) {
+                mark(incoming.value);
+            }
+        }
+    }
+
+    auto markOperands(SharedValueStore const& store, Inst const& inst) -> void
+    {
+        switch (inst.kind) {
+            case InstKind::Nop:
+            case InstKind::Const:
+            case InstKind::Branch:
+            case InstKind::Phi: break;
+            case InstKind::Return: {
+                if (inst.type != Type::Void) {
+                    mark(store.unaryOps().get(inst.unaryOpId).operand);
+                }
+                break;
+            }
+            case InstKind::Trunc: mark(store.unaryOps().get(inst.unaryOpId).operand); break;
+            default: {
+                auto const& op = store.binaryOps().get(inst.binaryOpId);
+                mark(op.lhs);
+                mark(op.rhs);
+                break;
+            }
+        }
+    }
+
+    [[nodiscard]] auto used(ValueId value) const -> bool
+    {
+        return _used[static_cast<std::size_t>(value)];
+    }
+
+    auto mark(ValueId value) -> void { _used[static_cast<std::size_t>(value)] = true; }
+
+    std::vector<bool> _used;
+};
+
+}  // namespace snir::v4
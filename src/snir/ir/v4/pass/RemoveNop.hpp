@@ -0,0 +1,38 @@
+#pragma once
+
+#include "snir/ir/InstKind.hpp"
+#include "snir/ir/v4/SharedValueStore.hpp"
+
+#include <cstdint>
+#include <string_view>
+
+namespace snir::v4 {
+
+/// \brief Compacts the instruction list of a function in a single sweep and
+/// moves the block ranges along.
+struct RemoveNop
+{
+    static constexpr auto name = std::string_view{"RemoveNop"};
+
+    RemoveNop() = default;
+
+    auto operator()(SharedValueStore& store, FunctionId id) -> void
+    {
+        auto& func = store.functions().get(id);
+        auto out   = std::uint32_t{0};
+        for (auto& block : func.blocks) {
+            auto const begin = out;
+            for (auto i = block.begin; i != block.end; ++i) {
+                auto const inst = func.instructions[i];
+                if (store.instructions().get(inst).kind != InstKind::Nop) {
+                    func.instructions[out++] = inst;
+                }
+            }
+            block.begin = begin;
+            block.end   = out;
+        }
+        func.instructions.resize(out);
+    }
+};
+
+}  // namespace snir::v4
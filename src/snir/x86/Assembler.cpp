@@ -0,0 +1,277 @@
+#include "Assembler.hpp"
+
+#include <cstdint>
+
+namespace snir::x86 {
+
+namespace {
+
+[[nodiscard]] constexpr auto id(Gpr reg) -> std::uint8_t { return static_cast<std::uint8_t>(reg); }
+
+[[nodiscard]] constexpr auto id(Xmm reg) -> std::uint8_t { return static_cast<std::uint8_t>(reg); }
+
+[[nodiscard]] constexpr auto prefix(Precision precision) -> std::uint8_t
+{
+    return precision == Precision::Single ? 0xF3 : 0xF2;
+}
+
+}  // namespace
+
+auto Assembler::offset() const noexcept -> std::uint32_t
+{
+    return static_cast<std::uint32_t>(_code.size());
+}
+
+auto Assembler::push(Gpr reg) -> void
+{
+    rex(false, 0, id(reg));
+    byte(0x50 + (id(reg) & 7U));
+}
+
+auto Assembler::pop(Gpr reg) -> void
+{
+    rex(false, 0, id(reg));
+    byte(0x58 + (id(reg) & 7U));
+}
+
+auto Assembler::ret() -> void { byte(0xC3); }
+
+auto Assembler::leave() -> void { byte(0xC9); }
+
+auto Assembler::ud2() -> void
+{
+    byte(0x0F);
+    byte(0x0B);
+}
+
+auto Assembler::mov(Gpr dst, Gpr src) -> void
+{
+    rex(true, id(src), id(dst));
+    byte(0x89);
+    modrm(3, id(src), id(dst));
+}
+
+auto Assembler::mov(Gpr dst, std::int32_t disp) -> void
+{
+    rex(true, id(dst), id(Gpr::Rbp));
+    byte(0x8B);
+    memory(id(dst), disp);
+}
+
+auto Assembler::mov(std::int32_t disp, Gpr src) -> void
+{
+    rex(true, id(src), id(Gpr::Rbp));
+    byte(0x89);
+    memory(id(src), disp);
+}
+
+auto Assembler::mov(Gpr dst, std::uint64_t imm) -> void
+{
+    rex(true, 0, id(dst));
+    byte(0xB8 + (id(dst) & 7U));
+    for (auto i = 0U; i < 8U; ++i) {
+        byte(static_cast<std::uint8_t>(imm >> (i * 8U)));
+    }
+}
+
+auto Assembler::movzxByte(Gpr dst, std::int32_t disp) -> void
+{
+    rex(false, id(dst), id(Gpr::Rbp));
+    byte(0x0F);
+    byte(0xB6);
+    memory(id(dst), disp);
+}
+
+auto Assembler::subImm(Gpr dst, std::int32_t imm) -> void
+{
+    rex(true, 0, id(dst));
+    byte(0x81);
+    modrm(3, 5, id(dst));
+    imm32(static_cast<std::uint32_t>(imm));
+}
+
+auto Assembler::alu(Alu op, Gpr dst, Gpr src) -> void
+{
+    rex(true, id(src), id(dst));
+    byte(static_cast<std::uint8_t>(op));
+    modrm(3, id(src), id(dst));
+}
+
+auto Assembler::imul(Gpr dst, Gpr src) -> void
+{
+    rex(true, id(dst), id(src));
+    byte(0x0F);
+    byte(0xAF);
+    modrm(3, id(dst), id(src));
+}
+
+auto Assembler::shift(Shift op, Gpr dst) -> void
+{
+    rex(true, 0, id(dst));
+    byte(0xD3);
+    modrm(3, static_cast<std::uint8_t>(op), id(dst));
+}
+
+auto Assembler::cqo() -> void
+{
+    byte(0x48);
+    byte(0x99);
+}
+
+auto Assembler::idiv(Gpr src) -> void
+{
+    rex(true, 0, id(src));
+    byte(0xF7);
+    modrm(3, 7, id(src));
+}
+
+auto Assembler::test(Gpr lhs, Gpr rhs) -> void
+{
+    rex(true, id(rhs), id(lhs));
+    byte(0x85);
+    modrm(3, id(rhs), id(lhs));
+}
+
+auto Assembler::setAndZeroExtend(Cond cond, Gpr dst) -> void
+{
+    // spl, bpl, sil and dil are only reachable with a rex prefix
+    auto const needsRex = id(dst) >= 4U;
+    if (needsRex) {
+        byte(0x40 | (id(dst) >> 3U));
+    }
+    byte(0x0F);
+    byte(0x90 + static_cast<std::uint8_t>(cond));
+    modrm(3, 0, id(dst));
+
+    if (needsRex) {
+        byte(0x40 | ((id(dst) >> 3U) << 2U) | (id(dst) >> 3U));
+    }
+    byte(0x0F);
+    byte(0xB6);
+    modrm(3, id(dst), id(dst));
+}
+
+auto Assembler::jmp() -> std::uint32_t
+{
+    byte(0xE9);
+    imm32(0);
+    return offset() - 4U;
+}
+
+auto Assembler::jcc(Cond cond) -> std::uint32_t
+{
+    byte(0x0F);
+    byte(0x80 + static_cast<std::uint8_t>(cond));
+    imm32(0);
+    return offset() - 4U;
+}
+
+auto Assembler::patch(std::uint32_t at, std::uint32_t target) -> void
+{
+    auto const rel = target - (at + 4U);
+    for (auto i = 0U; i < 4U; ++i) {
+        _code.at(at + i) = static_cast<std::uint8_t>(rel >> (i * 8U));
+    }
+}
+
+auto Assembler::movq(Xmm dst, Gpr src) -> void
+{
+    byte(0x66);
+    rex(true, id(dst), id(src));
+    byte(0x0F);
+    byte(0x6E);
+    modrm(3, id(dst), id(src));
+}
+
+auto Assembler::movq(Gpr dst, Xmm src) -> void
+{
+    byte(0x66);
+    rex(true, id(src), id(dst));
+    byte(0x0F);
+    byte(0x7E);
+    modrm(3, id(src), id(dst));
+}
+
+auto Assembler::movd(Xmm dst, Gpr src) -> void
+{
+    byte(0x66);
+    rex(false, id(dst), id(src));
+    byte(0x0F);
+    byte(0x6E);
+    modrm(3, id(dst), id(src));
+}
+
+auto Assembler::movd(Gpr dst, Xmm src) -> void
+{
+    byte(0x66);
+    rex(false, id(src), id(dst));
+    byte(0x0F);
+    byte(0x7E);
+    modrm(3, id(src), id(dst));
+}
+
+auto Assembler::sse(SseOp op, Precision precision, Xmm dst, Xmm src) -> void
+{
+    byte(prefix(precision));
+    rex(false, id(dst), id(src));
+    byte(0x0F);
+    byte(static_cast<std::uint8_t>(op));
+    modrm(3, id(dst), id(src));
+}
+
+auto Assembler::cvtToFloat(Precision precision, Xmm dst, Gpr src) -> void
+{
+    byte(prefix(precision));
+    rex(true, id(dst), id(src));
+    byte(0x0F);
+    byte(0x2A);
+    modrm(3, id(dst), id(src));
+}
+
+auto Assembler::cvtToInt(Precision precision, Gpr dst, Xmm src) -> void
+{
+    byte(prefix(precision));
+    rex(true, id(dst), id(src));
+    byte(0x0F);
+    byte(0x2C);
+    modrm(3, id(dst), id(src));
+}
+
+auto Assembler::cvtFloat(Precision from, Xmm dst, Xmm src) -> void
+{
+    byte(prefix(from));
+    rex(false, id(dst), id(src));
+    byte(0x0F);
+    byte(0x5A);
+    modrm(3, id(dst), id(src));
+}
+
+auto Assembler::byte(std::uint8_t value) -> void { _code.push_back(value); }
+
+auto Assembler::imm32(std::uint32_t value) -> void
+{
+    for (auto i = 0U; i < 4U; ++i) {
+        byte(static_cast<std::uint8_t>(value >> (i * 8U)));
+    }
+}
+
+auto Assembler::rex(bool wide, std::uint8_t reg, std::uint8_t rm) -> void
+{
+    auto const value = 0x40U | (wide ? 0x08U : 0U) | ((reg >> 3U) << 2U) | (rm >> 3U);
+    if (value != 0x40U) {
+        byte(static_cast<std::uint8_t>(value));
+    }
+}
+
+auto Assembler::modrm(std::uint8_t mod, std::uint8_t reg, std::uint8_t rm) -> void
+{
+    byte(static_cast<std::uint8_t>((mod << 6U) | ((reg & 7U) << 3U) | (rm & 7U)));
+}
+
+auto Assembler::memory(std::uint8_t reg, std::int32_t disp) -> void
+{
+    modrm(2, reg, id(Gpr::Rbp));
+    imm32(static_cast<std::uint32_t>(disp));
+}
+
+}  // namespace snir::x86
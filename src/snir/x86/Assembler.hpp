@@ -0,0 +1,134 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace snir::x86 {
+
+enum struct Gpr : std::uint8_t
+{
+    Rax,
+    Rcx,
+    Rdx,
+    Rbx,
+    Rsp,
+    Rbp,
+    Rsi,
+    Rdi,
+    R8,
+    R9,
+    R10,
+    R11,
+    R12,
+    R13,
+    R14,
+    R15,
+};
+
+enum struct Xmm : std::uint8_t
+{
+    Xmm0,
+    Xmm1,
+    Xmm2,
+    Xmm3,
+    Xmm4,
+    Xmm5,
+    Xmm6,
+    Xmm7,
+};
+
+enum struct Alu : std::uint8_t
+{
+    Add = 0x01,
+    Or  = 0x09,
+    And = 0x21,
+    Sub = 0x29,
+    Xor = 0x31,
+    Cmp = 0x39,
+};
+
+enum struct Shift : std::uint8_t
+{
+    Left  = 4,
+    Right = 5,
+};
+
+enum struct Cond : std::uint8_t
+{
+    Equal    = 0x4,
+    NotEqual = 0x5,
+};
+
+/// \brief Scalar SSE arithmetic, the opcode byte after 0F.
+enum struct SseOp : std::uint8_t
+{
+    Add = 0x58,
+    Mul = 0x59,
+    Sub = 0x5C,
+    Div = 0x5E,
+};
+
+enum struct Precision : std::uint8_t
+{
+    Single,
+    Double,
+};
+
+/// \brief Byte encoder for the x86-64 subset used by the code generator.
+/// Memory operands are always [rbp + disp32].
+struct Assembler
+{
+    Assembler() = default;
+
+    [[nodiscard]] auto code() const noexcept -> std::span<std::uint8_t const> { return _code; }
+    [[nodiscard]] auto offset() const noexcept -> std::uint32_t;
+    [[nodiscard]] auto release() -> std::vector<std::uint8_t> { return std::move(_code); }
+
+    auto push(Gpr reg) -> void;
+    auto pop(Gpr reg) -> void;
+    auto ret() -> void;
+    auto leave() -> void;
+    auto ud2() -> void;
+
+    auto mov(Gpr dst, Gpr src) -> void;
+    auto mov(Gpr dst, std::int32_t disp) -> void;
+    auto mov(std::int32_t disp, Gpr src) -> void;
+    auto mov(Gpr dst, std::uint64_t imm) -> void;
+    auto movzxByte(Gpr dst, std::int32_t disp) -> void;
+    auto subImm(Gpr dst, std::int32_t imm) -> void;
+
+    auto alu(Alu op, Gpr dst, Gpr src) -> void;
+    auto imul(Gpr dst, Gpr src) -> void;
+    auto shift(Shift op, Gpr dst) -> void;
+    auto cqo() -> void;
+    auto idiv(Gpr src) -> void;
+    auto test(Gpr lhs, Gpr rhs) -> void;
+    auto setAndZeroExtend(Cond cond, Gpr dst) -> void;
+
+    /// Emits the jump with a zero rel32 and returns the offset to patch.
+    [[nodiscard]] auto jmp() -> std::uint32_t;
+    [[nodiscard]] auto jcc(Cond cond) -> std::uint32_t;
+    auto patch(std::uint32_t at, std::uint32_t target) -> void;
+
+    auto movq(Xmm dst, Gpr src) -> void;
+    auto movq(Gpr dst, Xmm src) -> void;
+    auto movd(Xmm dst, Gpr src) -> void;
+    auto movd(Gpr dst, Xmm src) -> void;
+    auto sse(SseOp op, Precision precision, Xmm dst, Xmm src) -> void;
+    auto cvtToFloat(Precision precision, Xmm dst, Gpr src) -> void;
+    auto cvtToInt(Precision precision, Gpr dst, Xmm src) -> void;
+    auto cvtFloat(Precision from, Xmm dst, Xmm src) -> void;
+
+private:
+    auto byte(std::uint8_t value) -> void;
+    auto imm32(std::uint32_t value) -> void;
+    auto rex(bool wide, std::uint8_t reg, std::uint8_t rm) -> void;
+    auto modrm(std::uint8_t mod, std::uint8_t reg, std::uint8_t rm) -> void;
+    auto memory(std::uint8_t reg, std::int32_t disp) -> void;
+
+    std::vector<std::uint8_t> _code;
+};
+
+}  // namespace snir::x86
@@ -0,0 +1,386 @@
+#include "CodeGen.hpp"
+
+#include "snir/core/Exception.hpp"
+#include "snir/ir/Bytecode.hpp"
+#include "snir/ir/OpCode.hpp"
+#include "snir/ir/Type.hpp"
+#include "snir/x86/Assembler.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <numeric>
+#include <optional>
+#include <stdexcept>
+#include <vector>
+
+namespace snir::x86 {
+
+namespace {
+
+// Caller saved and not needed by any instruction template. The generated
+// code never calls out, so they need no spilling.
+constexpr auto allocatable = std::array{Gpr::Rsi, Gpr::Rdi, Gpr::R8, Gpr::R9, Gpr::R10, Gpr::R11};
+
+constexpr auto intArguments = std::array{Gpr::Rdi, Gpr::Rsi, Gpr::Rdx, Gpr::Rcx, Gpr::R8, Gpr::R9};
+
+constexpr auto floatArguments = std::array{
+    Xmm::Xmm0,
+    Xmm::Xmm1,
+    Xmm::Xmm2,
+    Xmm::Xmm3,
+    Xmm::Xmm4,
+    Xmm::Xmm5,
+    Xmm::Xmm6,
+    Xmm::Xmm7,
+};
+
+struct Fixup
+{
+    std::uint32_t at;
+    std::uint32_t target;
+};
+
+struct CodeGenerator
+{
+    explicit CodeGenerator(Bytecode const& code) : _code{code}, _registers(code.registers) {}
+
+    [[nodiscard]] auto run() -> std::vector<std::uint8_t>
+    {
+        allocateRegisters();
+        prologue();
+
+        auto labels = std::vector<std::uint32_t>(_code.code.size());
+        for (auto pc = 0U; pc < _code.code.size(); ++pc) {
+            labels[pc] = _asm.offset();
+            emitInst(pc, _code.code[pc]);
+        }
+
+        for (auto const& fixup : _fixups) {
+            _asm.patch(fixup.at, labels.at(fixup.target));
+        }
+        return _asm.release();
+    }
+
+private:
+    // Keeps the most accessed slots in registers, every other slot lives
+    // in its home on the stack.
+    auto allocateRegisters() -> void
+    {
+        auto uses = std::vector<std::size_t>(_code.registers, 0);
+        for (auto const& inst : _code.code) {
+            forEachRead(inst, [&uses](std::uint32_t slot) { ++uses[slot]; });
+            forEachWrite(inst, [&uses](std::uint32_t slot) { ++uses[slot]; });
+        }
+        for (auto const& copy : _code.copies) {
+            ++uses[copy.src];
+            ++uses[copy.dst];
+        }
+
+        auto order = std::vector<std::uint32_t>(_code.registers);
+        std::iota(order.begin(), order.end(), 0U);
+        std::ranges::stable_sort(order, std::greater{}, [&uses](auto slot) { return uses[slot]; });
+
+        auto const count = std::min(order.size(), allocatable.size());
+        for (auto i = 0zu; i < count; ++i) {
+            if (uses[order[i]] != 0) {
+                _registers[order[i]] = allocatable[i];
+            }
+        }
+    }
+
+    auto prologue() -> void
+    {
+        _asm.push(Gpr::Rbp);
+        _asm.mov(Gpr::Rbp, Gpr::Rsp);
+        if (auto const size = (_code.registers * 8U + 15U) & ~15U; size != 0U) {
+            _asm.subImm(Gpr::Rsp, static_cast<std::int32_t>(size));
+        }
+
+        // Spill all incoming arguments first, their registers overlap with
+        // the allocatable set.
+        auto ints   = 0zu;
+        auto floats = 0zu;
+        for (auto slot = 0U; slot < _code.arguments.size(); ++slot) {
+            auto const type = _code.arguments[slot];
+            if (type == Type::Int64 or type == Type::Bool) {
+                if (ints == intArguments.size()) {
+                    raisef<std::runtime_error>("too many integer arguments for x86-64");
+                }
+                _asm.mov(home(slot), intArguments[ints++]);
+                if (type == Type::Bool) {
+                    _asm.movzxByte(Gpr::Rax, home(slot));
+                    _asm.mov(home(slot), Gpr::Rax);
+                }
+                continue;
+            }
+
+            if (floats == floatArguments.size()) {
+                raisef<std::runtime_error>("too many float arguments for x86-64");
+            }
+            if (type == Type::Float) {
+                _asm.movd(Gpr::Rax, floatArguments[floats++]);
+            } else {
+                _asm.movq(Gpr::Rax, floatArguments[floats++]);
+            }
+            _asm.mov(home(slot), Gpr::Rax);
+        }
+
+        for (auto slot = 0U; slot < _code.arguments.size(); ++slot) {
+            if (auto const reg = _registers[slot]; reg) {
+                _asm.mov(*reg, home(slot));
+            }
+        }
+    }
+
+    auto epilogue() -> void
+    {
+        if (_code.type == Type::Float) {
+            _asm.movd(Xmm::Xmm0, Gpr::Rax);
+        } else if (_code.type == Type::Double) {
+            _asm.movq(Xmm::Xmm0, Gpr::Rax);
+        }
+        _asm.leave();
+        _asm.ret();
+    }
+
+    // NOLINTNEXTLINE(readability-function-cognitive-complexity)
+    auto emitInst(std::uint32_t pc, Bytecode::Inst const& inst) -> void
+    {
+        auto const base = getBaseOpCode(inst.op);
+        switch (getOpFormat(inst.op)) {
+            case OpFormat::None: {
+                if (inst.op == OpCode::ReturnVoid) {
+                    epilogue();
+                } else {
+                    _asm.ud2();
+                }
+                break;
+            }
+            case OpFormat::Const: {
+                _asm.mov(Gpr::Rax, _code.constants[inst.lhs]);
+                store(inst.dst, Gpr::Rax);
+                break;
+            }
+            case OpFormat::ConstPair: {
+                _asm.mov(Gpr::Rax, _code.constants[inst.lhs]);
+                store(inst.dst, Gpr::Rax);
+                _asm.mov(Gpr::Rax, _code.constants[inst.lhs + 1U]);
+                store(inst.rhs, Gpr::Rax);
+                break;
+            }
+            case OpFormat::Unary: {
+                load(Gpr::Rax, inst.lhs);
+                emitUnary(base);
+                store(inst.dst, Gpr::Rax);
+                break;
+            }
+            case OpFormat::Binary: {
+                load(Gpr::Rax, inst.lhs);
+                load(Gpr::Rcx, inst.rhs);
+                emitBinary(base);
+                store(inst.dst, Gpr::Rax);
+                break;
+            }
+            case OpFormat::BinaryConst: {
+                load(Gpr::Rax, inst.lhs);
+                _asm.mov(Gpr::Rcx, _code.constants[inst.rhs]);
+                emitBinary(base);
+                store(inst.dst, Gpr::Rax);
+                break;
+            }
+            case OpFormat::Jump: {
+                jump(pc, inst.dst);
+                break;
+            }
+            case OpFormat::JumpCopy: {
+                for (auto i = inst.lhs; i != inst.rhs; ++i) {
+                    load(Gpr::Rax, _code.copies[i].src);
+                    store(_code.copies[i].dst, Gpr::Rax);
+                }
+                jump(pc, inst.dst);
+                break;
+            }
+            case OpFormat::Branch: {
+                load(Gpr::Rax, inst.lhs);
+                _asm.test(Gpr::Rax, Gpr::Rax);
+                _fixups.push_back(Fixup{.at = _asm.jcc(Cond::NotEqual), .target = inst.dst});
+                jump(pc, inst.rhs);
+                break;
+            }
+            case OpFormat::CompareBranch: {
+                load(Gpr::Rax, inst.lhs);
+                load(Gpr::Rcx, inst.rhs);
+                _asm.alu(Alu::Cmp, Gpr::Rax, Gpr::Rcx);
+                auto const cond = base == OpCode::CmpEq ? Cond::Equal : Cond::NotEqual;
+                _fixups.push_back(Fixup{.at = _asm.jcc(cond), .target = inst.dst});
+                break;
+            }
+            case OpFormat::Return: {
+                load(Gpr::Rax, inst.lhs);
+                epilogue();
+                break;
+            }
+            case OpFormat::ReturnConst: {
+                _asm.mov(Gpr::Rax, _code.constants[inst.lhs]);
+                epilogue();
+                break;
+            }
+            case OpFormat::ReturnBinary: {
+                load(Gpr::Rax, inst.lhs);
+                load(Gpr::Rcx, inst.rhs);
+                emitBinary(base);
+                epilogue();
+                break;
+            }
+        }
+    }
+
+    // rax = op(rax)
+    auto emitUnary(OpCode op) -> void
+    {
+        switch (op) {
+            case OpCode::Move: break;
+            case OpCode::TruncI64ToF32: {
+                _asm.cvtToFloat(Precision::Single, Xmm::Xmm0, Gpr::Rax);
+                _asm.movd(Gpr::Rax, Xmm::Xmm0);
+                break;
+            }
+            case OpCode::TruncI64ToF64: {
+                _asm.cvtToFloat(Precision::Double, Xmm::Xmm0, Gpr::Rax);
+                _asm.movq(Gpr::Rax, Xmm::Xmm0);
+                break;
+            }
+            case OpCode::TruncF32ToI64: {
+                _asm.movd(Xmm::Xmm0, Gpr::Rax);
+                _asm.cvtToInt(Precision::Single, Gpr::Rax, Xmm::Xmm0);
+                break;
+            }
+            case OpCode::TruncF32ToF64: {
+                _asm.movd(Xmm::Xmm0, Gpr::Rax);
+                _asm.cvtFloat(Precision::Single, Xmm::Xmm0, Xmm::Xmm0);
+                _asm.movq(Gpr::Rax, Xmm::Xmm0);
+                break;
+            }
+            case OpCode::TruncF64ToI64: {
+                _asm.movq(Xmm::Xmm0, Gpr::Rax);
+                _asm.cvtToInt(Precision::Double, Gpr::Rax, Xmm::Xmm0);
+                break;
+            }
+            case OpCode::TruncF64ToF32: {
+                _asm.movq(Xmm::Xmm0, Gpr::Rax);
+                _asm.cvtFloat(Precision::Double, Xmm::Xmm0, Xmm::Xmm0);
+                _asm.movd(Gpr::Rax, Xmm::Xmm0);
+                break;
+            }
+            default: raisef<std::runtime_error>("unsupported unary op {}", op);
+        }
+    }
+
+    // rax = op(rax, rcx)
+    // NOLINTNEXTLINE(readability-function-cognitive-complexity)
+    auto emitBinary(OpCode op) -> void
+    {
+        switch (op) {
+            case OpCode::AddI64: _asm.alu(Alu::Add, Gpr::Rax, Gpr::Rcx); break;
+            case OpCode::SubI64: _asm.alu(Alu::Sub, Gpr::Rax, Gpr::Rcx); break;
+            case OpCode::MulI64: _asm.imul(Gpr::Rax, Gpr::Rcx); break;
+            case OpCode::AndI64: _asm.alu(Alu::And, Gpr::Rax, Gpr::Rcx); break;
+            case OpCode::OrI64: _asm.alu(Alu::Or, Gpr::Rax, Gpr::Rcx); break;
+            case OpCode::XorI64: _asm.alu(Alu::Xor, Gpr::Rax, Gpr::Rcx); break;
+            case OpCode::ShiftLeftI64: _asm.shift(Shift::Left, Gpr::Rax); break;
+            case OpCode::ShiftRightI64: _asm.shift(Shift::Right, Gpr::Rax); break;
+            case OpCode::DivI64: {
+                _asm.cqo();
+                _asm.idiv(Gpr::Rcx);
+                break;
+            }
+            case OpCode::ModI64: {
+                _asm.cqo();
+                _asm.idiv(Gpr::Rcx);
+                _asm.mov(Gpr::Rax, Gpr::Rdx);
+                break;
+            }
+            case OpCode::CmpEq: {
+                _asm.alu(Alu::Cmp, Gpr::Rax, Gpr::Rcx);
+                _asm.setAndZeroExtend(Cond::Equal, Gpr::Rax);
+                break;
+            }
+            case OpCode::CmpNe: {
+                _asm.alu(Alu::Cmp, Gpr::Rax, Gpr::Rcx);
+                _asm.setAndZeroExtend(Cond::NotEqual, Gpr::Rax);
+                break;
+            }
+            case OpCode::FloatAddF32: emitFloat(SseOp::Add, Precision::Single); break;
+            case OpCode::FloatSubF32: emitFloat(SseOp::Sub, Precision::Single); break;
+            case OpCode::FloatMulF32: emitFloat(SseOp::Mul, Precision::Single); break;
+            case OpCode::FloatDivF32: emitFloat(SseOp::Div, Precision::Single); break;
+            case OpCode::FloatAddF64: emitFloat(SseOp::Add, Precision::Double); break;
+            case OpCode::FloatSubF64: emitFloat(SseOp::Sub, Precision::Double); break;
+            case OpCode::FloatMulF64: emitFloat(SseOp::Mul, Precision::Double); break;
+            case OpCode::FloatDivF64: emitFloat(SseOp::Div, Precision::Double); break;
+            default: raisef<std::runtime_error>("unsupported binary op {}", op);
+        }
+    }
+
+    auto emitFloat(SseOp op, Precision precision) -> void
+    {
+        if (precision == Precision::Single) {
+            _asm.movd(Xmm::Xmm0, Gpr::Rax);
+            _asm.movd(Xmm::Xmm1, Gpr::Rcx);
+            _asm.sse(op, precision, Xmm::Xmm0, Xmm::Xmm1);
+            _asm.movd(Gpr::Rax, Xmm::Xmm0);
+        } else {
+            _asm.movq(Xmm::Xmm0, Gpr::Rax);
+            _asm.movq(Xmm::Xmm1, Gpr::Rcx);
+            _asm.sse(op, precision, Xmm::Xmm0, Xmm::Xmm1);
+            _asm.movq(Gpr::Rax, Xmm::Xmm0);
+        }
+    }
+
+    auto jump(std::uint32_t pc, std::uint32_t target) -> void
+    {
+        if (target != pc + 1U) {
+            _fixups.push_back(Fixup{.at = _asm.jmp(), .target = target});
+        }
+    }
+
+    auto load(Gpr dst, std::uint32_t slot) -> void
+    {
+        if (auto const reg = _registers[slot]; reg) {
+            _asm.mov(dst, *reg);
+        } else {
+            _asm.mov(dst, home(slot));
+        }
+    }
+
+    auto store(std::uint32_t slot, Gpr src) -> void
+    {
+        if (auto const reg = _registers[slot]; reg) {
+            _asm.mov(*reg, src);
+        } else {
+            _asm.mov(home(slot), src);
+        }
+    }
+
+    [[nodiscard]] static auto home(std::uint32_t slot) -> std::int32_t
+    {
+        return -8 * static_cast<std::int32_t>(slot + 1U);
+    }
+
+    Bytecode const& _code;
+    Assembler _asm;
+    std::vector<std::optional<Gpr>> _registers;
+    std::vector<Fixup> _fixups;
+};
+
+}  // namespace
+
+auto generate(Bytecode const& code) -> std::vector<std::uint8_t>
+{
+    return CodeGenerator{code}.run();
+}
+
+}  // namespace snir::x86
@@ -0,0 +1,15 @@
+#pragma once
+
+#include "snir/ir/Bytecode.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace snir::x86 {
+
+/// \brief Translates every bytecode instruction into a fixed machine code
+/// template. The code is position independent and follows the System V
+/// AMD64 calling convention for the function signature.
+[[nodiscard]] auto generate(Bytecode const& code) -> std::vector<std::uint8_t>;
+
+}  // namespace snir::x86
@@ -0,0 +1,96 @@
+#include "Jit.hpp"
+
+#include "snir/core/Exception.hpp"
+#include "snir/ir/Bytecode.hpp"
+#include "snir/ir/Function.hpp"
+#include "snir/ir/Type.hpp"
+#include "snir/x86/CodeGen.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#if SNIR_HAS_X86_JIT
+    #include <sys/mman.h>
+#endif
+
+namespace snir::x86 {
+
+auto JitFunction::compile(Function const& func) -> JitFunction
+{
+    return compile(Bytecode::compile(func));
+}
+
+auto JitFunction::compile(Bytecode const& code) -> JitFunction
+{
+    return JitFunction{generate(code), code.type, code.arguments};
+}
+
+#if SNIR_HAS_X86_JIT
+
+JitFunction::JitFunction(
+    std::span<std::uint8_t const> machineCode,
+    Type type,
+    std::vector<Type> arguments
+)
+    : _size{machineCode.size()}
+    , _type{type}
+    , _arguments{std::move(arguments)}
+{
+    auto* memory = ::mmap(nullptr, _size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED) {
+        raisef<std::runtime_error>("failed to map {} bytes for jit code", _size);
+    }
+
+    std::memcpy(memory, machineCode.data(), _size);
+    if (::mprotect(memory, _size, PROT_READ | PROT_EXEC) != 0) {
+        ::munmap(memory, _size);
+        raisef<std::runtime_error>("failed to make jit code executable");
+    }
+    _memory = memory;
+}
+
+JitFunction::~JitFunction()
+{
+    if (_memory != nullptr) {
+        ::munmap(_memory, _size);
+    }
+}
+
+#else
+
+JitFunction::JitFunction(
+    std::span<std::uint8_t const> /*machineCode*/,
+    Type /*type*/,
+    std::vector<Type> /*arguments*/
+)
+{
+    raisef<std::runtime_error>("jit is only supported on x86-64 linux");
+}
+
+JitFunction::~JitFunction() = default;
+
+#endif
+
+JitFunction::JitFunction(JitFunction&& other) noexcept
+    : _memory{std::exchange(other._memory, nullptr)}
+    , _size{std::exchange(other._size, 0)}
+    , _type{other._type}
+    , _arguments{std::move(other._arguments)}
+{}
+
+auto JitFunction::operator=(JitFunction&& other) noexcept -> JitFunction&
+{
+    auto tmp = std::move(other);
+    std::swap(_memory, tmp._memory);
+    std::swap(_size, tmp._size);
+    std::swap(_type, tmp._type);
+    std::swap(_arguments, tmp._arguments);
+    return *this;
+}
+
+}  // namespace snir::x86
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "snir/core/Exception.hpp"
+#include "snir/ir/Bytecode.hpp"
+#include "snir/ir/Function.hpp"
+#include "snir/ir/Type.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+#if defined(__x86_64__) and defined(__linux__)
+    #define SNIR_HAS_X86_JIT 1
+#else
+    #define SNIR_HAS_X86_JIT 0
+#endif
+
+namespace snir::x86 {
+
+/// \brief Native code of a single function in executable memory.
+///
+/// The memory is written first and then remapped read+execute, it is
+/// never writable and executable at the same time.
+struct JitFunction
+{
+    [[nodiscard]] static auto compile(Function const& func) -> JitFunction;
+    [[nodiscard]] static auto compile(Bytecode const& code) -> JitFunction;
+
+    JitFunction(JitFunction const& other) = delete;
+    JitFunction(JitFunction&& other) noexcept;
+    ~JitFunction();
+
+    auto operator=(JitFunction const& other) -> JitFunction& = delete;
+    auto operator=(JitFunction&& other) noexcept -> JitFunction&;
+
+    [[nodiscard]] auto size() const noexcept -> std::size_t { return _size; }
+
+    /// \brief Typed entry point, e.g. get<std::int64_t(std::int64_t)>().
+    template<typename Signature>
+    [[nodiscard]] auto get() const -> Signature*
+    {
+        if (not detail::SignatureTraits<Signature>::matches(_type, _arguments)) {
+            raisef<std::invalid_argument>("signature does not match jit function");
+        }
+        return reinterpret_cast<Signature*>(_memory);  // NOLINT(*-reinterpret-cast)
+    }
+
+private:
+    JitFunction(std::span<std::uint8_t const> machineCode, Type type, std::vector<Type> arguments);
+
+    void* _memory{nullptr};
+    std::size_t _size{0};
+    Type _type{Type::Void};
+    std::vector<Type> _arguments;
+};
+
+}  // namespace snir::x86
@@ -0,0 +1,316 @@
+#include "ObjectFile.hpp"
+
+#include "snir/core/Exception.hpp"
+#include "snir/ir/Bytecode.hpp"
+#include "snir/ir/Function.hpp"
+#include "snir/ir/Module.hpp"
+#include "snir/x86/CodeGen.hpp"
+
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace snir::x86 {
+
+namespace {
+
+// Only the parts of the ELF64 format a relocatable object needs, the
+// values are from the System V ABI and its AMD64 supplement.
+constexpr auto headerSize      = std::uint16_t{64};
+constexpr auto sectionSize     = std::uint16_t{64};
+constexpr auto symbolSize      = std::uint64_t{24};
+constexpr auto relocationSize  = std::uint64_t{24};
+constexpr auto relocatable     = std::uint16_t{1};
+constexpr auto machineX86_64   = std::uint16_t{62};
+constexpr auto functionAlign   = std::size_t{16};
+constexpr auto firstGlobal     = std::uint32_t{2};
+constexpr auto textSectionId   = std::uint16_t{1};
+constexpr auto symtabSectionId = std::uint32_t{3};
+constexpr auto strtabSectionId = std::uint32_t{4};
+constexpr auto shstrSectionId  = std::uint16_t{5};
+
+enum struct SectionType : std::uint32_t
+{
+    Null     = 0,
+    ProgBits = 1,
+    SymTab   = 2,
+    StrTab   = 3,
+    Rela     = 4,
+};
+
+enum struct SectionFlags : std::uint64_t
+{
+    None      = 0x00,
+    Alloc     = 0x02,
+    AllocExec = 0x06,
+    InfoLink  = 0x40,
+};
+
+enum struct SymbolInfo : std::uint8_t
+{
+    LocalSection   = 0x03,
+    GlobalNoType   = 0x10,
+    GlobalFunction = 0x12,
+};
+
+struct SectionHeader
+{
+    std::uint32_t name{0};
+    SectionType type{SectionType::Null};
+    SectionFlags flags{SectionFlags::None};
+    std::uint64_t offset{0};
+    std::uint64_t size{0};
+    std::uint32_t link{0};
+    std::uint32_t info{0};
+    std::uint64_t align{0};
+    std::uint64_t entrySize{0};
+};
+
+/// \brief Little endian output independent of the host byte order.
+struct Buffer
+{
+    template<typename T>
+        requires(std::integral<T> or std::is_enum_v<T>)
+    auto put(T value) -> void
+    {
+        auto const bits = static_cast<std::uint64_t>(value);
+        for (auto i = 0zu; i < sizeof(T); ++i) {
+            bytes.push_back(static_cast<std::uint8_t>(bits >> (i * 8U)));
+        }
+    }
+
+    auto put(std::span<std::uint8_t const> data) -> void
+    {
+        bytes.insert(bytes.end(), data.begin(), data.end());
+    }
+
+    auto align(std::size_t alignment) -> std::uint64_t
+    {
+        bytes.resize((bytes.size() + alignment - 1U) / alignment * alignment, 0);
+        return bytes.size();
+    }
+
+    std::vector<std::uint8_t> bytes;
+};
+
+struct StringTable
+{
+    auto add(std::string_view str) -> std::uint32_t
+    {
+        auto const offset = static_cast<std::uint32_t>(data.size());
+        data.insert(data.end(), str.begin(), str.end());
+        data.push_back(0);
+        return offset;
+    }
+
+    std::vector<std::uint8_t> data{0};
+};
+
+}  // namespace
+
+auto ObjectFile::compile(Module& module) -> ObjectFile
+{
+    auto object = ObjectFile{};
+    for (auto const& func : module.functions()) {
+        object.add(func.identifier(), generate(Bytecode::compile(func)));
+    }
+    return object;
+}
+
+auto ObjectFile::add(
+    std::string_view name,
+    std::span<std::uint8_t const> code,
+    std::span<Relocation const> relocations
+) -> void
+{
+    auto const id = symbol(name);
+    if (_symbols[id].defined) {
+        raisef<std::invalid_argument>("duplicate symbol '{}' in object file", name);
+    }
+
+    // Padding between functions traps if it is ever executed.
+    _text.resize((_text.size() + functionAlign - 1U) / functionAlign * functionAlign, 0xCC);
+
+    auto const offset    = static_cast<std::uint32_t>(_text.size());
+    _symbols[id].offset  = offset;
+    _symbols[id].size    = static_cast<std::uint32_t>(code.size());
+    _symbols[id].defined = true;
+    _text.insert(_text.end(), code.begin(), code.end());
+
+    for (auto const& relocation : relocations) {
+        if (relocation.offset + 4U > code.size()) {
+            raisef<std::out_of_range>("relocation for '{}' outside of '{}'", relocation.symbol, name);
+        }
+        _relocations.push_back(Entry{
+            .offset = offset + relocation.offset,
+            .symbol = symbol(relocation.symbol),
+            .kind   = relocation.kind,
+            .addend = relocation.addend,
+        });
+    }
+}
+
+auto ObjectFile::symbol(std::string_view name) -> std::uint32_t
+{
+    auto const found = std::ranges::find(_symbols, name, &Symbol::name);
+    if (found != _symbols.end()) {
+        return static_cast<std::uint32_t>(found - _symbols.begin());
+    }
+
+    _symbols.push_back(Symbol{.name = std::string{name}});
+    return static_cast<std::uint32_t>(_symbols.size() - 1U);
+}
+
+auto ObjectFile::bytes() const -> std::vector<std::uint8_t>
+{
+    auto names    = StringTable{};
+    auto strings  = StringTable{};
+    auto sections = std::vector<SectionHeader>(1);
+
+    auto const textName   = names.add(".text");
+    auto const relaName   = names.add(".rela.text");
+    auto const symtabName = names.add(".symtab");
+    auto const strtabName = names.add(".strtab");
+    auto const shstrName  = names.add(".shstrtab");
+    auto const stackName  = names.add(".note.GNU-stack");
+
+    auto file = Buffer{};
+    file.bytes.resize(headerSize, 0);
+
+    sections.push_back(SectionHeader{
+        .name   = textName,
+        .type   = SectionType::ProgBits,
+        .flags  = SectionFlags::AllocExec,
+        .offset = file.align(functionAlign),
+        .size   = _text.size(),
+        .align  = functionAlign,
+    });
+    file.put(_text);
+
+    auto const relaOffset = file.align(8);
+    for (auto const& relocation : _relocations) {
+        auto const info = std::uint64_t{relocation.symbol + firstGlobal} << 32U;
+        file.put(std::uint64_t{relocation.offset});
+        file.put(info | static_cast<std::uint32_t>(relocation.kind));
+        file.put(relocation.addend);
+    }
+    sections.push_back(SectionHeader{
+        .name      = relaName,
+        .type      = SectionType::Rela,
+        .flags     = SectionFlags::InfoLink,
+        .offset    = relaOffset,
+        .size      = _relocations.size() * relocationSize,
+        .link      = symtabSectionId,
+        .info      = textSectionId,
+        .align     = 8,
+        .entrySize = relocationSize,
+    });
+
+    // Null symbol and the .text section symbol are the only locals.
+    auto const symtabOffset = file.align(8);
+    file.put(std::vector<std::uint8_t>(symbolSize, 0));
+    file.put(std::uint32_t{0});
+    file.put(SymbolInfo::LocalSection);
+    file.put(std::uint8_t{0});
+    file.put(textSectionId);
+    file.put(std::uint64_t{0});
+    file.put(std::uint64_t{0});
+    for (auto const& symbol : _symbols) {
+        file.put(strings.add(symbol.name));
+        file.put(symbol.defined ? SymbolInfo::GlobalFunction : SymbolInfo::GlobalNoType);
+        file.put(std::uint8_t{0});
+        file.put(symbol.defined ? textSectionId : std::uint16_t{0});
+        file.put(std::uint64_t{symbol.offset});
+        file.put(std::uint64_t{symbol.size});
+    }
+    sections.push_back(SectionHeader{
+        .name      = symtabName,
+        .type      = SectionType::SymTab,
+        .offset    = symtabOffset,
+        .size      = (_symbols.size() + firstGlobal) * symbolSize,
+        .link      = strtabSectionId,
+        .info      = firstGlobal,
+        .align     = 8,
+        .entrySize = symbolSize,
+    });
+
+    sections.push_back(SectionHeader{
+        .name   = strtabName,
+        .type   = SectionType::StrTab,
+        .offset = file.bytes.size(),
+        .size   = strings.data.size(),
+        .align  = 1,
+    });
+    file.put(strings.data);
+
+    sections.push_back(SectionHeader{
+        .name   = shstrName,
+        .type   = SectionType::StrTab,
+        .offset = file.bytes.size(),
+        .size   = names.data.size(),
+        .align  = 1,
+    });
+    file.put(names.data);
+
+    // Marks the stack as non-executable for the linker.
+    sections.push_back(SectionHeader{
+        .name   = stackName,
+        .type   = SectionType::ProgBits,
+        .offset = file.bytes.size(),
+        .align  = 1,
+    });
+
+    auto const sectionsOffset = file.align(8);
+    for (auto const& section : sections) {
+        file.put(section.name);
+        file.put(section.type);
+        file.put(section.flags);
+        file.put(std::uint64_t{0});
+        file.put(section.offset);
+        file.put(section.size);
+        file.put(section.link);
+        file.put(section.info);
+        file.put(section.align);
+        file.put(section.entrySize);
+    }
+
+    auto header = Buffer{};
+    header.put(std::vector<std::uint8_t>{0x7F, 'E', 'L', 'F', 2, 1, 1});
+    header.align(16);
+    header.put(relocatable);
+    header.put(machineX86_64);
+    header.put(std::uint32_t{1});
+    header.put(std::uint64_t{0});
+    header.put(std::uint64_t{0});
+    header.put(sectionsOffset);
+    header.put(std::uint32_t{0});
+    header.put(headerSize);
+    header.put(std::uint16_t{0});
+    header.put(std::uint16_t{0});
+    header.put(sectionSize);
+    header.put(static_cast<std::uint16_t>(sections.size()));
+    header.put(shstrSectionId);
+    std::ranges::copy(header.bytes, file.bytes.begin());
+
+    return std::move(file.bytes);
+}
+
+auto ObjectFile::write(std::ostream& out) const -> void
+{
+    auto const data = bytes();
+    out.write(reinterpret_cast<char const*>(data.data()), std::streamsize(data.size()));  // NOLINT
+    if (not out) {
+        raisef<std::runtime_error>("failed to write object file");
+    }
+}
+
+}  // namespace snir::x86
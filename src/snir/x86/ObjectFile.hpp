@@ -0,0 +1,76 @@
+#pragma once
+
+#include "snir/ir/Module.hpp"
+
+#include <cstdint>
+#include <ostream>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace snir::x86 {
+
+enum struct RelocationKind : std::uint32_t
+{
+    Abs64 = 1,  // R_X86_64_64
+    Pc32  = 2,  // R_X86_64_PC32
+    Plt32 = 4,  // R_X86_64_PLT32
+};
+
+/// \brief Reference from a function's code to a symbol, the offset is
+/// relative to the start of that function.
+struct Relocation
+{
+    std::uint32_t offset{0};
+    std::string symbol;
+    RelocationKind kind{RelocationKind::Plt32};
+    std::int64_t addend{-4};
+};
+
+/// \brief Relocatable ELF64 object for x86-64 with one global function
+/// symbol per function, ready for the system linker.
+///
+/// All functions share a single .text section. Symbols that are referenced
+/// by a relocation but not defined become undefined globals.
+struct ObjectFile
+{
+    ObjectFile() = default;
+
+    [[nodiscard]] static auto compile(Module& module) -> ObjectFile;
+
+    auto add(
+        std::string_view name,
+        std::span<std::uint8_t const> code,
+        std::span<Relocation const> relocations = {}
+    ) -> void;
+
+    [[nodiscard]] auto text() const noexcept -> std::span<std::uint8_t const> { return _text; }
+    [[nodiscard]] auto bytes() const -> std::vector<std::uint8_t>;
+    auto write(std::ostream& out) const -> void;
+
+private:
+    struct Symbol
+    {
+        std::string name;
+        std::uint32_t offset{0};
+        std::uint32_t size{0};
+        bool defined{false};
+    };
+
+    struct Entry
+    {
+        std::uint32_t offset{0};
+        std::uint32_t symbol{0};
+        RelocationKind kind{RelocationKind::Plt32};
+        std::int64_t addend{0};
+    };
+
+    [[nodiscard]] auto symbol(std::string_view name) -> std::uint32_t;
+
+    std::vector<std::uint8_t> _text;
+    std::vector<Symbol> _symbols;
+    std::vector<Entry> _relocations;
+};
+
+}  // namespace snir::x86
@@ -0,0 +1,24 @@
+; BEGIN_TEST
+; name: func
+; type: i64
+; args: 0
+; blocks: 3
+; instructions: 11
+; return: 45
+; END_TEST
+define i64 @func() {
+0:
+    %1 = i64 0
+    %2 = i64 10
+    %3 = i64 1
+    br label %4
+4:
+    %5 = phi i64 [ %1, %0 ], [ %8, %4 ]
+    %6 = phi i64 [ %1, %0 ], [ %7, %4 ]
+    %7 = add i64 %6, %5
+    %8 = add i64 %5, %3
+    %9 = icmp ne i64 %8, %2
+    br i1 %9, label %4, label %10
+10:
+    ret i64 %7
+}
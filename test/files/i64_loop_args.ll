@@ -0,0 +1,25 @@
+; BEGIN_TEST
+; name: func
+; type: i64
+; args: 1
+; blocks: 3
+; instructions: 12
+; return: 45
+; END_TEST
+define i64 @func(i64 %0) {
+1:
+    %2 = i64 0
+    %3 = i64 1
+    %4 = icmp eq i64 %0, %2
+    br i1 %4, label %11, label %5
+5:
+    %6 = phi i64 [ %2, %1 ], [ %9, %5 ]
+    %7 = phi i64 [ %2, %1 ], [ %8, %5 ]
+    %8 = add i64 %7, %6
+    %9 = add i64 %6, %3
+    %10 = icmp ne i64 %9, %0
+    br i1 %10, label %5, label %11
+11:
+    %12 = phi i64 [ %2, %1 ], [ %8, %5 ]
+    ret i64 %12
+}
@@ -0,0 +1,27 @@
+; BEGIN_TEST
+; name: func
+; type: i64
+; args: 0
+; blocks: 4
+; instructions: 13
+; return: 34
+; END_TEST
+define i64 @func() {
+0:
+    %1 = i64 0
+    %2 = i64 1
+    %3 = i64 10
+    br label %4
+4:
+    %5 = phi i64 [ %1, %0 ], [ %6, %11 ]
+    %6 = phi i64 [ %2, %0 ], [ %8, %11 ]
+    %7 = phi i64 [ %1, %0 ], [ %9, %11 ]
+    %8 = add i64 %5, %6
+    %9 = add i64 %7, %2
+    %10 = icmp eq i64 %9, %3
+    br i1 %10, label %12, label %11
+11:
+    br label %4
+12:
+    ret i64 %5
+}
@@ -0,0 +1,24 @@
+; BEGIN_TEST
+; name: func
+; type: i64
+; args: 0
+; blocks: 3
+; instructions: 11
+; return: 1
+; END_TEST
+define i64 @func() {
+0:
+    %1 = i64 1
+    %2 = i64 2
+    %3 = i64 4
+    br label %4
+4:
+    %5 = phi i64 [ %1, %0 ], [ %6, %4 ]
+    %6 = phi i64 [ %2, %0 ], [ %5, %4 ]
+    %7 = phi i64 [ %1, %0 ], [ %8, %4 ]
+    %8 = add i64 %7, %1
+    %9 = icmp ne i64 %8, %3
+    br i1 %9, label %4, label %10
+10:
+    ret i64 %5
+}
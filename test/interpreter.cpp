@@ -4,21 +4,36 @@
 #include "snir/core/Exception.hpp"
 #include "snir/core/File.hpp"
 #include "snir/core/Strings.hpp"
+#include "snir/ir/AnalysisManager.hpp"
+#include "snir/ir/Bytecode.hpp"
+#include "snir/ir/ClosureFunction.hpp"
+#include "snir/ir/CodeCache.hpp"
+#include "snir/ir/ExecutionService.hpp"
+#include "snir/ir/FrameCompaction.hpp"
 #include "snir/ir/Function.hpp"
+#include "snir/ir/InstKind.hpp"
 #include "snir/ir/Literal.hpp"
 #include "snir/ir/Module.hpp"
+#include "snir/ir/OpCode.hpp"
 #include "snir/ir/Parser.hpp"
 #include "snir/ir/pass/DeadStoreElimination.hpp"
 #include "snir/ir/pass/RemoveEmptyBlock.hpp"
 #include "snir/ir/pass/RemoveNop.hpp"
 #include "snir/ir/PassManager.hpp"
 #include "snir/ir/Printer.hpp"
+#include "snir/ir/Profile.hpp"
 #include "snir/ir/Registry.hpp"
+#include "snir/ir/ResultCache.hpp"
+#include "snir/ir/Scheduler.hpp"
+#include "snir/ir/Superinstruction.hpp"
+#include "snir/ir/TieredFunction.hpp"
 #include "snir/ir/Type.hpp"
 
 #include "fmt/os.h"
 #include <ctre.hpp>
 
+#include <algorithm>
+#include <array>
 #include <cassert>
 #include <cmath>
 #include <cstddef>
@@ -26,14 +41,24 @@
 #include <cstdlib>
 #include <filesystem>
 #include <functional>
+#include <future>
 #include <iostream>
+#include <map>
 #include <limits>
+#include <numeric>
+#include <span>
+#include <sstream>
 #include <stdexcept>
 #include <string>
 #include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
 
 namespace {
 
+using Dispatch = snir::Interpreter::Dispatch;
+
 struct FunctionTestSpec
 {
     std::string name;
@@ -109,8 +134,17 @@ struct FunctionTestSpec
 
 auto execute(snir::Function const& func, snir::Literal expected) -> void
 {
-    if (func.arguments().empty()) {
-        auto vm     = snir::Interpreter{};
+    if (not func.arguments().empty()) {
+        return;
+    }
+
+    auto const code  = snir::Bytecode::compile(func, false);
+    auto const fused = snir::Bytecode::compile(func);
+    assert(fused.code.size() <= code.code.size());
+    assert(fused.registers <= code.registers);
+
+    for (auto dispatch : {Dispatch::Switch, Dispatch::Threaded}) {
+        auto vm     = snir::Interpreter{dispatch};
         auto result = vm.execute(func, {});
         assert(result.has_value());
 
@@ -120,7 +154,486 @@ auto execute(snir::Function const& func, snir::Literal expected) -> void
         } else {
             assert(result->value == expected.value);
         }
+
+        for (auto const* bytecode : {&code, &fused}) {
+            auto const again = vm.execute(*bytecode, {});
+            assert(again.has_value());
+            assert(again->value == result->value or func.type() == snir::Type::Void);
+
+            auto closure = snir::ClosureFunction::compile(*bytecode);
+            auto bound   = closure.execute({});
+            assert(bound.has_value());
+            assert(bound->value == result->value or func.type() == snir::Type::Void);
+        }
+    }
+}
+
+auto testBatch() -> void
+{
+    auto registry = snir::Registry{};
+    auto parser   = snir::Parser{registry};
+    auto loop     = parser.read(snir::readFile("./test/files/i64_loop_args.ll").value());
+    auto add      = parser.read(snir::readFile("./test/files/i64_args_2.ll").value());
+    auto vm       = snir::Interpreter{};
+
+    // Lanes leave the loop after different trip counts, the last batch is partial
+    auto const sum = snir::Bytecode::compile(snir::Function{registry, loop.functions().at(0)});
+    auto rows      = std::vector<std::int64_t>(200);
+    auto result    = std::vector<std::int64_t>(rows.size());
+    auto closure   = snir::ClosureFunction::compile(sum);
+    std::iota(rows.begin(), rows.end(), std::int64_t{0});
+    vm.executeBatch(sum, std::span{result}, std::span<std::int64_t const>{rows});
+    for (auto i = 0zu; i < rows.size(); ++i) {
+        auto const args = std::array{snir::Literal{rows[i]}};
+        assert(result[i] == rows[i] * (rows[i] - 1) / 2);
+        assert(vm.execute(sum, args)->value == snir::Literal{result[i]}.value);
+        assert(closure.execute(args)->value == snir::Literal{result[i]}.value);
+    }
+
+    auto const code = snir::Bytecode::compile(snir::Function{registry, add.functions().at(0)});
+    auto lhs        = std::vector<std::int64_t>(1'000);
+    auto rhs        = std::vector<std::int64_t>(lhs.size(), 42);
+    auto sums       = std::vector<std::int64_t>(lhs.size());
+    std::iota(lhs.begin(), lhs.end(), std::int64_t{0});
+    vm.executeBatch(
+        code,
+        std::span{sums},
+        std::span<std::int64_t const>{lhs},
+        std::span<std::int64_t const>{rhs}
+    );
+    for (auto i = 0zu; i < lhs.size(); ++i) {
+        auto const args = std::array{snir::Literal{lhs[i]}, snir::Literal{rhs[i]}};
+        assert(sums[i] == lhs[i] + 42);
+        assert(vm.execute(code, args)->value == snir::Literal{sums[i]}.value);
+    }
+}
+
+auto testSuperinstructions() -> void
+{
+    auto registry = snir::Registry{};
+    auto parser   = snir::Parser{registry};
+    auto add      = parser.read(snir::readFile("./test/files/i64_add.ll").value());
+    auto args     = parser.read(snir::readFile("./test/files/i64_args_2.ll").value());
+    auto constant = snir::Function{registry, add.functions().at(0)};
+    auto binary   = snir::Function{registry, args.functions().at(0)};
+
+    // Folded constants are returned without a frame store
+    auto const code  = snir::Bytecode::compile(constant, false);
+    auto const fused = snir::Bytecode::compile(constant);
+    assert(fused.code.size() == 1 and fused.code[0].op == snir::OpCode::ReturnConst);
+    assert(snir::isFusedPair(snir::OpCode::Const, snir::OpCode::Return));
+    assert(not snir::isFusedPair(snir::OpCode::AddI64, snir::OpCode::AddI64));
+
+    auto vm       = snir::Interpreter{};
+    auto expected = snir::Literal{std::int64_t{185}};
+    assert(vm.execute(code, {})->value == expected.value);
+    assert(vm.execute(fused, {})->value == expected.value);
+    assert(snir::ClosureFunction::compile(fused).execute({})->value == expected.value);
+
+    auto result = std::vector<std::int64_t>(3);
+    vm.executeBatch(fused, std::span{result});
+    assert(std::ranges::all_of(result, [](auto v) { return v == 185; }));
+
+    // Counts over several functions add up
+    auto const other = snir::Bytecode::compile(binary, false);
+    auto corpus      = snir::countOpCodePairs(code);
+    snir::countOpCodePairs(other, corpus);
+    for (auto const& [pair, count] : snir::countOpCodePairs(other)) {
+        auto const own = snir::countOpCodePairs(code);
+        auto const it  = own.find(pair);
+        assert(corpus.at(pair) == count + (it != own.end() ? it->second : 0));
+    }
+}
+
+auto testTypedCall() -> void
+{
+    auto registry = snir::Registry{};
+    auto parser   = snir::Parser{registry};
+    auto mixed    = parser.read(
+        "define double @func(i64 %0, double %1) {\n2:\n"
+        "    %3 = trunc %0 to double\n    %4 = fadd double %3, %1\n    ret double %4\n}"
+    );
+    auto add   = parser.read(snir::readFile("./test/files/i64_args_2.ll").value());
+    auto empty = parser.read(snir::readFile("./test/files/void.ll").value());
+    auto vm    = snir::Interpreter{};
+
+    auto const code = snir::Bytecode::compile(snir::Function{registry, mixed.functions().at(0)});
+    assert(vm.execute<double>(code, 3, 4.0) == 7.0);
+    assert(vm.execute<double>(code, std::int64_t{-1}, 0.5) == -0.5);
+    vm.execute<void>(snir::Bytecode::compile(snir::Function{registry, empty.functions().at(0)}));
+
+    auto mismatch = [&](auto call) {
+        try {
+            call();
+        } catch (std::invalid_argument const&) {
+            return true;
+        }
+        return false;
+    };
+    assert(mismatch([&] { return vm.execute<double>(code, 3.0, 4.0); }));
+    assert(mismatch([&] { return vm.execute<std::int64_t>(code, 3, 4.0); }));
+    assert(mismatch([&] { return vm.execute<double>(code, 3); }));
+
+    auto const sum = snir::Bytecode::compile(snir::Function{registry, add.functions().at(0)});
+    auto boxed     = std::int64_t{0};
+    auto typed     = std::int64_t{0};
+    auto const n   = std::int64_t{1'000};
+    for (auto i = std::int64_t{0}; i < n; ++i) {
+        auto const args = std::array{snir::Literal{i}, snir::Literal{boxed}};
+        boxed           = std::get<std::int64_t>(vm.execute(sum, args)->value);
+        typed           = vm.execute<std::int64_t>(sum, i, typed);
+    }
+    assert(boxed == typed and typed == n * (n - 1) / 2);
+}
+
+auto testFrameCompaction() -> void
+{
+    // A chain of short-lived temporaries only needs a few slots at once
+    auto source = std::string{"define i64 @func(i64 %0) {\n1:\n"};
+    auto last   = 0;
+    for (auto i = 0; i < 200; ++i) {
+        auto const k = 2 + i * 2;
+        source += fmt::format("    %{} = i64 {}\n", k, i);
+        source += fmt::format("    %{} = {} i64 %{}, %{}\n", k + 1, i % 2 ? "xor" : "add", last, k);
+        last = k + 1;
+    }
+    source += fmt::format("    ret i64 %{}\n}}", last);
+
+    auto registry = snir::Registry{};
+    auto parser   = snir::Parser{registry};
+    auto module   = parser.read(source);
+    auto func     = snir::Function{registry, module.functions().at(0)};
+    auto vm       = snir::Interpreter{};
+
+    auto const code      = snir::Bytecode::compile(func, false);
+    auto const optimized = snir::Bytecode::compile(func);
+    assert(code.registers == 401);
+    assert(optimized.registers <= 4);
+    for (auto arg : {std::int64_t{0}, std::int64_t{-7}, std::int64_t{1} << 40}) {
+        assert(vm.execute<std::int64_t>(code, arg) == vm.execute<std::int64_t>(optimized, arg));
+    }
+
+    // Every register gets a slot of the compacted frame, the argument keeps its own.
+    auto compacted   = code;
+    auto const slots = snir::compactFrame(compacted);
+    assert(slots.size() == code.registers and slots.at(0) == 0);
+    assert(std::ranges::all_of(slots, [&](auto slot) { return slot < compacted.registers; }));
+
+    // Registers the fused code no longer touches have no slot.
+    auto fused = code;
+    snir::fuseSuperinstructions(fused);
+    auto const fusedSlots = snir::compactFrame(fused);
+    assert(std::ranges::contains(fusedSlots, snir::unusedSlot));
+    fmt::println("; frame: {} slots, compacted: {}", code.registers, optimized.registers);
+}
+
+auto testProfile() -> void
+{
+    auto registry = snir::Registry{};
+    auto parser   = snir::Parser{registry};
+    auto module   = parser.read(snir::readFile("./test/files/i64_loop_args.ll").value());
+    auto func     = snir::Function{registry, module.functions().at(0)};
+    auto vm       = snir::Interpreter{};
+    auto args     = std::array{snir::Literal{std::int64_t{10}}};
+
+    // The loop body runs 10 times, the back edge is taken 9 times
+    using Edge       = std::pair<std::uint32_t, std::uint32_t>;
+    auto const edges = std::map<Edge, std::uint64_t>{{{0, 1}, 1}, {{1, 1}, 9}, {{1, 2}, 1}};
+    for (auto fuse : {false, true}) {
+        auto const code = snir::Bytecode::compile(func, fuse);
+        auto profile    = snir::Profile{};
+        auto& counts    = profile.function(func, code);
+        assert(vm.execute(code, args, counts)->value == snir::Literal{std::int64_t{45}}.value);
+
+        assert(counts.block(0) == 1 and counts.block(1) == 10 and counts.block(2) == 1);
+        assert(counts.edges == edges);
+        assert(counts.kinds().at(snir::InstKind::Add) == 20);
+        assert(counts.kinds().at(snir::InstKind::Phi) == 21);
+        assert(profile.hotBlocks(1).at(0).block == 1);
+
+        auto text = std::ostringstream{};
+        profile.writeText(text);
+        assert(text.str().find("  block 1: 10\n") != std::string::npos);
+        assert(text.str().find("  edge 1 -> 1: 9\n") != std::string::npos);
+
+        auto json = std::ostringstream{};
+        profile.writeJson(json);
+        assert(json.str().find(R"("blocks": [1, 10, 1])") != std::string::npos);
+    }
+
+    if constexpr (snir::Interpreter::profiling) {
+        auto loop    = parser.read(snir::readFile("./test/files/i64_loop.ll").value());
+        auto profile = snir::Profile{};
+        vm.profile(&profile);
+        assert(vm.execute(snir::Function{registry, loop.functions().at(0)}, {}).has_value());
+        vm.profile(nullptr);
+        assert(profile.functions().at("func").block(1) == 10);
+    }
+}
+
+auto testMemoize() -> void
+{
+    auto registry = snir::Registry{};
+    auto parser   = snir::Parser{registry};
+    auto loop     = parser.read(snir::readFile("./test/files/i64_loop.ll").value());
+    auto add      = parser.read(snir::readFile("./test/files/i64_args_2.ll").value());
+
+    auto cache = snir::ResultCache{1024 * 1024};
+    auto vm    = snir::Interpreter{};
+    vm.memoize(&cache);
+    for (auto i = 0; i < 3; ++i) {
+        auto const result = vm.execute(snir::Function{registry, loop.functions().at(0)}, {});
+        assert(result->value == snir::Literal{std::int64_t{45}}.value);
+    }
+    assert(cache.stats().misses == 1 and cache.stats().hits == 2 and cache.size() == 1);
+
+    // The cap holds two entries, the least recently used one is evicted
+    auto const func = snir::Function{registry, add.functions().at(0)};
+    auto const args = [](std::int64_t lhs, std::int64_t rhs) {
+        return std::array{snir::Literal{lhs}, snir::Literal{rhs}};
+    };
+    auto const entry = [&] {
+        auto probe = snir::ResultCache{1024};
+        probe.insert(func, args(0, 0), snir::Literal{std::int64_t{0}});
+        return probe.bytes();
+    }();
+
+    auto lru = snir::ResultCache{2 * entry};
+    lru.insert(func, args(1, 2), snir::Literal{std::int64_t{3}});
+    lru.insert(func, args(3, 4), snir::Literal{std::int64_t{7}});
+    assert(lru.find(func, args(1, 2))->value == snir::Literal{std::int64_t{3}}.value);
+    lru.insert(func, args(5, 6), snir::Literal{std::int64_t{11}});
+    assert(not lru.find(func, args(3, 4)).has_value());
+    assert(lru.find(func, args(1, 2)).has_value());
+    assert(lru.find(func, args(5, 6)).has_value());
+    assert(lru.size() == 2 and lru.bytes() <= lru.maxBytes());
+    assert(lru.stats().evictions == 1 and lru.stats().misses == 1);
+
+    // Calls through a Function compile it once, a shared cache sees that
+    auto code = snir::CodeCache{};
+    vm.cacheCode(&code);
+    auto const compiled = code.get(func);
+    for (auto n = std::int64_t{0}; n < 3; ++n) {
+        auto const arg = registry.create();
+        registry.emplace<snir::Literal>(arg, n);
+        (void)vm.execute(func, std::array{arg, arg});
+    }
+    assert(code.size() == 1 and code.get(func) == compiled);
+    code.erase(func);
+    assert(code.size() == 0 and code.get(func) != compiled);
+
+    // Touching the registry, as every pass does, compiles it again
+    auto const before = code.get(func);
+    snir::touch(registry);
+    auto const touched = code.get(func);
+    assert(touched != before and code.size() == 1);
+    auto pm       = snir::PassManager{};
+    auto analysis = snir::AnalysisManager<snir::Function>{};
+    auto edited   = func;
+    pm.add(snir::RemoveNop{});
+    pm(edited, analysis);
+    assert(code.get(func) != touched);
+    vm.cacheCode(nullptr);
+
+    // 0.0 has the bits of 0, the wrongly typed call has to fail, not hit.
+    auto literal = [&registry](snir::Literal value) {
+        auto const id = registry.create();
+        registry.emplace<snir::Literal>(id, value);
+        return id;
+    };
+    auto const ints    = std::array{literal({std::int64_t{0}}), literal({std::int64_t{0}})};
+    auto const doubles = std::array{literal({0.0}), literal({0.0})};
+    assert(vm.execute(func, ints)->value == snir::Literal{std::int64_t{0}}.value);
+    auto threw = false;
+    try {
+        (void)vm.execute(func, doubles);
+    } catch (std::invalid_argument const&) {
+        threw = true;
+    }
+    assert(threw);
+}
+
+auto testScheduler() -> void
+{
+    auto registry = snir::Registry{};
+    auto parser   = snir::Parser{registry};
+    auto module   = parser.read(snir::readFile("./test/files/i64_loop_args.ll").value());
+    auto code     = snir::Bytecode::compile(snir::Function{registry, module.functions().at(0)});
+
+    auto const sum = [](std::int64_t n) { return snir::Literal{n * (n - 1) / 2}.value; };
+
+    // The long call is spawned first, the short ones still finish before it
+    auto scheduler  = snir::Scheduler{snir::Interpreter::Slice{.instructions = 64}};
+    auto const slow = scheduler.spawn(code, std::array{snir::Literal{std::int64_t{100'000}}});
+    auto tickets    = std::vector<snir::Scheduler::Ticket>{};
+    for (auto n = std::int64_t{0}; n < 100; ++n) {
+        tickets.push_back(scheduler.spawn(code, std::array{snir::Literal{n}}));
+    }
+    assert(scheduler.pending() == 101);
+
+    while (scheduler.step() and not scheduler.finished(tickets.back())) {}
+    assert(not scheduler.finished(slow));
+    for (auto n = 0zu; n < tickets.size(); ++n) {
+        assert(scheduler.result(tickets[n])->value == sum(static_cast<std::int64_t>(n)));
+    }
+
+    scheduler.run();
+    assert(scheduler.pending() == 0 and scheduler.result(slow)->value == sum(100'000));
+
+    // Finished frames are reused by the next spawn
+    assert(scheduler.pool().idle() == 101);
+    auto const again = scheduler.spawn(code, std::array{snir::Literal{std::int64_t{10}}});
+    assert(scheduler.pool().idle() == 100);
+    scheduler.run();
+    assert(scheduler.result(again)->value == sum(10));
+
+    // At block granularity every loop iteration is at least one slice
+    auto blocks = snir::Scheduler{snir::Interpreter::Slice{
+        .instructions = std::numeric_limits<std::uint32_t>::max(),
+        .blocks       = true,
+    }};
+    auto const ticket = blocks.spawn(code, std::array{snir::Literal{std::int64_t{10}}});
+    auto slices       = 0;
+    while (blocks.step()) {
+        ++slices;
+    }
+    assert(slices > 10 and blocks.result(ticket)->value == sum(10));
+
+    // Taking a result frees its ticket, a stale ticket is rejected
+    auto const taken = blocks.take(ticket);
+    assert(taken->value == sum(10) and blocks.tickets() == 0);
+    auto const reused = blocks.spawn(code, std::array{snir::Literal{std::int64_t{5}}});
+    assert(reused.index == ticket.index and reused != ticket);
+    blocks.run();
+    assert(blocks.take(reused)->value == sum(5));
+
+    auto fails = [](auto call) {
+        try {
+            call();
+        } catch (std::exception const&) {
+            return true;
+        }
+        return false;
+    };
+    assert(fails([&] { return blocks.result(ticket); }));
+    assert(fails([] { return snir::Scheduler{snir::Interpreter::Slice{.instructions = 0}}; }));
+
+    // A failing execution hands its frame back as well
+    auto unreachable = snir::Bytecode{};
+    unreachable.type = snir::Type::Int64;
+    unreachable.code.push_back(snir::Bytecode::Inst{.op = snir::OpCode::Unreachable});
+    unreachable.registers = 1;
+
+    auto const idle   = blocks.pool().idle();
+    auto const broken = blocks.spawn(unreachable, {});
+    blocks.run();
+    assert(blocks.pool().idle() == idle);
+    assert(fails([&] { return blocks.take(broken); }));
+    assert(blocks.tickets() == 0);
+}
+
+auto testService() -> void
+{
+    auto registry = snir::Registry{};
+    auto parser   = snir::Parser{registry};
+    auto codes    = std::vector<snir::Bytecode>{};
+    auto expected = std::vector<snir::Literal>{};
+    auto vm       = snir::Interpreter{};
+    for (auto const& entry : std::filesystem::directory_iterator{"./test/files"}) {
+        if (not entry.is_regular_file()) {
+            continue;
+        }
+        auto module = parser.read(snir::readFile(entry).value());
+        auto func   = snir::Function{registry, module.functions().at(0)};
+        if (func.arguments().empty() and func.type() != snir::Type::Void) {
+            codes.push_back(snir::Bytecode::compile(func));
+            expected.push_back(vm.execute(codes.back(), {}).value());
+        }
+    }
+
+    // Calls from the corpus of small functions, spread over several workers
+    {
+        auto service = snir::ExecutionService{std::max(std::thread::hardware_concurrency(), 2U)};
+        auto futures = std::vector<std::future<snir::Literal>>{};
+        for (auto round = 0; round < 4; ++round) {
+            for (auto const& code : codes) {
+                futures.push_back(service.submit(code, {}));
+            }
+        }
+        for (auto i = 0zu; i < futures.size(); ++i) {
+            assert(futures[i].get().value == expected[i % codes.size()].value);
+        }
+    }
+
+    auto module  = parser.read(snir::readFile("./test/files/i64_loop_args.ll").value());
+    auto func    = snir::Function{registry, module.functions().at(0)};
+    auto code    = snir::Bytecode::compile(func);
+    auto service = snir::ExecutionService{4};
+    assert(service.workers() == 4);
+
+    auto sum = service.submit(func, {snir::Literal{std::int64_t{10}}});
+    assert(sum.get().value == snir::Literal{std::int64_t{45}}.value);
+
+    // Later calls of the function reuse its bytecode
+    auto again = service.submit(func, {snir::Literal{std::int64_t{4}}});
+    assert(again.get().value == snir::Literal{std::int64_t{6}}.value);
+    assert(service.code().size() == 1);
+
+    auto rows = std::vector<std::vector<snir::Literal>>{};
+    for (auto n = std::int64_t{0}; n < 1'000; ++n) {
+        rows.push_back({snir::Literal{n}});
+    }
+    auto const sums = service.submitBatch(code, rows).get();
+    assert(sums.size() == rows.size());
+    for (auto n = 0zu; n < sums.size(); ++n) {
+        auto const i = static_cast<std::int64_t>(n);
+        assert(sums[n].value == snir::Literal{i * (i - 1) / 2}.value);
+    }
+    assert(service.submitBatch(code, {}).get().empty());
+
+    auto const throws = [](auto future) {
+        try {
+            future.get();
+        } catch (std::invalid_argument const&) {
+            return true;
+        }
+        return false;
+    };
+    assert(throws(service.submit(code, {})));
+    rows.emplace_back();
+    assert(throws(service.submitBatch(code, rows)));
+}
+
+auto testTiered() -> void
+{
+    using Tier = snir::TieredFunction::Tier;
+
+    auto registry = snir::Registry{};
+    auto parser   = snir::Parser{registry};
+    auto module   = parser.read(snir::readFile("./test/files/i64_loop_args.ll").value());
+    auto code     = snir::Bytecode::compile(snir::Function{registry, module.functions().at(0)});
+
+    auto const sum = [](std::int64_t n) { return snir::Literal{n * (n - 1) / 2}.value; };
+
+    // Cold functions stay interpreted
+    auto cold = snir::TieredFunction{code};
+    assert(cold.call(std::array{snir::Literal{std::int64_t{10}}})->value == sum(10));
+    assert(cold.tier() == Tier::Interpreted and cold.backEdges() == 9);
+    assert(not cold.call({}).has_value());
+
+    // The third call crosses the threshold and every later one is compiled
+    auto hot = snir::TieredFunction{code, snir::TierPolicy{.calls = 3, .backEdges = 1'000'000}};
+    for (auto n = std::int64_t{0}; n < 5; ++n) {
+        assert(hot.call(std::array{snir::Literal{n}})->value == sum(n));
+        assert(hot.tier() == (n < 2 ? Tier::Interpreted : Tier::Compiled));
     }
+    assert(hot.calls() == 5 and hot.replacements() == 0);
+
+    // A long loop moves over at a block boundary in the middle of its first call
+    auto loop = snir::TieredFunction{code, snir::TierPolicy{.calls = 1'000, .backEdges = 100}};
+    assert(loop.call(std::array{snir::Literal{std::int64_t{100'000}}})->value == sum(100'000));
+    assert(loop.tier() == Tier::Compiled and loop.replacements() == 1);
+    assert(loop.backEdges() == 100);
 }
 
 auto optimize(snir::Module& module) -> void
@@ -173,5 +686,15 @@ auto main() -> int
         testFile(entry);
     }
 
+    testBatch();
+    testSuperinstructions();
+    testTypedCall();
+    testFrameCompaction();
+    testProfile();
+    testMemoize();
+    testScheduler();
+    testService();
+    testTiered();
+
     return EXIT_SUCCESS;
 }
@@ -0,0 +1,174 @@
+#undef NDEBUG
+
+#include "snir/x86/Jit.hpp"
+#include "snir/core/File.hpp"
+#include "snir/ir/Bytecode.hpp"
+#include "snir/ir/Function.hpp"
+#include "snir/ir/Interpreter.hpp"
+#include "snir/ir/Literal.hpp"
+#include "snir/ir/Parser.hpp"
+#include "snir/ir/Registry.hpp"
+#include "snir/ir/Type.hpp"
+
+#include "fmt/format.h"
+#include "fmt/os.h"
+
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace {
+
+using snir::x86::JitFunction;
+
+// The interpreter is the reference, fused and unfused bytecode must agree.
+template<typename R, typename... Args>
+auto check(std::string const& source, Args... args) -> void
+{
+    auto registry = snir::Registry{};
+    auto parser   = snir::Parser{registry};
+    auto module   = parser.read(source);
+    auto func     = snir::Function{registry, module.functions().at(0)};
+    auto vm       = snir::Interpreter{};
+    auto literals = std::array<snir::Literal, sizeof...(Args)>{snir::Literal{args}...};
+
+    for (auto fuse : {false, true}) {
+        auto const code     = snir::Bytecode::compile(func, fuse);
+        auto const expected = vm.execute(code, literals).value();
+        auto const jit      = JitFunction::compile(code);
+        auto const result   = jit.template get<R(Args...)>()(args...);
+        assert(snir::Literal{result}.value == expected.value);
+    }
+}
+
+template<typename T>
+auto testBinary(std::string_view op, std::string_view type) -> void
+{
+    auto const source = fmt::format(
+        "define {1} @func({1} %0, {1} %1) {{\n2:\n    %3 = {0} {1} %0, %1\n    ret {1} %3\n}}",
+        op,
+        type
+    );
+
+    auto const inputs = std::array{std::pair{100, 7}, std::pair{-45, 4}, std::pair{3, 3}};
+    for (auto [lhs, rhs] : inputs) {
+        check<T>(source, static_cast<T>(lhs), static_cast<T>(rhs));
+    }
+}
+
+auto testCompare(std::string_view cmp) -> void
+{
+    auto const source = fmt::format(
+        "define i1 @func(i64 %0, i64 %1) {{\n2:\n    %3 = icmp {} i64 %0, %1\n    ret i1 %3\n}}",
+        cmp
+    );
+    check<bool>(source, std::int64_t{4}, std::int64_t{4});
+    check<bool>(source, std::int64_t{4}, std::int64_t{5});
+}
+
+template<typename To, typename From>
+auto testTrunc(std::string_view to, std::string_view from, From value) -> void
+{
+    auto const source = fmt::format(
+        "define {0} @func({1} %0) {{\n1:\n    %2 = trunc %0 to {0}\n    ret {0} %2\n}}",
+        to,
+        from
+    );
+    check<To>(source, value);
+}
+
+auto testInstructions() -> void
+{
+    for (auto op : {"add", "sub", "mul", "div", "mod", "and", "or", "xor", "shl", "shr"}) {
+        testBinary<std::int64_t>(op, "i64");
+    }
+    for (auto op : {"fadd", "fsub", "fmul", "fdiv"}) {
+        testBinary<float>(op, "float");
+        testBinary<double>(op, "double");
+    }
+
+    testCompare("eq");
+    testCompare("ne");
+
+    testTrunc<float>("float", "i64", std::int64_t{-3});
+    testTrunc<double>("double", "i64", std::int64_t{1} << 40);
+    testTrunc<std::int64_t>("i64", "float", -2.75F);
+    testTrunc<double>("double", "float", 1.25F);
+    testTrunc<std::int64_t>("i64", "double", 1e12);
+    testTrunc<float>("float", "double", 0.1);
+
+    check<bool>("define i1 @func(i1 %0) {\n1:\n    ret i1 %0\n}", true);
+    check<bool>("define i1 @func(i1 %0) {\n1:\n    ret i1 %0\n}", false);
+}
+
+[[nodiscard]] auto call(JitFunction const& jit, snir::Type type) -> snir::Literal
+{
+    switch (type) {
+        case snir::Type::Bool: return snir::Literal{jit.get<bool()>()()};
+        case snir::Type::Int64: return snir::Literal{jit.get<std::int64_t()>()()};
+        case snir::Type::Float: return snir::Literal{jit.get<float()>()()};
+        case snir::Type::Double: return snir::Literal{jit.get<double()>()()};
+        default: jit.get<void()>()(); return snir::Literal{std::nan("")};
+    }
+}
+
+auto testFile(std::filesystem::path const& path) -> void
+{
+    fmt::println("; {}", path.string());
+
+    auto registry = snir::Registry{};
+    auto parser   = snir::Parser{registry};
+    auto module   = parser.read(snir::readFile(path).value());
+    auto func     = snir::Function{registry, module.functions().at(0)};
+    if (not func.arguments().empty()) {
+        return;
+    }
+
+    auto vm             = snir::Interpreter{};
+    auto const expected = vm.execute(func, {}).value();
+    auto const result   = call(JitFunction::compile(func), func.type());
+    assert(result.value == expected.value or func.type() == snir::Type::Void);
+}
+
+auto testLoop() -> void
+{
+    auto registry = snir::Registry{};
+    auto parser   = snir::Parser{registry};
+    auto module   = parser.read(snir::readFile("./test/files/i64_loop_args.ll").value());
+    auto code     = snir::Bytecode::compile(snir::Function{registry, module.functions().at(0)});
+    auto jit      = JitFunction::compile(code);
+    auto sum      = jit.get<std::int64_t(std::int64_t)>();
+    auto vm       = snir::Interpreter{};
+
+    for (auto n : std::array<std::int64_t, 6>{0, 1, 2, 10, 1000, 100'000}) {
+        auto const args = std::array{snir::Literal{n}};
+        assert(snir::Literal{sum(n)}.value == vm.execute(code, args)->value);
+        assert(sum(n) == n * (n - 1) / 2);
+    }
+}
+
+}  // namespace
+
+auto main() -> int
+{
+    if constexpr (not SNIR_HAS_X86_JIT) {
+        fmt::println("; jit not supported on this platform");
+        return EXIT_SUCCESS;
+    }
+
+    testInstructions();
+    for (auto const& entry : std::filesystem::directory_iterator{"./test/files"}) {
+        if (entry.is_regular_file()) {
+            testFile(entry);
+        }
+    }
+    testLoop();
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,172 @@
+#undef NDEBUG
+
+#include "snir/ir/Journal.hpp"
+#include "snir/ir/Bytecode.hpp"
+#include "snir/ir/Function.hpp"
+#include "snir/ir/InstKind.hpp"
+#include "snir/ir/Interpreter.hpp"
+#include "snir/ir/Literal.hpp"
+#include "snir/ir/Module.hpp"
+#include "snir/ir/Operands.hpp"
+#include "snir/ir/Parser.hpp"
+#include "snir/ir/Printer.hpp"
+#include "snir/ir/Registry.hpp"
+#include "snir/ir/Result.hpp"
+#include "snir/ir/Type.hpp"
+#include "snir/ir/Uses.hpp"
+#include "snir/ir/ValueId.hpp"
+#include "snir/ir/ValueKind.hpp"
+
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <cstdlib>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <variant>
+
+namespace {
+
+constexpr auto source = std::string_view{R"(
+define i64 @func(i64 %0) {
+1:
+    %2 = i64 2
+    %3 = i64 3
+    %4 = mul i64 %2, %3
+    %5 = add i64 %0, %4
+    ret i64 %5
+}
+)"};
+
+[[nodiscard]] auto call(snir::Function const& func, std::int64_t arg) -> std::int64_t
+{
+    auto vm         = snir::Interpreter{};
+    auto const args = std::array{snir::Literal{arg}};
+    auto const code = snir::Bytecode::compile(func);
+    return std::get<std::int64_t>(vm.execute(code, args)->value);
+}
+
+[[nodiscard]] auto print(snir::Module& module) -> std::string
+{
+    auto out     = std::ostringstream{};
+    auto printer = snir::Printer{out};
+    printer(module);
+    return out.str();
+}
+
+// Replaces the mul with a constant holding its value.
+[[nodiscard]] auto foldMul(snir::Journal& journal, snir::Registry& reg, snir::Function func)
+    -> snir::ValueId
+{
+    auto& insts       = func.basicBlocks().at(0).instructions;
+    auto const pos    = std::next(insts.begin(), 2);
+    auto const mul    = *pos;
+    auto const result = reg.get<snir::Result>(mul);
+
+    auto const inst = journal.create(snir::ValueKind::Instruction);
+    journal.emplace<snir::InstKind>(inst, snir::InstKind::Const);
+    journal.emplace<snir::Type>(inst, snir::Type::Int64);
+    journal.emplace<snir::Result>(inst, result);
+    journal.emplace<snir::Literal>(inst, std::int64_t{6});
+    auto const next = journal.erase(func, 0, pos);
+    (void)journal.insert(func, 0, next, inst);
+    journal.destroy(mul);
+    return inst;
+}
+
+auto testRollback() -> void
+{
+    auto registry     = snir::Registry{};
+    auto parser       = snir::Parser{registry};
+    auto module       = parser.read(source);
+    auto const func   = module.functions().at(0);
+    auto const before = print(module);
+    auto const mul    = func.basicBlocks().at(0).instructions.at(2);
+    auto const two    = registry.get<snir::Result>(func.basicBlocks().at(0).instructions.at(0)).id;
+
+    auto journal = snir::Journal{registry};
+    journal.begin();
+    auto const inst = foldMul(journal, registry, func);
+    assert(not registry.valid(mul));
+    assert(snir::useCount(registry, two) == 0);
+    assert(call(func, 1) == 7);
+    assert(print(module) != before);
+
+    journal.rollback();
+    assert(journal.depth() == 0 and journal.size() == 0);
+    assert(not registry.valid(inst));
+    assert(registry.valid(mul));
+    assert(registry.get<snir::InstKind>(mul) == snir::InstKind::Mul);
+    assert(snir::useCount(registry, two) == 1 and snir::users(registry, two)[0] == mul);
+    assert(print(module) == before);
+    assert(call(func, 1) == 7);
+}
+
+auto testNested() -> void
+{
+    auto registry     = snir::Registry{};
+    auto parser       = snir::Parser{registry};
+    auto module       = parser.read(source);
+    auto const func   = module.functions().at(0);
+    auto const before = print(module);
+    auto const add    = func.basicBlocks().at(0).instructions.at(3);
+    auto const ops    = registry.get<snir::Operands>(add);
+    auto const arg    = ops.list[0];
+    auto const prod   = ops.list[1];
+
+    // A committed inner scope is still undone by the outer rollback.
+    auto journal = snir::Journal{registry};
+    journal.begin();
+    journal.replace<snir::Operands>(add, snir::Operands{{arg, arg}});
+    assert(snir::useCount(registry, arg) == 2 and snir::useCount(registry, prod) == 0);
+    assert(call(func, 1) == 2);
+
+    journal.begin();
+    (void)foldMul(journal, registry, func);
+    journal.commit();
+    assert(journal.depth() == 1);
+
+    journal.rollback();
+    assert(print(module) == before);
+    assert(snir::useCount(registry, arg) == 1 and snir::useCount(registry, prod) == 1);
+    assert(call(func, 1) == 7);
+
+    // In place edits go through save with the uses unlinked around them.
+    journal.begin();
+    journal.save<snir::Operands>(add);
+    snir::removeUses(registry, add);
+    registry.get<snir::Operands>(add).list[1] = arg;
+    snir::addUses(registry, add);
+    assert(snir::useCount(registry, prod) == 0);
+    journal.rollback();
+    assert(snir::useCount(registry, arg) == 1 and snir::useCount(registry, prod) == 1);
+
+    // Committing the outermost scope keeps the edits and drops the records.
+    journal.begin();
+    auto const inst = foldMul(journal, registry, func);
+    journal.commit();
+    assert(journal.size() == 0);
+    assert(registry.valid(inst));
+    assert(print(module) != before);
+    assert(call(func, 1) == 7);
+
+    auto threw = false;
+    try {
+        journal.rollback();
+    } catch (std::logic_error const&) {
+        threw = true;
+    }
+    assert(threw);
+}
+
+}  // namespace
+
+auto main() -> int
+{
+    testRollback();
+    testNested();
+    return EXIT_SUCCESS;
+}
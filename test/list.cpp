@@ -0,0 +1,118 @@
+#undef NDEBUG
+
+#include "snir/ir/InstructionList.hpp"
+#include "snir/ir/ValueId.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstdlib>
+#include <iterator>
+#include <ranges>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+[[nodiscard]] auto id(std::uint32_t i) -> snir::ValueId { return snir::ValueId{i}; }
+
+[[nodiscard]] auto index(snir::ValueId id) -> std::uint32_t { return static_cast<std::uint32_t>(id); }
+
+auto testList() -> void
+{
+    auto list = snir::InstructionList{id(1), id(2), id(3)};
+    assert(list.size() == 3);
+    assert(list.front() == id(1) and list.back() == id(3));
+    assert(list.at(1) == id(2));
+    assert(std::ranges::distance(list) == 3);
+    static_assert(std::ranges::bidirectional_range<snir::InstructionList>);
+
+    // Iterators to other instructions survive inserts and erases.
+    auto const two   = std::next(list.begin());
+    auto const three = std::next(two);
+    list.insert(two, id(4));
+    list.push_front(id(0));
+    list.erase(two);
+    assert(*three == id(3));
+    assert((list == snir::InstructionList{id(0), id(1), id(4), id(3)}));
+
+    // Erased nodes are reused.
+    list.push_back(id(5));
+    assert((list == snir::InstructionList{id(0), id(1), id(4), id(3), id(5)}));
+    assert(*std::prev(list.end()) == id(5));
+
+    list.splice(list.begin(), list, three);
+    assert(*three == id(3));
+    assert((list == snir::InstructionList{id(3), id(0), id(1), id(4), id(5)}));
+
+    auto other = snir::InstructionList{id(7)};
+    other.splice(other.end(), list, list.begin());
+    assert((other == snir::InstructionList{id(7), id(3)}));
+    assert(list.size() == 4);
+
+    std::ranges::transform(list, list.begin(), [](auto v) { return id(index(v) * 2); });
+    assert((list == snir::InstructionList{id(0), id(2), id(8), id(10)}));
+    assert(snir::erase_if(list, [](auto v) { return index(v) > 4; }) == 2);
+    assert((list == snir::InstructionList{id(0), id(2)}));
+
+    list.erase(list.begin(), list.end());
+    assert(list.empty());
+    assert(list.begin() == list.end());
+
+    auto threw = false;
+    try {
+        (void)list.at(0);
+    } catch (std::out_of_range const&) {
+        threw = true;
+    }
+    assert(threw);
+}
+
+// Erases every second instruction and inserts a new one in front of every
+// fourth, the access pattern of a pass that sinks or rewrites in place.
+template<typename Container>
+auto rewrite(Container& insts) -> void
+{
+    auto next = static_cast<std::uint32_t>(insts.size());
+    auto pos  = 0U;
+    for (auto it = insts.begin(); it != insts.end(); ++pos) {
+        if (pos % 2 == 1) {
+            it = insts.erase(it);
+            continue;
+        }
+        if (pos % 4 == 0) {
+            it = std::next(insts.insert(it, id(next++)));
+        }
+        ++it;
+    }
+}
+
+// The list has to end up like a vector after the same edits.
+auto testRewrite() -> void
+{
+    auto vector = std::vector<snir::ValueId>{};
+    auto list   = snir::InstructionList{};
+    for (auto i = 0U; i < 1'000U; ++i) {
+        vector.push_back(id(i));
+        list.push_back(id(i));
+    }
+
+    rewrite(vector);
+    rewrite(list);
+    assert(list.size() == vector.size());
+    assert(std::ranges::equal(vector, list));
+
+    rewrite(vector);
+    rewrite(list);
+    assert(std::ranges::equal(vector, list));
+    assert(std::ranges::equal(std::views::reverse(vector), std::views::reverse(list)));
+}
+
+}  // namespace
+
+auto main() -> int
+{
+    testList();
+    testRewrite();
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,369 @@
+#undef NDEBUG
+
+#include "snir/ir/Module.hpp"
+#include "snir/core/StringPool.hpp"
+#include "snir/ir/AnalysisManager.hpp"
+#include "snir/ir/Bytecode.hpp"
+#include "snir/ir/Function.hpp"
+#include "snir/ir/FunctionDefinition.hpp"
+#include "snir/ir/Groups.hpp"
+#include "snir/ir/Identifier.hpp"
+#include "snir/ir/InstKind.hpp"
+#include "snir/ir/Instruction.hpp"
+#include "snir/ir/Interpreter.hpp"
+#include "snir/ir/Literal.hpp"
+#include "snir/ir/Operands.hpp"
+#include "snir/ir/Parser.hpp"
+#include "snir/ir/pass/DeadStoreElimination.hpp"
+#include "snir/ir/pass/RemoveNop.hpp"
+#include "snir/ir/PassManager.hpp"
+#include "snir/ir/Printer.hpp"
+#include "snir/ir/Registry.hpp"
+#include "snir/ir/Result.hpp"
+#include "snir/ir/ResultCache.hpp"
+#include "snir/ir/Type.hpp"
+#include "snir/ir/Uses.hpp"
+#include "snir/ir/Value.hpp"
+#include "snir/ir/ValueId.hpp"
+#include "snir/ir/ValueKind.hpp"
+
+#include "fmt/format.h"
+
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <cstdlib>
+#include <span>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <variant>
+#include <vector>
+
+namespace {
+
+constexpr auto source = std::string_view{R"(
+define i64 @add(i64 %0) {
+1:
+    %2 = i64 40
+    %3 = i64 7
+    %4 = mul i64 %0, %3
+    %5 = add i64 %0, %2
+    ret i64 %5
+}
+
+define i64 @sub(i64 %0) {
+1:
+    %2 = i64 2
+    %3 = sub i64 %0, %2
+    ret i64 %3
+}
+
+define i64 @mul(i64 %0) {
+1:
+    %2 = i64 3
+    %3 = mul i64 %0, %2
+    ret i64 %3
+}
+)"};
+
+[[nodiscard]] auto call(snir::Function const& func, std::int64_t arg) -> std::int64_t
+{
+    auto vm         = snir::Interpreter{};
+    auto const args = std::array{snir::Literal{arg}};
+    auto const code = snir::Bytecode::compile(func);
+    return std::get<std::int64_t>(vm.execute(code, args)->value);
+}
+
+auto testStringPool() -> void
+{
+    auto pool      = snir::StringPool{};
+    auto const foo = pool.intern("foo");
+    auto const bar = pool.intern("bar");
+    assert(foo != bar);
+    assert(pool.intern(std::string{"foo"}) == foo);
+    assert(pool.text(foo) == "foo");
+    assert(pool.find("bar") == bar);
+    assert(not pool.find("baz").has_value());
+
+    // Views stay valid when the arena grows, even for strings longer than a chunk.
+    auto const text = pool.text(bar);
+    auto const huge = pool.intern(std::string(10'000, 'x'));
+    for (auto i = 0; i < 1000; ++i) {
+        (void)pool.intern(fmt::format("value_{}", i));
+    }
+    assert(text.data() == pool.text(bar).data());
+    assert(pool.text(huge).size() == 10'000);
+    assert(pool.size() == 1003);
+
+    // Every thread sees the same symbol for the same string.
+    auto symbols = std::array<std::vector<snir::Symbol>, 4>{};
+    auto threads = std::vector<std::thread>{};
+    for (auto& list : symbols) {
+        threads.emplace_back([&pool, &list] {
+            for (auto i = 0; i < 2000; ++i) {
+                list.push_back(pool.intern(fmt::format("value_{}", i)));
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (auto const& list : symbols) {
+        assert(list == symbols[0]);
+    }
+    assert(pool.size() == 2003);
+}
+
+auto testSymbols() -> void
+{
+    auto registry = snir::Registry{};
+    auto module   = snir::Module{registry};
+
+    auto const func = module.create("func", snir::Type::Int64);
+    assert(func.identifier() == "func");
+    assert(module.functions().size() == 1);
+    assert(module.function("func").has_value());
+    assert(not module.function("other").has_value());
+
+    auto threw = false;
+    try {
+        (void)module.create("func", snir::Type::Void);
+    } catch (std::invalid_argument const&) {
+        threw = true;
+    }
+    assert(threw);
+
+    module.erase("func");
+    assert(module.functions().empty());
+    assert(not module.function("func").has_value());
+    assert(not registry.valid(func));
+}
+
+auto testShared() -> void
+{
+    auto registry = snir::Registry{};
+    auto parser   = snir::Parser{registry};
+    auto module   = parser.read(source);
+    assert(module.storage() == snir::FunctionStorage::Shared);
+    assert(module.functions().size() == 3);
+
+    for (auto const& func : module.functions()) {
+        assert(func.asValue().registry() == &registry);
+    }
+
+    // Erasing destroys every value of the function, the others stay intact.
+    auto const sub   = module.function("sub").value();
+    auto const label = sub.basicBlocks().at(0).label;
+    auto const inst  = sub.basicBlocks().at(0).instructions.at(1);
+    module.erase("sub");
+    assert(not registry.valid(sub) and not registry.valid(label) and not registry.valid(inst));
+    assert(call(module.function("add").value(), 2) == 42);
+    assert(call(module.function("mul").value(), 2) == 6);
+}
+
+auto testIsolated() -> void
+{
+    auto registry = snir::Registry{};
+    auto parser   = snir::Parser{registry};
+    auto module   = parser.read(source, snir::FunctionStorage::Isolated);
+    assert(module.storage() == snir::FunctionStorage::Isolated);
+    assert(module.functions().size() == 3);
+    assert(registry.storage<snir::Type>().size() == 0);
+
+    auto const& funcs = module.functions();
+    assert(funcs[0].asValue().registry() != funcs[1].asValue().registry());
+    assert(funcs[1].asValue().registry() != funcs[2].asValue().registry());
+
+    // Names are interned once for the whole module.
+    for (auto const& func : funcs) {
+        assert(&snir::symbols(*func.asValue().registry()) == &module.symbols());
+        assert(module.symbols().text(func.symbol()) == func.identifier());
+        assert(snir::instructionGroup(*func.asValue().registry()));
+    }
+
+    // Each function is optimized on its own thread without any locking.
+    auto threads = std::vector<std::thread>{};
+    for (auto func : funcs) {
+        threads.emplace_back([func]() mutable {
+            auto analysis = snir::AnalysisManager<snir::Function>{};
+            auto pm       = snir::PassManager{};
+            pm.add(snir::DeadStoreElimination{});
+            pm.add(snir::RemoveNop{});
+            pm(func, analysis);
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    auto const add = module.function("add").value();
+    assert(add.numInstructions() == 3);
+    assert(call(add, 2) == 42);
+    assert(call(module.function("sub").value(), 2) == 0);
+    assert(call(module.function("mul").value(), 2) == 6);
+
+    module.erase("add");
+    assert(module.functions().size() == 2);
+    assert(not module.function("add").has_value());
+    assert(call(module.function("mul").value(), 3) == 9);
+}
+
+[[nodiscard]] auto print(snir::Module& module) -> std::string
+{
+    auto out     = std::ostringstream{};
+    auto printer = snir::Printer{out};
+    printer(module);
+    return out.str();
+}
+
+auto optimize(snir::Module& module) -> void
+{
+    auto pm = snir::PassManager{};
+    pm.add(snir::DeadStoreElimination{});
+    pm.add(snir::RemoveNop{});
+    pm(module);
+}
+
+auto testCollectGarbage() -> void
+{
+    auto registry = snir::Registry{};
+    auto parser   = snir::Parser{registry};
+    auto module   = parser.read(source);
+    auto const dead = module.function("add")->basicBlocks().at(0).instructions.at(2);
+
+    // The dead mul and the constant only it reads, their registers and the nop.
+    optimize(module);
+    auto const entities = registry.storage<snir::ValueKind>().size();
+    assert(module.collectGarbage() == 5);
+    assert(registry.storage<snir::ValueKind>().size() == entities - 5);
+    assert(not registry.valid(dead));
+    assert(module.collectGarbage() == 0);
+    assert(call(module.function("add").value(), 2) == 42);
+
+    // An instruction that never made it into a block leaves the use list with it.
+    auto const arg   = module.function("add")->arguments().at(0);
+    auto const stray = snir::Instruction::create(registry, snir::InstKind::Add, snir::Type::Int64);
+    stray.operands(snir::Operands{{arg, arg}});
+    assert(snir::useCount(registry, arg) == 3);
+    assert(module.collectGarbage() == 1);
+    assert(snir::useCount(registry, arg) == 1);
+}
+
+auto testCompact() -> void
+{
+    for (auto storage : {snir::FunctionStorage::Shared, snir::FunctionStorage::Isolated}) {
+        auto registry = snir::Registry{};
+        auto parser   = snir::Parser{registry};
+        auto module   = parser.read(source, storage);
+
+        // An unused global survives like in collectGarbage.
+        auto& first = *module.functions().at(0).asValue().registry();
+        auto global  = snir::createValue(first, snir::ValueKind::Global);
+        global.emplace<snir::Type>(snir::Type::Int64);
+
+        optimize(module);
+        auto const before = print(module);
+        auto cache        = snir::ResultCache{1024 * 1024};
+        auto const args   = std::array{snir::Literal{std::int64_t{2}}};
+        for (auto const& func : module.functions()) {
+            cache.insert(func, args, snir::Literal{std::int64_t{-1}});
+        }
+
+        module.compact();
+        assert(print(module) == before);
+        assert(snir::generation(first) == snir::Generation{1});
+
+        // Renumbered ids may now name another function, old entries must not hit.
+        for (auto const& func : module.functions()) {
+            assert(not cache.find(func, args).has_value());
+        }
+
+        auto globals = 0;
+        for (auto const id : first.view<snir::ValueKind>()) {
+            globals += first.get<snir::ValueKind>(id) == snir::ValueKind::Global ? 1 : 0;
+        }
+        assert(globals == 1);
+
+        // Only reachable values are left and their ids are dense.
+        for (auto const& func : module.functions()) {
+            auto& reg       = *func.asValue().registry();
+            auto const size = reg.storage<snir::ValueKind>().size();
+            for (auto const inst : func.basicBlocks().at(0).instructions) {
+                assert(entt::to_entity(inst) < size);
+            }
+        }
+        // The use lists were carried over with renumbered users.
+        auto const add = module.function("add").value();
+        auto& reg      = *add.asValue().registry();
+        auto const ret = add.basicBlocks().at(0).instructions.back();
+        auto const sum = reg.get<snir::Operands>(ret).list[0];
+        assert(snir::useCount(reg, add.arguments().at(0)) == 1);
+        assert(snir::users(reg, sum).size() == 1 and snir::users(reg, sum).front() == ret);
+
+        assert(module.collectGarbage() == 0);
+        assert(call(module.function("add").value(), 2) == 42);
+        assert(call(module.function("sub").value(), 2) == 0);
+        assert(call(module.function("mul").value(), 2) == 6);
+    }
+}
+
+// IR built on a registry no module declared groups for is compiled and
+// printed through the registry, without creating the groups behind a const API.
+auto testUndeclaredGroups() -> void
+{
+    auto registry = snir::Registry{};
+    auto func     = snir::Function::create(registry, snir::Type::Int64);
+    func.identifier("answer");
+
+    auto const result = snir::createValue(registry, snir::ValueKind::Register);
+    result.emplace<snir::Type>(snir::Type::Int64);
+
+    auto const one = snir::Instruction::create(registry, snir::InstKind::Const, snir::Type::Int64);
+    one.asValue().emplace<snir::Result>(result);
+    one.asValue().emplace<snir::Literal>(std::int64_t{42});
+
+    auto const ret = snir::Instruction::create(registry, snir::InstKind::Return, snir::Type::Int64);
+    ret.operands(snir::Operands{{result}});
+
+    auto const label = snir::createValue(registry, snir::ValueKind::Label);
+    func.asValue().emplace<snir::FunctionDefinition>(
+        std::vector<snir::ValueId>{},
+        std::vector{snir::BasicBlock{.label = label, .instructions = {one, ret}}}
+    );
+
+    auto vm         = snir::Interpreter{};
+    auto const code = snir::Bytecode::compile(func);
+    assert(std::get<std::int64_t>(vm.execute(code, std::span<snir::Literal const>{})->value) == 42);
+
+    auto out      = std::ostringstream{};
+    auto printer  = snir::Printer{out};
+    auto analysis = snir::AnalysisManager<snir::Function>{};
+    printer(func, analysis);
+    assert(out.str().find("define i64 @answer()") != std::string::npos);
+    assert(out.str().find("ret i64 %1") != std::string::npos);
+
+    assert(not snir::instructionGroup(registry));
+    assert(not snir::literalGroup(registry));
+    assert(not snir::branchGroup(registry));
+
+    // A module declares them for its registry up front.
+    auto const module = snir::Module{registry};
+    assert(snir::instructionGroup(registry) and snir::literalGroup(registry));
+}
+
+}  // namespace
+
+auto main() -> int
+{
+    testStringPool();
+    testSymbols();
+    testShared();
+    testIsolated();
+    testCollectGarbage();
+    testCompact();
+    testUndeclaredGroups();
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,112 @@
+#undef NDEBUG
+
+#include "snir/ir/NativeModule.hpp"
+#include "snir/core/File.hpp"
+#include "snir/ir/Bytecode.hpp"
+#include "snir/ir/CWriter.hpp"
+#include "snir/ir/Function.hpp"
+#include "snir/ir/Interpreter.hpp"
+#include "snir/ir/Literal.hpp"
+#include "snir/ir/Parser.hpp"
+#include "snir/ir/Registry.hpp"
+#include "snir/ir/Type.hpp"
+
+#include "fmt/format.h"
+#include "fmt/os.h"
+
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <sstream>
+#include <string>
+#include <string_view>
+
+namespace {
+
+[[nodiscard]] auto call(snir::NativeModule const& native, snir::Function const& func)
+    -> snir::Literal
+{
+    auto const name = func.identifier();
+    switch (func.type()) {
+        case snir::Type::Bool: return snir::Literal{native.get<bool()>(name)()};
+        case snir::Type::Int64: return snir::Literal{native.get<std::int64_t()>(name)()};
+        case snir::Type::Float: return snir::Literal{native.get<float()>(name)()};
+        case snir::Type::Double: return snir::Literal{native.get<double()>(name)()};
+        default: native.get<void()>(name)(); return snir::Literal{std::nan("")};
+    }
+}
+
+auto testFile(std::filesystem::path const& path) -> void
+{
+    fmt::println("; {}", path.string());
+
+    auto registry = snir::Registry{};
+    auto parser   = snir::Parser{registry};
+    auto module   = parser.read(snir::readFile(path).value());
+    auto func     = snir::Function{registry, module.functions().at(0)};
+    auto native   = snir::NativeModule::compile(module);
+    if (not func.arguments().empty()) {
+        return;
+    }
+
+    auto vm             = snir::Interpreter{};
+    auto const expected = vm.execute(func, {}).value();
+    auto const result   = call(native, func);
+    assert(result.value == expected.value or func.type() == snir::Type::Void);
+}
+
+auto testSource() -> void
+{
+    auto registry = snir::Registry{};
+    auto parser   = snir::Parser{registry};
+    auto module   = parser.read(snir::readFile("./test/files/i64_loop_swap.ll").value());
+    auto source   = std::ostringstream{};
+    auto writer   = snir::CWriter{source};
+    writer(module);
+
+    // The swapping phis go through temporaries.
+    auto const text = source.str();
+    assert(text.find("int64_t func(void)") != std::string::npos);
+    assert(text.find("int64_t t1 = ") != std::string::npos);
+    assert(text.find("goto bb") != std::string::npos);
+}
+
+auto testLoop() -> void
+{
+    auto registry = snir::Registry{};
+    auto parser   = snir::Parser{registry};
+    auto module   = parser.read(snir::readFile("./test/files/i64_loop_args.ll").value());
+    auto func     = snir::Function{registry, module.functions().at(0)};
+    auto code     = snir::Bytecode::compile(func);
+    auto native   = snir::NativeModule::compile(module);
+    auto sum      = native.get<std::int64_t(std::int64_t)>(func.identifier());
+    auto vm       = snir::Interpreter{};
+
+    for (auto n : std::array<std::int64_t, 6>{0, 1, 2, 10, 1000, 100'000}) {
+        auto const args = std::array{snir::Literal{n}};
+        assert(snir::Literal{sum(n)}.value == vm.execute(code, args)->value);
+    }
+}
+
+}  // namespace
+
+auto main() -> int
+{
+    if constexpr (not SNIR_HAS_NATIVE_MODULE) {
+        fmt::println("; native modules not supported on this platform");
+        return EXIT_SUCCESS;
+    }
+
+    testSource();
+    for (auto const& entry : std::filesystem::directory_iterator{"./test/files"}) {
+        if (entry.is_regular_file()) {
+            testFile(entry);
+        }
+    }
+    testLoop();
+
+    return EXIT_SUCCESS;
+}
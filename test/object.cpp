@@ -0,0 +1,181 @@
+#undef NDEBUG
+
+#include "snir/x86/ObjectFile.hpp"
+#include "snir/core/File.hpp"
+#include "snir/ir/Function.hpp"
+#include "snir/ir/Interpreter.hpp"
+#include "snir/ir/Literal.hpp"
+#include "snir/ir/Parser.hpp"
+#include "snir/ir/Registry.hpp"
+#include "snir/ir/Type.hpp"
+#include "snir/x86/Assembler.hpp"
+#include "snir/x86/Jit.hpp"
+
+#include "fmt/format.h"
+#include "fmt/os.h"
+
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <ios>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <variant>
+
+namespace {
+
+auto const directory = std::filesystem::temp_directory_path() / "snir-test-object";
+
+[[nodiscard]] auto compiler() -> std::string
+{
+    auto const* cc = std::getenv("CC");  // NOLINT(concurrency-mt-unsafe)
+    return cc != nullptr ? std::string{cc} : std::string{"cc"};
+}
+
+// Links the object with a C harness whose exit code is the test result.
+[[nodiscard]] auto link(snir::x86::ObjectFile const& object, std::string_view harness) -> bool
+{
+    auto const obj = directory / "module.o";
+    auto const src = directory / "harness.c";
+    auto const exe = directory / "harness";
+    {
+        auto out = std::ofstream{obj, std::ios::out | std::ios::binary};
+        object.write(out);
+    }
+    {
+        auto out = std::ofstream{src};
+        out << "#include <stdint.h>\n#include <stdbool.h>\n" << harness;
+    }
+
+    auto const command = fmt::format(
+        "{} -std=c11 -o '{}' '{}' '{}'",
+        compiler(),
+        exe.string(),
+        src.string(),
+        obj.string()
+    );
+    if (std::system(command.c_str()) != 0) {  // NOLINT(concurrency-mt-unsafe)
+        return false;
+    }
+    return std::system(fmt::format("'{}'", exe.string()).c_str()) == 0;  // NOLINT
+}
+
+[[nodiscard]] auto harness(std::string_view name, snir::Type type, snir::Literal expected)
+    -> std::string
+{
+    if (type == snir::Type::Void) {
+        return fmt::format("void {0}(void);\nint main(void) {{ {0}(); return 0; }}\n", name);
+    }
+
+    // Hex floats keep the expected value exact in the C source.
+    auto const value = std::visit(
+        [](auto v) {
+            using T = decltype(v);
+            if constexpr (std::is_same_v<T, float>) {
+                return fmt::format("{:a}f", v);
+            } else if constexpr (std::is_same_v<T, double>) {
+                return fmt::format("{:a}", v);
+            } else if constexpr (std::is_same_v<T, std::int64_t>) {
+                return fmt::format("INT64_C({})", v);
+            } else {
+                return fmt::format("{}", v);
+            }
+        },
+        expected.value
+    );
+
+    auto const* result = type == snir::Type::Bool    ? "bool"
+                         : type == snir::Type::Int64 ? "int64_t"
+                         : type == snir::Type::Float ? "float"
+                                                     : "double";
+    return fmt::format(
+        "{0} {1}(void);\nint main(void) {{ return {1}() != {2}; }}\n",
+        result,
+        name,
+        value
+    );
+}
+
+auto testFile(std::filesystem::path const& path) -> void
+{
+    fmt::println("; {}", path.string());
+
+    auto registry = snir::Registry{};
+    auto parser   = snir::Parser{registry};
+    auto module   = parser.read(snir::readFile(path).value());
+    auto func     = snir::Function{registry, module.functions().at(0)};
+    auto object   = snir::x86::ObjectFile::compile(module);
+    if (not func.arguments().empty()) {
+        return;
+    }
+
+    auto vm             = snir::Interpreter{};
+    auto const expected = vm.execute(func, {}).value();
+    assert(link(object, harness(func.identifier(), func.type(), expected)));
+}
+
+auto testArguments() -> void
+{
+    auto registry = snir::Registry{};
+    auto parser   = snir::Parser{registry};
+    auto module   = parser.read(snir::readFile("./test/files/i64_loop_args.ll").value());
+    auto object   = snir::x86::ObjectFile::compile(module);
+
+    assert(link(object, R"(
+int64_t func(int64_t);
+int main(void) { return func(0) != 0 || func(10) != 45 || func(1000) != 499500; }
+)"));
+}
+
+// A tail call into the harness, resolved by the linker through the
+// relocation on the jump.
+auto testRelocation() -> void
+{
+    auto assembler = snir::x86::Assembler{};
+    auto const at  = assembler.jmp();
+    auto const rel = std::array{snir::x86::Relocation{.offset = at, .symbol = "twice"}};
+
+    auto object = snir::x86::ObjectFile{};
+    object.add("forward", assembler.code(), rel);
+    object.add("trap", std::array<std::uint8_t, 2>{0x0F, 0x0B});
+
+    // Functions are 16 byte aligned in the text section.
+    assert(object.text().size() == 18);
+    assert(object.text()[5] == 0xCC and object.text()[16] == 0x0F);
+
+    auto const bytes = object.bytes();
+    assert(bytes.size() > 64 and bytes[0] == 0x7F and bytes[1] == 'E' and bytes[4] == 2);
+    assert(bytes[16] == 1 and bytes[18] == 62);
+
+    assert(link(object, R"(
+int64_t forward(int64_t);
+int64_t twice(int64_t x) { return 2 * x; }
+int main(void) { return forward(21) != 42; }
+)"));
+}
+
+}  // namespace
+
+auto main() -> int
+{
+    if constexpr (not SNIR_HAS_X86_JIT) {
+        fmt::println("; object files can only be linked and run on x86-64 linux");
+        return EXIT_SUCCESS;
+    }
+
+    std::filesystem::create_directories(directory);
+    for (auto const& entry : std::filesystem::directory_iterator{"./test/files"}) {
+        if (entry.is_regular_file()) {
+            testFile(entry);
+        }
+    }
+    testArguments();
+    testRelocation();
+    std::filesystem::remove_all(directory);
+
+    return EXIT_SUCCESS;
+}
@@ -7,6 +7,7 @@
 #include "snir/ir/Branch.hpp"
 #include "snir/ir/CompareKind.hpp"
 #include "snir/ir/Function.hpp"
+#include "snir/ir/Groups.hpp"
 #include "snir/ir/Identifier.hpp"
 #include "snir/ir/InstKind.hpp"
 #include "snir/ir/Instruction.hpp"
@@ -133,6 +134,33 @@ auto testParser() -> void
     assert(br.iftrue == blocks.at(1).label);
 }
 
+// Every instruction the parser creates has to end up in the group that owns
+// its components.
+auto testParserGroups() -> void
+{
+    auto registry = Registry{};
+    auto parser   = Parser{registry};
+    auto module   = parser.read(readFile("./test/files/i64_loop_args.ll").value());
+
+    auto const insts    = instructionGroup(registry);
+    auto const consts   = literalGroup(registry);
+    auto const branches = branchGroup(registry);
+
+    auto const func = Function{Value(registry, module.functions().at(0))};
+    for (auto const& block : func.basicBlocks()) {
+        for (auto const id : block.instructions) {
+            auto const inst = Instruction{Value{registry, id}};
+            switch (inst.kind()) {
+                case InstKind::Const: assert(consts.contains(id)); break;
+                case InstKind::Branch: assert(branches.contains(id)); break;
+                case InstKind::Return:
+                case InstKind::Phi: assert(not insts.contains(id)); break;
+                default: assert(insts.contains(id)); break;
+            }
+        }
+    }
+}
+
 auto testParserErrors() -> void
 {
     auto registry = Registry{};
@@ -155,6 +183,7 @@ auto main() -> int
     testIdentifierParser();
     testInstKindParser();
     testParser();
+    testParserGroups();
     testParserErrors();
     return EXIT_SUCCESS;
 }
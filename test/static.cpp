@@ -0,0 +1,133 @@
+#undef NDEBUG
+
+#include "snir/ir/StaticFunction.hpp"
+#include "snir/core/File.hpp"
+#include "snir/ir/Bytecode.hpp"
+#include "snir/ir/Function.hpp"
+#include "snir/ir/Interpreter.hpp"
+#include "snir/ir/Parser.hpp"
+#include "snir/ir/Registry.hpp"
+#include "snir/ir/Type.hpp"
+
+#include "fmt/format.h"
+
+#include <cassert>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+
+namespace {
+
+constexpr auto add = snir::StaticFunction<
+    R"(
+define i64 @add(i64 %0, i64 %1) {
+2:
+    %3 = add i64 %0, %1
+    ret i64 %3
+})",
+    std::int64_t(std::int64_t, std::int64_t)>{};
+
+constexpr auto sum = snir::StaticFunction<
+    R"(
+define i64 @sum(i64 %0) {
+1:
+    %2 = i64 0
+    %3 = i64 1
+    %4 = icmp eq i64 %0, %2
+    br i1 %4, label %11, label %5
+5:
+    %6 = phi i64 [ %2, %1 ], [ %9, %5 ]
+    %7 = phi i64 [ %2, %1 ], [ %8, %5 ]
+    %8 = add i64 %7, %6
+    %9 = add i64 %6, %3
+    %10 = icmp ne i64 %9, %0
+    br i1 %10, label %5, label %11
+11:
+    %12 = phi i64 [ %2, %1 ], [ %8, %5 ]
+    ret i64 %12
+})",
+    std::int64_t(std::int64_t)>{};
+
+// The phis swap their values, the copies go through the scratch slot.
+constexpr auto swap = snir::StaticFunction<
+    R"(
+define i64 @swap(i64 %0) {
+1:
+    %2 = i64 1
+    %3 = i64 2
+    %4 = i64 0
+    br label %5
+5:
+    %6 = phi i64 [ %2, %1 ], [ %7, %5 ]
+    %7 = phi i64 [ %3, %1 ], [ %6, %5 ]
+    %8 = phi i64 [ %4, %1 ], [ %9, %5 ]
+    %9 = add i64 %8, %2
+    %10 = icmp ne i64 %9, %0
+    br i1 %10, label %5, label %11
+11:
+    ret i64 %6
+})",
+    std::int64_t(std::int64_t)>{};
+
+constexpr auto scale = snir::StaticFunction<
+    R"(
+define double @scale(i64 %0) {
+1:
+    %2 = trunc %0 to double
+    %3 = double 2.5
+    %4 = fmul double %2, %3
+    ret double %4
+})",
+    double(std::int64_t)>{};
+
+constexpr auto nothing = snir::StaticFunction<"define void @f() {\n0:\n    ret void\n}", void()>{};
+
+static_assert(add(2, 3) == 5);
+static_assert(sum(0) == 0 and sum(10) == 45);
+static_assert(swap(1) == 1 and swap(2) == 2 and swap(5) == 1);
+static_assert(scale(3) == 7.5);
+
+constexpr auto const& flag = snir::staticCode<"define i1 @f() {\n0:\n  %1 = i1 1\n  ret i1 %1\n}">;
+static_assert(flag.numInsts == 2 and flag.constants[0] == 1 and flag.type == snir::Type::Bool);
+
+// The constexpr compiler also runs at runtime, it has to agree with the
+// parser on every test file.
+auto testFile(std::filesystem::path const& path) -> void
+{
+    fmt::println("; {}", path.string());
+
+    auto const source = snir::readFile(path).value();
+    auto registry     = snir::Registry{};
+    auto parser       = snir::Parser{registry};
+    auto module       = parser.read(source);
+    auto const func   = snir::Function{registry, module.functions().at(0)};
+
+    auto const expected = snir::Bytecode::compile(func, false);
+    auto const code     = snir::detail::StaticCompiler{source}.run();
+    assert(code.type == expected.type and code.arguments == expected.arguments);
+    assert(code.code.size() == expected.code.size() and code.registers == expected.registers);
+    if (not code.arguments.empty() or code.type == snir::Type::Void) {
+        return;
+    }
+
+    auto vm = snir::Interpreter{};
+    assert(vm.execute(code, {})->value == vm.execute(expected, {})->value);
+}
+
+}  // namespace
+
+auto main() -> int
+{
+    for (auto const& entry : std::filesystem::directory_iterator{"./test/files"}) {
+        if (entry.is_regular_file()) {
+            testFile(entry);
+        }
+    }
+
+    auto volatile n = std::int64_t{100'000};
+    assert(sum(n) == n * (n - 1) / 2);
+    assert(add(n, 1) == n + 1);
+    nothing();
+
+    return EXIT_SUCCESS;
+}
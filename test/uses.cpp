@@ -0,0 +1,200 @@
+#undef NDEBUG
+
+#include "snir/ir/Uses.hpp"
+#include "snir/core/File.hpp"
+#include "snir/ir/AnalysisManager.hpp"
+#include "snir/ir/Bytecode.hpp"
+#include "snir/ir/BasicBlock.hpp"
+#include "snir/ir/Function.hpp"
+#include "snir/ir/FunctionDefinition.hpp"
+#include "snir/ir/InstKind.hpp"
+#include "snir/ir/Instruction.hpp"
+#include "snir/ir/Interpreter.hpp"
+#include "snir/ir/Literal.hpp"
+#include "snir/ir/Module.hpp"
+#include "snir/ir/Operands.hpp"
+#include "snir/ir/Parser.hpp"
+#include "snir/ir/pass/DeadStoreElimination.hpp"
+#include "snir/ir/pass/RemoveNop.hpp"
+#include "snir/ir/Registry.hpp"
+#include "snir/ir/Result.hpp"
+#include "snir/ir/Type.hpp"
+#include "snir/ir/Value.hpp"
+#include "snir/ir/ValueId.hpp"
+#include "snir/ir/ValueKind.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <cstdlib>
+#include <string_view>
+#include <variant>
+
+namespace {
+
+[[nodiscard]] auto resultOf(snir::Registry const& registry, snir::ValueId inst) -> snir::ValueId
+{
+    return registry.get<snir::Result>(inst).id;
+}
+
+auto testParser() -> void
+{
+    auto registry = snir::Registry{};
+    auto parser   = snir::Parser{registry};
+    auto module   = parser.read(snir::readFile("./test/files/i64_loop_args.ll").value());
+    auto func     = module.functions().at(0);
+
+    auto const& entry = func.basicBlocks().at(0).instructions;
+    auto const& loop  = func.basicBlocks().at(1).instructions;
+    auto const& exit  = func.basicBlocks().at(2).instructions;
+
+    // Operands, branch conditions and incoming phi values are all uses.
+    auto const arg  = func.arguments().at(0);
+    auto const zero = resultOf(registry, entry.at(0));
+    auto const cond = resultOf(registry, entry.at(2));
+    assert(snir::useCount(registry, arg) == 2);
+    assert(snir::useCount(registry, zero) == 4);
+    assert(snir::useCount(registry, cond) == 1);
+    assert(snir::users(registry, cond)[0] == entry.at(3));
+
+    // Uses from a later block in a loop are known before the definition.
+    auto const sum = resultOf(registry, loop.at(2));
+    assert(snir::useCount(registry, sum) == 2);
+    assert(std::ranges::count(snir::users(registry, sum), loop.at(1)) == 1);
+    assert(std::ranges::count(snir::users(registry, sum), exit.at(0)) == 1);
+}
+
+auto testReplaceAllUsesWith() -> void
+{
+    auto registry = snir::Registry{};
+    auto parser   = snir::Parser{registry};
+    auto module   = parser.read(R"(
+define i64 @func() {
+0:
+    %1 = i64 1
+    %2 = i64 2
+    %3 = add i64 %1, %1
+    %4 = add i64 %3, %2
+    ret i64 %4
+}
+)");
+    auto func = module.functions().at(0);
+
+    auto const& insts = func.basicBlocks().at(0).instructions;
+    auto const one    = resultOf(registry, insts.at(0));
+    auto const two    = resultOf(registry, insts.at(1));
+    assert(snir::useCount(registry, one) == 2);
+    assert(snir::useCount(registry, two) == 1);
+
+    snir::replaceAllUsesWith(registry, one, two);
+    assert(snir::useCount(registry, one) == 0);
+    assert(snir::useCount(registry, two) == 3);
+
+    auto vm = snir::Interpreter{};
+    assert(std::get<std::int64_t>(vm.execute(snir::Bytecode::compile(func), {})->value) == 6);
+}
+
+auto testDeadStoreElimination() -> void
+{
+    auto registry = snir::Registry{};
+    auto parser   = snir::Parser{registry};
+    auto module   = parser.read(R"(
+define i64 @func() {
+0:
+    %1 = i64 1
+    %2 = i64 2
+    %3 = add i64 %1, %2
+    %4 = mul i64 %3, %3
+    %5 = i64 5
+    ret i64 %5
+}
+)");
+    auto func = module.functions().at(0);
+
+    auto const& insts = func.basicBlocks().at(0).instructions;
+    auto const one    = resultOf(registry, insts.at(0));
+    auto const sum    = resultOf(registry, insts.at(2));
+
+    // Only the mul is dead to begin with, the rest follows from the worklist.
+    auto analysis = snir::AnalysisManager<snir::Function>{};
+    snir::DeadStoreElimination{}(func, analysis);
+    snir::RemoveNop{}(func, analysis);
+    assert(func.numInstructions() == 2);
+    assert(snir::useCount(registry, one) == 0);
+    assert(snir::useCount(registry, sum) == 0);
+}
+
+auto testBuilder() -> void
+{
+    using snir::InstKind;
+    using snir::Type;
+    using snir::ValueKind;
+
+    auto registry = snir::Registry{};
+    auto module   = snir::Module{registry};
+    auto func     = module.create("func", Type::Int64);
+
+    auto reg = [&registry] {
+        auto value = snir::createValue(registry, ValueKind::Register);
+        value.emplace<Type>(Type::Int64);
+        return static_cast<snir::ValueId>(value);
+    };
+    auto binary = [&registry](InstKind kind, snir::ValueId result) {
+        auto inst = snir::Instruction::create(registry, kind, Type::Int64);
+        inst.asValue().emplace<snir::Result>(result);
+        return inst;
+    };
+
+    auto const arg = reg();
+    auto const one = reg();
+    auto const two = reg();
+    auto const sum = reg();
+    auto const sqr = reg();
+
+    auto const c1 = binary(InstKind::Const, one);
+    auto const c2 = binary(InstKind::Const, two);
+    c1.asValue().emplace<snir::Literal>(std::int64_t{1});
+    c2.asValue().emplace<snir::Literal>(std::int64_t{2});
+
+    auto const add = binary(InstKind::Add, sum);
+    add.operands(snir::Operands{{arg, two}});
+    add.operands(snir::Operands{{arg, one}});
+    assert(snir::useCount(registry, one) == 1);
+    assert(snir::useCount(registry, two) == 0);
+
+    auto const mul = binary(InstKind::Mul, sqr);
+    mul.operands(snir::Operands{{sum, sum}});
+    assert(snir::useCount(registry, sum) == 2);
+
+    auto const ret = snir::Instruction::create(registry, InstKind::Return, Type::Int64);
+    ret.operands(snir::Operands{{sqr}});
+
+    auto const label = snir::createValue(registry, ValueKind::Label);
+    func.asValue().emplace<snir::FunctionDefinition>(
+        std::vector{arg},
+        std::vector{snir::BasicBlock{.label = label, .instructions = {c1, c2, add, mul, ret}}}
+    );
+
+    // Only the unused constant is dead, the lists stay as the setters left them.
+    auto analysis = snir::AnalysisManager<snir::Function>{};
+    snir::DeadStoreElimination{}(func, analysis);
+    snir::RemoveNop{}(func, analysis);
+    assert(func.numInstructions() == 4);
+    assert(snir::useCount(registry, sum) == 2);
+
+    auto vm         = snir::Interpreter{};
+    auto const args = std::array{snir::Literal{std::int64_t{2}}};
+    assert(std::get<std::int64_t>(vm.execute(snir::Bytecode::compile(func), args)->value) == 9);
+}
+
+}  // namespace
+
+auto main() -> int
+{
+    testParser();
+    testReplaceAllUsesWith();
+    testDeadStoreElimination();
+    testBuilder();
+    return EXIT_SUCCESS;
+}
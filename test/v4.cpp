@@ -1,233 +1,213 @@
 #undef NDEBUG
 
 #include "snir/core/ValueStore.hpp"
-
+#include "snir/core/File.hpp"
+#include "snir/ir/Bytecode.hpp"
+#include "snir/ir/Function.hpp"
+#include "snir/ir/Interpreter.hpp"
+#include "snir/ir/Literal.hpp"
+#include "snir/ir/Parser.hpp"
+#include "snir/ir/pass/DeadStoreElimination.hpp"
+#include "snir/ir/pass/RemoveNop.hpp"
+#include "snir/ir/PassManager.hpp"
+#include "snir/ir/Printer.hpp"
+#include "snir/ir/Registry.hpp"
+#include "snir/ir/Type.hpp"
+#include "snir/ir/v4/Compile.hpp"
+#include "snir/ir/v4/pass/DeadStoreElimination.hpp"
+#include "snir/ir/v4/pass/RemoveNop.hpp"
+#include "snir/ir/v4/Printer.hpp"
+#include "snir/ir/v4/Reader.hpp"
+#include "snir/ir/v4/SharedValueStore.hpp"
+#include "snir/ir/ValueKind.hpp"
+
+#include "fmt/format.h"
 #include "fmt/os.h"
 
+#include <array>
 #include <cassert>
 #include <cstdint>
 #include <cstdio>
 #include <cstdlib>
+#include <filesystem>
+#include <sstream>
+#include <string>
 #include <utility>
 
-namespace snir {
-
-enum struct Type : std::uint8_t
-{
-    Void,
-    Pointer,
-    Bool,
-    Integer,
-    Float,
-    Double,
-};
-
-enum struct ValueKind : std::uint8_t
-{
-    Register,
-    Inst,
-    Label,
-    Function,
-    Literal,
-    Global,
-};
-
-enum struct ValueId : std::int32_t
-{
-};
-enum struct RegisterId : std::int32_t
-{
-};
-enum struct InstId : std::int32_t
-{
-};
-enum struct LabelId : std::int32_t
-{
-};
-enum struct FunctionId : std::int32_t
-{
-};
-enum struct LiteralId : std::int32_t
-{
-};
-enum struct GlobalId : std::int32_t
-{
-};
+namespace {
 
-struct Value
+auto testValueStore() -> void
 {
-    ValueKind kind;
-    Type type;
-
-    union
+    enum struct Id : int
     {
-        RegisterId registerId;
-        InstId instructionId;
-        LabelId labelId;
-        FunctionId functionId;
-        LiteralId literalId;
-        GlobalId globalId;
     };
-};
-
-enum struct InstKind : std::int8_t
-{
-    Nop,
-    Constant,
-
-    Return,
-    Branch,
-    Phi,
-
-    Add,
-    Sub,
-    Mul,
-    Div,
-    Rem,
-    ShiftLeft,
-    ShiftRight,
-    And,
-    Or,
-    Xor,
-
-    FloatAdd,
-    FloatSub,
-    FloatMul,
-    FloatDiv,
-    FloatRem,
-};
-
-enum struct UnaryOpId : std::int32_t
-{
-};
-enum struct BinaryOpId : std::int32_t
-{
-};
-enum struct BranchId : std::int32_t
-{
-};
 
-struct Inst
-{
-    InstKind kind;
-    ValueId result;
+    auto store = snir::ValueStore<Id, int>{};
+    store.reserve(2);
+    assert(store.size() == 0);
 
-    union
-    {
-        UnaryOpId unaryOpId;
-        BinaryOpId binaryOpId;
-        BranchId branchId;
-    };
-};
+    auto const id = store.addDefaultValue();
+    assert(static_cast<int>(id) >= 0);
+    assert(store.get(id) == 0);
+    assert(store.size() == 1);
 
-struct UnaryOp
-{
-    enum Op : std::uint8_t
-    {
-        Const,
-        Minus,
-        Trunc,
-    };
+    auto& val = store.get(id);
+    val       = 42;
+    assert(std::as_const(store).get(id) == 42);
 
-    Op op;
-    ValueId operand;
-};
+    auto const id2 = store.add(143);
+    assert(store.get(id2) == 143);
+    assert(store.size() == 2);
+}
 
-struct BinaryOp
+[[nodiscard]] auto print(snir::Module& module) -> std::string
 {
-    enum Op : std::uint8_t
-    {
-        Add,
-        Sub,
-        Mul,
-        Div,
-    };
-
-    Op op;
-    ValueId lhs;
-    ValueId rhs;
-};
+    auto out     = std::ostringstream{};
+    auto printer = snir::Printer{out};
+    printer(module);
+    return out.str();
+}
 
-struct Branch
+[[nodiscard]] auto print(snir::v4::SharedValueStore const& store) -> std::string
 {
-    ValueId condition;
-    ValueId ifthen;
-    ValueId ifelse;
-};
+    auto out     = std::ostringstream{};
+    auto printer = snir::v4::Printer{out};
+    printer(store);
+    return out.str();
+}
 
-struct SharedValueStore
+auto optimize(snir::Module& module) -> void
 {
-    SharedValueStore()  = default;
-    ~SharedValueStore() = default;
-
-    SharedValueStore(SharedValueStore const& other)                    = delete;
-    auto operator=(SharedValueStore const& other) -> SharedValueStore& = delete;
-
-    SharedValueStore(SharedValueStore&& other)                    = default;
-    auto operator=(SharedValueStore&& other) -> SharedValueStore& = default;
-
-    [[nodiscard]] auto values() -> ValueStore<ValueId, Value>&;
-    [[nodiscard]] auto values() const -> ValueStore<ValueId, Value> const&;
-
-    [[nodiscard]] auto instructions() -> ValueStore<InstId, Inst>&;
-    [[nodiscard]] auto instructions() const -> ValueStore<InstId, Inst> const&;
+    auto pm = snir::PassManager{};
+    pm.add(snir::DeadStoreElimination{});
+    pm.add(snir::RemoveNop{});
+    pm(module);
+}
 
-    [[nodiscard]] auto unaryOps() -> ValueStore<UnaryOpId, UnaryOp>&;
-    [[nodiscard]] auto unaryOps() const -> ValueStore<UnaryOpId, UnaryOp> const&;
+auto optimize(snir::v4::SharedValueStore& store) -> void
+{
+    for (auto i = 0zu; i < store.functions().size(); ++i) {
+        snir::v4::DeadStoreElimination{}(store, snir::v4::FunctionId(i));
+        snir::v4::RemoveNop{}(store, snir::v4::FunctionId(i));
+    }
+}
 
-    [[nodiscard]] auto binaryOps() -> ValueStore<BinaryOpId, BinaryOp>&;
-    [[nodiscard]] auto binaryOps() const -> ValueStore<BinaryOpId, BinaryOp> const&;
+// The parser gives a register and a block label with the same number a
+// single value, snir::Printer shows those by entity id.
+[[nodiscard]] auto hasAliasedLabels(snir::v4::SharedValueStore const& store) -> bool
+{
+    for (auto i = 0zu; i < store.instructions().size(); ++i) {
+        auto const result = store.instructions().get(snir::v4::InstId(i)).result;
+        if (result == snir::v4::noValue) {
+            continue;
+        }
+        if (store.values().get(result).kind == snir::ValueKind::Label) {
+            return true;
+        }
+    }
+    return false;
+}
 
-    [[nodiscard]] auto branches() -> ValueStore<BranchId, Branch>&;
-    [[nodiscard]] auto branches() const -> ValueStore<BranchId, Branch> const&;
+// Both storages have to print, optimize and lower every test file alike.
+auto testFile(std::filesystem::path const& path) -> void
+{
+    fmt::println("; {}", path.string());
+
+    auto const source = snir::readFile(path).value();
+    auto registry     = snir::Registry{};
+    auto parser       = snir::Parser{registry};
+    auto module       = parser.read(source);
+    auto store        = snir::v4::read(source);
+    auto const aliased = hasAliasedLabels(store);
+    assert(store.functions().size() == module.functions().size());
+    assert(aliased or print(store) == print(module));
+
+    optimize(module);
+    optimize(store);
+    assert(aliased or print(store) == print(module));
+
+    auto const func = snir::Function{registry, module.functions().at(0)};
+    auto vm         = snir::Interpreter{};
+    for (auto fuse : {false, true}) {
+        auto const expected = snir::Bytecode::compile(func, fuse);
+        auto const code     = snir::v4::compile(store, snir::v4::FunctionId(0), fuse);
+        assert(code.type == expected.type and code.arguments == expected.arguments);
+        assert(code.code.size() == expected.code.size() and code.registers == expected.registers);
+        if (code.arguments.empty() and code.type != snir::Type::Void) {
+            assert(vm.execute(code, {})->value == vm.execute(expected, {})->value);
+        }
+    }
+}
 
-private:
-    ValueStore<ValueId, Value> _values;
-    ValueStore<InstId, Inst> _instructions;
-    ValueStore<UnaryOpId, UnaryOp> _unaryOps;
-    ValueStore<BinaryOpId, BinaryOp> _binaryOps;
-    ValueStore<BranchId, Branch> _branchOps;
-};
+auto testLoop() -> void
+{
+    auto store      = snir::v4::read(snir::readFile("./test/files/i64_loop_args.ll").value());
+    auto const code = snir::v4::compile(store, snir::v4::FunctionId(0));
+    auto vm         = snir::Interpreter{};
 
-}  // namespace snir
+    auto const args = std::array{snir::Literal{std::int64_t{10}}};
+    assert(std::get<std::int64_t>(vm.execute(code, args)->value) == 45);
+}
 
-namespace {
+// Straight line code where every fourth value is never read.
+[[nodiscard]] auto largeModule(int size) -> std::string
+{
+    auto source = std::string{"define i64 @func(i64 %0) {\n1:\n    %2 = i64 3\n"};
+    auto last   = 0;
+    for (auto i = 3; i < size; ++i) {
+        if (i % 4 == 0) {
+            source += fmt::format("    %{} = sub i64 %{}, %2\n", i, last);
+            continue;
+        }
+        source += fmt::format("    %{} = {} i64 %{}, %2\n", i, i % 2 == 0 ? "add" : "xor", last);
+        last = i;
+    }
+    source += fmt::format("    ret i64 %{}\n}}\n", last);
+    return source;
+}
 
-auto testValueStore() -> void
+// Both storages agree on a module far larger than the test files.
+auto testLargeModule() -> void
 {
-    enum struct Id : int
-    {
-    };
+    auto const source = largeModule(1'000);
+    auto const args   = std::array{snir::Literal{std::int64_t{7}}};
+    auto vm           = snir::Interpreter{};
 
-    auto store = snir::ValueStore<Id, int>{};
-    store.reserve(2);
-    assert(store.size() == 0);
+    auto registry = snir::Registry{};
+    auto parser   = snir::Parser{registry};
+    auto module   = parser.read(source);
+    auto store    = snir::v4::read(source);
+    auto func     = snir::Function{registry, module.functions().at(0)};
+    assert(print(store) == print(module));
 
-    auto const id = store.addDefaultValue();
-    assert(static_cast<int>(id) >= 0);
-    assert(store.get(id) == 0);
-    assert(store.size() == 1);
+    optimize(module);
+    optimize(store);
+    assert(print(store) == print(module));
 
-    auto& val = store.get(id);
-    val       = 42;
-    assert(std::as_const(store).get(id) == 42);
-
-    auto const id2 = store.add(143);
-    assert(store.get(id2) == 143);
-    assert(store.size() == 2);
+    auto const enttCode = snir::Bytecode::compile(func);
+    auto const v4Code   = snir::v4::compile(store, snir::v4::FunctionId(0));
+    assert(v4Code.code.size() == enttCode.code.size());
+    assert(vm.execute(v4Code, args)->value == vm.execute(enttCode, args)->value);
 }
 
 }  // namespace
 
 auto main() -> int
 {
-    fmt::println("sizeof(Value): {}", sizeof(snir::Value));
-    fmt::println("sizeof(Inst): {}", sizeof(snir::Inst));
-    fmt::println("sizeof(UnaryOp): {}", sizeof(snir::UnaryOp));
-    fmt::println("sizeof(BinaryOp): {}", sizeof(snir::BinaryOp));
-    fmt::println("sizeof(Branch): {}", sizeof(snir::Branch));
+    fmt::println("sizeof(Value): {}", sizeof(snir::v4::Value));
+    fmt::println("sizeof(Inst): {}", sizeof(snir::v4::Inst));
+    fmt::println("sizeof(UnaryOp): {}", sizeof(snir::v4::UnaryOp));
+    fmt::println("sizeof(BinaryOp): {}", sizeof(snir::v4::BinaryOp));
+    fmt::println("sizeof(Branch): {}", sizeof(snir::v4::Branch));
 
     testValueStore();
+    for (auto const& entry : std::filesystem::directory_iterator{"./test/files"}) {
+        if (entry.is_regular_file()) {
+            testFile(entry);
+        }
+    }
+    testLoop();
+    testLargeModule();
 
     return EXIT_SUCCESS;
 }
@@ -1,17 +1,24 @@
 #include "snir/core/File.hpp"
 #include "snir/core/Strings.hpp"
+#include "snir/ir/Bytecode.hpp"
+#include "snir/ir/FrameCompaction.hpp"
 #include "snir/ir/Function.hpp"
 #include "snir/ir/Interpreter.hpp"
+#include "snir/ir/OpCode.hpp"
 #include "snir/ir/Parser.hpp"
 #include "snir/ir/pass/DeadStoreElimination.hpp"
 #include "snir/ir/pass/RemoveEmptyBlock.hpp"
 #include "snir/ir/pass/RemoveNop.hpp"
 #include "snir/ir/PassManager.hpp"
 #include "snir/ir/Printer.hpp"
+#include "snir/ir/Profile.hpp"
 #include "snir/ir/Registry.hpp"
+#include "snir/ir/Superinstruction.hpp"
+#include "snir/x86/ObjectFile.hpp"
 
 #include "fmt/os.h"
 
+#include <algorithm>
 #include <cstddef>
 #include <cstdio>
 #include <cstdlib>
@@ -22,24 +29,36 @@
 #include <iostream>
 #include <optional>
 #include <span>
+#include <string_view>
+#include <utility>
+#include <vector>
 
 namespace {
 struct Arguments
 {
-    std::filesystem::path input;
+    std::vector<std::filesystem::path> inputs;
     std::filesystem::path output;
     int opt{1};
     bool verbose{false};
+    bool emitObj{false};
 };
 
 [[nodiscard]] auto parseArguments(std::span<char const* const> arguments) -> std::optional<Arguments>
 {
     auto args = Arguments{};
     for (auto i{1zu}; i < arguments.size(); ++i) {
+        if (not std::string_view{arguments[i]}.starts_with('-')) {
+            args.inputs.emplace_back(arguments[i]);
+            continue;
+        }
         if (snir::strings::trim(arguments[i]) == std::string_view{"-v"}) {
             args.verbose = true;
             continue;
         }
+        if (snir::strings::trim(arguments[i]) == std::string_view{"--emit-obj"}) {
+            args.emitObj = true;
+            continue;
+        }
         if (snir::strings::contains(arguments[i], "-O")) {
             args.opt = snir::strings::parse<int>(std::string_view(arguments[i]).substr(2));
             continue;
@@ -50,61 +69,154 @@ struct Arguments
         }
     }
 
-    args.input = arguments.back();
+    // One output can't hold the result of several inputs
+    if (args.inputs.empty() or (args.inputs.size() > 1 and not args.output.empty())) {
+        return std::nullopt;
+    }
     return args;
 }
 
-}  // namespace
+/// \brief Opcode pairs summed over all inputs, before and after fusing.
+struct Corpus
+{
+    snir::OpCodePairs pairs;
+    snir::OpCodePairs left;
+    std::size_t files{0};
+};
 
-auto main(int argc, char const* const* argv) -> int
-try {
-    // Parse arguments
-    auto args = parseArguments(std::span<char const* const>(argv, std::size_t(argc)));
-    if (not args) {
-        fmt::println(stderr, "Usage:\nsnir-opt -v -O[0,1,2]");
-        return EXIT_FAILURE;
-    }
+// Most frequent first. The pairs left after fusing are the candidates for
+// new superinstructions.
+auto printCorpus(Corpus const& corpus) -> void
+{
+    using Pair       = std::pair<std::pair<snir::OpCode, snir::OpCode>, std::size_t>;
+    auto const print = [](std::string_view name, snir::OpCodePairs const& pairs) {
+        auto sorted = std::vector<Pair>{pairs.begin(), pairs.end()};
+        std::ranges::stable_sort(sorted, std::ranges::greater{}, &Pair::second);
+        for (auto const& [pair, count] : sorted) {
+            auto const fused = snir::isFusedPair(pair.first, pair.second) ? " fused" : "";
+            fmt::println("; {}: {} + {}: {}{}", name, pair.first, pair.second, count, fused);
+        }
+    };
 
-    if (not std::filesystem::is_regular_file(args->input)) {
-        fmt::println(stderr, "Input file does not exist: {}", args->input.string());
-        return EXIT_FAILURE;
-    }
+    fmt::println("; corpus: {} files", corpus.files);
+    print("corpus pair", corpus.pairs);
+    print("corpus pair left", corpus.left);
+}
 
+auto optimize(Arguments const& args, std::filesystem::path const& input, Corpus& corpus) -> void
+{
     auto registry = snir::Registry{};
     auto parser   = snir::Parser{registry};
-    auto source   = snir::readFile(args->input).value();
+    auto source   = snir::readFile(input).value();
 
-    auto module  = parser.read(source);
-    auto funcId  = module.functions().at(0);
-    auto funcVal = snir::Value{registry, funcId};
-    auto func    = snir::Function{funcVal};
+    auto module = parser.read(source);
+    auto func   = module.functions().at(0);
 
     // Add passes
-    auto pm  = snir::PassManager{args->verbose, std::cout};
-    auto opt = snir::PassManager{args->verbose, std::cout};
+    auto pm  = snir::PassManager{args.verbose, std::cout};
+    auto opt = snir::PassManager{args.verbose, std::cout};
     opt.add(snir::DeadStoreElimination{});
     opt.add(snir::RemoveNop{});
     opt.add(snir::RemoveEmptyBlock{});
-    if (args->opt > 0) {
+    if (args.opt > 0) {
         pm.add(std::ref(opt));
     }
-    if (args->opt > 1) {
+    if (args.opt > 1) {
         pm.add(std::ref(opt));
     }
 
     // Print optimized source
-    auto out = std::fstream(args->output, std::ios::out);
-    if (not args->output.empty()) {
+    auto out = std::fstream{};
+    if (not args.output.empty() and not args.emitObj) {
+        out.open(args.output, std::ios::out);
         pm.add(snir::Printer{out});
     }
 
     // Run passes
     pm(module);
 
+    // Release the values the passes dropped
+    if (auto const garbage = module.collectGarbage(); args.verbose) {
+        fmt::println("; collected {} unreachable values", garbage);
+    }
+
+    // Compile ahead of time into a relocatable object for the system linker
+    if (args.emitObj) {
+        auto path = args.output;
+        if (path.empty()) {
+            path = std::filesystem::path{input}.replace_extension(".o");
+        }
+        auto obj = std::ofstream(path, std::ios::out | std::ios::binary);
+        snir::x86::ObjectFile::compile(module).write(obj);
+    }
+
+    // Opcode pair frequencies are the input for picking superinstructions
+    if (args.verbose) {
+        auto const code = snir::Bytecode::compile(func, false);
+        auto fused      = code;
+        snir::fuseSuperinstructions(fused);
+        auto compacted   = fused;
+        auto const slots = snir::compactFrame(compacted);
+        fmt::println("; bytecode: {} insts, fused: {}", code.code.size(), fused.code.size());
+        fmt::println("; frame: {} slots, compacted: {}", fused.registers, compacted.registers);
+        for (auto reg = 0zu; reg < slots.size(); ++reg) {
+            if (slots[reg] == snir::unusedSlot) {
+                fmt::println("; slot: r{} -> unused", reg);
+            } else {
+                fmt::println("; slot: r{} -> {}", reg, slots[reg]);
+            }
+        }
+        for (auto const& [pair, count] : snir::countOpCodePairs(code)) {
+            fmt::println("; pair: {} + {}: {}", pair.first, pair.second, count);
+        }
+        snir::countOpCodePairs(code, corpus.pairs);
+        snir::countOpCodePairs(fused, corpus.left);
+        ++corpus.files;
+    }
+
     if (func.arguments().empty()) {
-        auto vm     = snir::Interpreter{};
+        auto profile = snir::Profile{};
+        auto vm      = snir::Interpreter{};
+        if (args.verbose) {
+            vm.profile(&profile);
+        }
+
         auto result = vm.execute(func, {});
         fmt::println("; return: {} as {}", result.value(), func.type());
+        for (auto const& hot : profile.hotBlocks(5)) {
+            fmt::println("; hot block: {} #{}: {}", hot.identifier, hot.block, hot.count);
+        }
+    }
+}
+
+}  // namespace
+
+auto main(int argc, char const* const* argv) -> int
+try {
+    // Parse arguments
+    auto args = parseArguments(std::span<char const* const>(argv, std::size_t(argc)));
+    if (not args) {
+        fmt::println(stderr, "Usage:\nsnir-opt -v -O[0,1,2] [--emit-obj] [-o output] input...");
+        return EXIT_FAILURE;
+    }
+
+    for (auto const& input : args->inputs) {
+        if (not std::filesystem::is_regular_file(input)) {
+            fmt::println(stderr, "Input file does not exist: {}", input.string());
+            return EXIT_FAILURE;
+        }
+    }
+
+    // With several inputs -v ends with the pair counts summed over all of them
+    auto corpus = Corpus{};
+    for (auto const& input : args->inputs) {
+        if (args->inputs.size() > 1) {
+            fmt::println("; {}", input.string());
+        }
+        optimize(*args, input, corpus);
+    }
+    if (args->verbose and args->inputs.size() > 1) {
+        printCorpus(corpus);
     }
 
     return EXIT_SUCCESS;